@@ -0,0 +1,45 @@
+# Index of the qcor bundles that are loaded on demand rather than by
+# xacc::Initialize(). Each line of the index names the service interface,
+# the service and the installed library providing it, as declared by the
+# qcor.interface and qcor.services keys of the bundle manifest.json. The
+# library path is relative to the directory of the index, so the install
+# can be relocated.
+
+# Install target to destination and add its services to the index
+function(qcor_index_bundle target destination)
+  file(READ ${CMAKE_CURRENT_SOURCE_DIR}/manifest.json manifest)
+  string(REGEX MATCH "\"qcor.interface\" *: *\"([^\"]*)\"" match
+               "${manifest}")
+  set(interface ${CMAKE_MATCH_1})
+  string(REGEX MATCH "\"qcor.services\" *: *\\[([^]]*)\\]" match
+               "${manifest}")
+  string(REGEX MATCHALL "\"[^\"]+\"" services "${CMAKE_MATCH_1}")
+  if(NOT interface OR NOT services)
+    message(FATAL_ERROR "${CMAKE_CURRENT_SOURCE_DIR}/manifest.json declares "
+                        "no qcor.interface and qcor.services")
+  endif()
+  foreach(service ${services})
+    string(REPLACE "\"" "" service ${service})
+    set_property(GLOBAL APPEND PROPERTY QCOR_PLUGIN_INDEX
+      "${interface} ${service} ${destination} $<TARGET_FILE_NAME:${target}>")
+  endforeach()
+  install(TARGETS ${target} DESTINATION ${destination})
+endfunction()
+
+# Write the index of every bundle added so far to file, which is to be
+# installed to destination
+function(qcor_write_plugin_index file destination)
+  get_property(entries GLOBAL PROPERTY QCOR_PLUGIN_INDEX)
+  set(content "")
+  foreach(entry ${entries})
+    string(REGEX MATCH "^([^ ]+) ([^ ]+) ([^ ]+) (.+)$" match "${entry}")
+    file(RELATIVE_PATH library_dir /${destination} /${CMAKE_MATCH_3})
+    if(library_dir)
+      set(library "${library_dir}/${CMAKE_MATCH_4}")
+    else()
+      set(library "${CMAKE_MATCH_4}")
+    endif()
+    set(content "${content}${CMAKE_MATCH_1} ${CMAKE_MATCH_2} ${library}\n")
+  endforeach()
+  file(GENERATE OUTPUT ${file} CONTENT "${content}")
+endfunction()
@@ -0,0 +1,16 @@
+# Compile SOURCE with the qcor driver QCOR and FLAGS, and check that it
+# included a precompiled qcor.hpp if and only if EXPECT_PCH is set.
+separate_arguments(FLAGS)
+execute_process(COMMAND ${QCOR} -qrt -v ${FLAGS} -c ${SOURCE}
+                RESULT_VARIABLE status
+                OUTPUT_VARIABLE output
+                ERROR_VARIABLE output)
+if(NOT status EQUAL 0)
+  message(FATAL_ERROR "qcor failed:\n${output}")
+endif()
+string(FIND "${output}" "-include-pch" found)
+if(EXPECT_PCH AND found EQUAL -1)
+  message(FATAL_ERROR "qcor did not use a precompiled header:\n${output}")
+elseif(NOT EXPECT_PCH AND NOT found EQUAL -1)
+  message(FATAL_ERROR "qcor used a precompiled header:\n${output}")
+endif()
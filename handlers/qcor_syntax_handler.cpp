@@ -1,7 +1,12 @@
+#include "qcor_aot.hpp"
 #include "token_collector_util.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <regex>
 #include <sstream>
+#include <unistd.h>
 
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/Type.h"
@@ -16,6 +21,98 @@ namespace {
 bool qrt = false;
 std::string qpu_name = "qpp";
 int shots = 0;
+bool verbose = false;
+
+// Kernel translations from earlier compiles. Header kernels (qft, the
+// arithmetic library) are otherwise re-translated in every translation
+// unit of every build. An entry is keyed by the handler build, what the
+// translation depends on (see qcor::translation_identity), the handler
+// flags, the kernel prototype and its tokens, and holds the replacement
+// source.
+// The cache lives in $QCOR_CACHE_DIR, $XDG_CACHE_HOME/qcor or
+// ~/.cache/qcor; an empty QCOR_CACHE_DIR turns it off.
+class TranslationCache {
+public:
+  TranslationCache() {
+    if (auto dir = std::getenv("QCOR_CACHE_DIR")) {
+      m_dir = dir;
+    } else if (auto dir = std::getenv("XDG_CACHE_HOME")) {
+      m_dir = std::string(dir) + "/qcor";
+    } else if (auto home = std::getenv("HOME")) {
+      m_dir = std::string(home) + "/.cache/qcor";
+    }
+  }
+
+  ~TranslationCache() {
+    if (verbose && m_hits + m_misses > 0) {
+      std::cerr << "[qcor] Translation cache " << m_dir << ": " << m_hits
+                << " hits, " << m_misses << " misses\n";
+    }
+  }
+
+  bool lookup(const std::string &key, std::string &src) {
+    if (m_dir.empty()) {
+      return false;
+    }
+    std::ifstream in(path(key));
+    std::string check;
+    if (in && std::getline(in, check) && check == check_line(key)) {
+      src.assign(std::istreambuf_iterator<char>(in),
+                 std::istreambuf_iterator<char>());
+      m_hits++;
+      return true;
+    }
+    m_misses++;
+    return false;
+  }
+
+  // Best effort, a cache that cannot be written is not an error
+  void store(const std::string &key, const std::string &src) {
+    if (m_dir.empty()) {
+      return;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(m_dir, ec);
+    // Written aside and renamed, so concurrent compiles never read a
+    // partial entry
+    const auto file = path(key);
+    const auto tmp = file + "." + std::to_string(::getpid());
+    {
+      std::ofstream out(tmp);
+      out << check_line(key) << "\n" << src;
+      if (!out) {
+        std::filesystem::remove(tmp, ec);
+        return;
+      }
+    }
+    std::filesystem::rename(tmp, file, ec);
+  }
+
+private:
+  std::string m_dir;
+  std::size_t m_hits = 0, m_misses = 0;
+
+  // FNV-1a of the key names the entry, a second hash guards against
+  // collisions
+  std::string path(const std::string &key) const {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key) {
+      h = (h ^ c) * 0x100000001b3ULL;
+    }
+    std::stringstream ss;
+    ss << m_dir << "/" << std::hex << h << ".qcor";
+    return ss.str();
+  }
+  static std::string check_line(const std::string &key) {
+    return std::to_string(key.size()) + " " +
+           std::to_string(std::hash<std::string>()(key));
+  }
+};
+
+TranslationCache &translation_cache() {
+  static TranslationCache cache;
+  return cache;
+}
 
 class QCORSyntaxHandler : public SyntaxHandler {
 public:
@@ -56,6 +153,8 @@ public:
     // Loop over the function arguments and get the
     // buffer name and any program parameter doubles.
     std::vector<std::string> program_parameters, program_arg_types;
+    // The argument types as the xacc compilers see them
+    std::vector<std::string> kernel_arg_types;
     std::vector<std::string> bufferNames;
     for (unsigned int ii = 0; ii < FTI.NumParams; ii++) {
       auto &paramInfo = FTI.Params[ii];
@@ -73,8 +172,10 @@ public:
         if (type == "class xacc::internal_compiler::qreg") {
           bufferNames.push_back(ident->getName().str());
           function_prototype += "qreg " + ident->getName().str() + ", ";
+          kernel_arg_types.push_back("qreg");
         } else {
           function_prototype += type + " " + ident->getName().str() + ", ";
+          kernel_arg_types.push_back(type);
         }
       }
     }
@@ -82,6 +183,26 @@ public:
         "void " + kernel_name +
         function_prototype.substr(0, function_prototype.length() - 2) + ")";
 
+    // Reuse the translation of this kernel from an earlier compile, which
+    // spares initializing XACC and its compilers
+    std::string cache_key = std::string(__DATE__ " " __TIME__ "\n") +
+                            qcor::translation_identity() + "\n" +
+                            (qrt ? "qrt " : "") + qpu_name + " " +
+                            std::to_string(shots) + "\n" +
+                            function_prototype + "\n";
+    for (auto &tok : Toks) {
+      cache_key += PP.getSpelling(tok) + " ";
+    }
+    std::string cached;
+    if (translation_cache().lookup(cache_key, cached)) {
+      OS << cached;
+      if (qrt) {
+        qcor::contribute_qrt_kernel(kernel_name);
+      }
+      return;
+    }
+    const auto replacement_start = OS.str().size();
+
     // Get Tokens as a string, rewrite code
     // with XACC api calls
 
@@ -108,12 +229,37 @@ public:
       for (auto &buf : bufferNames) {
         OS << buf << ".setNameAndStore(\"" + buf + "\");\n";
       }
-      OS << "auto program = getCompiled(\"" << kernel_name << "\");\n";
-      OS << "if (!program) {\n";
-      OS << "std::string kernel_src = R\"##(" + kernel_src + ")##\";\n";
-      OS << "program = compile(\"" + compiler_name +
-                "\", kernel_src.c_str());\n";
-      OS << "}\n";
+      std::string kernel_ir;
+      if (qcor::compile_kernel_ir(kernel_src, compiler_name,
+                                  program_parameters, kernel_arg_types,
+                                  kernel_ir)) {
+        // Embed the compiled program, decoded on the first call
+        OS << "alignas(8) static constexpr unsigned char __qcor_aot_ir[] = {";
+        for (std::size_t i = 0; i < kernel_ir.size(); i++) {
+          OS << (i % 16 ? " " : "\n")
+             << unsigned(static_cast<unsigned char>(kernel_ir[i])) << ",";
+        }
+        OS << "};\n";
+        OS << "static constexpr const char *__qcor_aot_args[] = {";
+        for (std::size_t i = 0; i < program_parameters.size(); i++) {
+          OS << "\"" << program_parameters[i] << "\", \""
+             << kernel_arg_types[i] << "\", ";
+        }
+        OS << "};\n";
+        OS << "auto program = qcor::__internal__::aot_kernel("
+           << qcor::__internal__::aot_kernel_id(kernel_name, kernel_ir.data(),
+                                                kernel_ir.size())
+           << "ULL, \"" << kernel_name
+           << "\", __qcor_aot_ir, sizeof(__qcor_aot_ir), __qcor_aot_args, "
+           << program_parameters.size() << ");\n";
+      } else {
+        OS << "auto program = getCompiled(\"" << kernel_name << "\");\n";
+        OS << "if (!program) {\n";
+        OS << "std::string kernel_src = R\"##(" + kernel_src + ")##\";\n";
+        OS << "program = compile(\"" + compiler_name +
+                  "\", kernel_src.c_str());\n";
+        OS << "}\n";
+      }
       // OS << "optimize(program);\n";
 
       OS << "if (__execute) {\n";
@@ -140,6 +286,7 @@ public:
     }
 
     auto s = OS.str();
+    translation_cache().store(cache_key, s.substr(replacement_start));
     qcor::info("[qcor syntax-handler] Rewriting " + kernel_name + " to\n\n" +
                function_prototype + "{\n" + s.substr(2, s.length()) + "\n}");
   }
@@ -147,6 +294,8 @@ public:
   void AddToPredefines(llvm::raw_string_ostream &OS) override {
     if (qrt) {
       OS << "#include \"qrt.hpp\"\n";
+    } else {
+      OS << "#include \"qcor_aot.hpp\"\n";
     }
     OS << "#include \"xacc_internal_compiler.hpp\"\nusing namespace "
           "xacc::internal_compiler;\n";
@@ -189,6 +338,7 @@ public:
         shots = std::stoi(args[i]);
       } else if (args[i] == "-qcor-verbose") {
         qcor::set_verbose(true);
+        verbose = true;
       } else if (args[i] == "-qrt") {
         qrt = true;
       }
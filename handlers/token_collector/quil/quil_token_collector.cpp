@@ -38,6 +38,7 @@ public:
 } // namespace
 
 CPPMICROSERVICES_EXPORT_BUNDLE_ACTIVATOR(QuilTokenCollectorActivator)
+QCOR_EXPORT_TOKEN_COLLECTOR(qcor::QuilTokenCollector)
 
 namespace qcor {
 
@@ -37,6 +37,7 @@ public:
 } // namespace
 
 CPPMICROSERVICES_EXPORT_BUNDLE_ACTIVATOR(StaqTokenCollectorActivator)
+QCOR_EXPORT_TOKEN_COLLECTOR(qcor::StaqTokenCollector)
 
 namespace qcor {
 
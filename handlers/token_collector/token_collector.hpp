@@ -14,4 +14,13 @@ public:
 
 } // namespace qcor
 
+// Token collectors install to clang-plugins, not to the XACC plugin
+// directory, so programs linked against qcor never load them.
+// token_collector_util finds the library of a collector in the plugin
+// index and creates the collector with this entry point.
+#define QCOR_EXPORT_TOKEN_COLLECTOR(TYPE)                                    \
+  extern "C" qcor::TokenCollector *qcor_create_token_collector() {           \
+    return new TYPE();                                                       \
+  }
+
 #endif
\ No newline at end of file
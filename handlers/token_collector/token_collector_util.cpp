@@ -5,7 +5,15 @@
 #include <limits>
 #include <qalloc>
 
+#include "profiler.hpp"
+#include "qcor_tape_io.hpp"
 #include "qrt_mapper.hpp"
+#include <dlfcn.h>
+#include <fstream>
+#include <regex>
+#include <set>
+#include <sys/stat.h>
+#include <unordered_map>
 
 #include "clang/Basic/TokenKinds.h"
 #include "clang/Lex/Token.h"
@@ -16,19 +24,234 @@ namespace qcor {
 void set_verbose(bool verbose) { xacc::set_verbose(verbose); }
 void info(const std::string &s) { xacc::info(s); }
 
-std::pair<std::string, std::string>
-run_token_collector(clang::Preprocessor &PP, clang::CachedTokens &Toks,
-                    const std::string &function_prototype) {
+namespace {
+// QRT kernels translated before XACC was initialized, see
+// contribute_qrt_kernel
+std::vector<std::string> uncontributed_kernels;
 
+// In runtime mode, we contribute each annotated *kernel* as a circuit.
+// Hence, kernels can be used within other kernels similar to the way
+// XACC circuits are instantiated in XASM.
+void contribute(const std::string &kernel_name) {
+  auto circuit = std::shared_ptr<xacc::Instruction>(
+      new xacc::quantum::Circuit(kernel_name));
+  xacc::contributeService(kernel_name, circuit);
+}
+
+void initialize_xacc() {
   if (!xacc::isInitialized()) {
+    quantum::profiling::Scope scope("xacc initialize");
     xacc::Initialize();
+    for (auto &kernel_name : uncontributed_kernels) {
+      contribute(kernel_name);
+    }
+    uncontributed_kernels.clear();
+  }
+}
+
+// The plugin index, found relative to the directory this library was
+// loaded from, so that a relocated install finds its own index
+std::string plugin_index_path() {
+  Dl_info self;
+  if (dladdr(reinterpret_cast<void *>(&plugin_index_path), &self) &&
+      self.dli_fname) {
+    const std::string library = self.dli_fname;
+    const auto slash = library.rfind('/');
+    if (slash != std::string::npos) {
+      return library.substr(0, slash + 1) + QCOR_PLUGIN_INDEX;
+    }
+  }
+  return QCOR_PLUGIN_INDEX;
+}
+
+// Token collectors, loaded on demand from the libraries the plugin index
+// lists for them (see QCOR_EXPORT_TOKEN_COLLECTOR), so a kernel whose
+// language is clear loads only the collector of that language. A
+// collector missing from the index may still come from a bundle in the
+// XACC plugin directory.
+class TokenCollectors {
+public:
+  TokenCollectors() {
+    const auto index_path = plugin_index_path();
+    const auto index_dir = index_path.substr(0, index_path.rfind('/') + 1);
+    std::ifstream index(index_path);
+    std::string interface, name, library;
+    while (index >> interface >> name >> library) {
+      if (interface == "TokenCollector") {
+        // Library paths are relative to the index
+        m_libraries.emplace_back(
+            name, library[0] == '/' ? library : index_dir + library);
+      }
+    }
+  }
+
+  // The collector of the given name, or nullptr
+  std::shared_ptr<TokenCollector> get(const std::string &name) {
+    auto loaded = m_loaded.find(name);
+    if (loaded != m_loaded.end()) {
+      return loaded->second;
+    }
+    std::shared_ptr<TokenCollector> collector;
+    for (auto &[indexed_name, library] : m_libraries) {
+      if (indexed_name == name) {
+        collector = load(library);
+        break;
+      }
+    }
+    if (!collector) {
+      for (auto &tc : xacc::getServices<TokenCollector>()) {
+        if (tc->name() == name) {
+          collector = tc;
+        }
+      }
+    }
+    m_loaded[name] = collector;
+    return collector;
+  }
+
+  // (collector name, library) for every indexed collector
+  const std::vector<std::pair<std::string, std::string>> &libraries() const {
+    return m_libraries;
+  }
+
+  // Every collector, the indexed ones first
+  std::vector<std::shared_ptr<TokenCollector>> all() {
+    std::vector<std::shared_ptr<TokenCollector>> collectors;
+    std::set<std::string> names;
+    for (auto &[name, library] : m_libraries) {
+      if (auto collector = get(name)) {
+        collectors.push_back(collector);
+        names.insert(name);
+      }
+    }
+    for (auto &tc : xacc::getServices<TokenCollector>()) {
+      if (names.insert(tc->name()).second) {
+        collectors.push_back(tc);
+      }
+    }
+    return collectors;
+  }
+
+private:
+  // The library stays loaded, the collector's code lives in it
+  std::shared_ptr<TokenCollector> load(const std::string &library) {
+    quantum::profiling::Scope scope("load token collector");
+    auto handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+      xacc::info("Could not load token collector " + library + ": " +
+                 dlerror());
+      return nullptr;
+    }
+    using Create = TokenCollector *(*)();
+    auto create = reinterpret_cast<Create>(
+        dlsym(handle, "qcor_create_token_collector"));
+    if (!create) {
+      xacc::info(library + " exports no token collector");
+      return nullptr;
+    }
+    xacc::info("Loaded token collector " + library);
+    return std::shared_ptr<TokenCollector>(create());
+  }
+
+  std::vector<std::pair<std::string, std::string>> m_libraries;
+  std::unordered_map<std::string, std::shared_ptr<TokenCollector>> m_loaded;
+};
+
+TokenCollectors &token_collectors() {
+  static TokenCollectors instance;
+  return instance;
+}
+
+// Modification time of a file, 0 if it cannot be read
+long long modification_time(const std::string &path) {
+  struct stat st;
+  return ::stat(path.c_str(), &st) == 0 ? (long long)st.st_mtime : 0;
+}
+
+// The language a kernel is most likely written in, judged from its tokens
+// without parsing: language markers (OPENQASM, qreg, DECLARE), the gate
+// vocabulary of each language and how gates take their qubits (H(q[0])
+// in xasm, h q[0] in OpenQASM, H 0 in Quil). Returns the token collector
+// name, or "" if no language or more than one shows up.
+std::string classify_kernel(clang::Preprocessor &PP,
+                            clang::CachedTokens &Toks) {
+  static const std::set<std::string> openqasm_markers{
+      "OPENQASM", "include", "qreg", "creg", "oracle", "barrier"};
+  static const std::set<std::string> qelib_gates{
+      "id",  "h",   "x",   "y",    "z",   "s",   "sdg",     "t",    "tdg",
+      "rx",  "ry",  "rz",  "cx",   "cy",  "cz",  "ch",      "crz",  "swap",
+      "u1",  "u2",  "u3",  "cu1",  "cu3", "ccx", "measure", "reset"};
+  static const std::set<std::string> quil_markers{"DECLARE", "MEASURE",
+                                                  "RESET", "PRAGMA"};
+  static const std::set<std::string> quil_gates{
+      "I",  "H",    "X",  "Y",  "Z",  "S",     "T",     "CNOT",
+      "CZ", "SWAP", "RX", "RY", "RZ", "PHASE", "CPHASE"};
+
+  std::map<std::string, int> votes;
+  for (std::size_t i = 0; i < Toks.size(); i++) {
+    const auto token = PP.getSpelling(Toks[i]);
+    // using qcor::openqasm; names the language outright
+    if (Toks[i].is(clang::tok::kw_using) && i + 3 < Toks.size()) {
+      const auto language = PP.getSpelling(Toks[i + 3]);
+      if (language == "openqasm") {
+        return xacc::hasCompiler("staq") ? "staq" : "openqasm";
+      }
+      return language;
+    }
+
+    auto next_is = [&](const clang::tok::TokenKind kind) {
+      return i + 1 < Toks.size() && Toks[i + 1].is(kind);
+    };
+    quantum::GateOp op;
+    if (openqasm_markers.count(token)) {
+      votes["staq"]++;
+    } else if (quil_markers.count(token)) {
+      votes["quil"]++;
+    } else if (quil_gates.count(token) &&
+               next_is(clang::tok::numeric_constant)) {
+      votes["quil"]++;
+    } else if (quantum::gate_op_from_name(token, op) &&
+               next_is(clang::tok::l_paren)) {
+      votes["xasm"]++;
+    } else if (quil_gates.count(token) && next_is(clang::tok::l_paren)) {
+      // RX(theta) 0, xasm spells it Rx
+      votes["quil"]++;
+    } else if (qelib_gates.count(token) &&
+               (next_is(clang::tok::identifier) ||
+                next_is(clang::tok::l_paren))) {
+      votes["staq"]++;
+    }
   }
+  return votes.size() == 1 ? votes.begin()->first : "";
+}
+} // namespace
+
+std::pair<std::string, std::string>
+run_token_collector(clang::Preprocessor &PP, clang::CachedTokens &Toks,
+                    const std::string &function_prototype) {
+
+  initialize_xacc();
+
+  const auto likely = classify_kernel(PP, Toks);
 
-  auto all_token_collectors = xacc::getServices<TokenCollector>();
-  auto all_compilers = xacc::getServices<xacc::Compiler>();
   std::string kernel_src = "", compiler_name = "";
 
-  for (auto &tc : all_token_collectors) {
+  // A clear verdict skips the trial parses, the kernel is parsed once
+  // when it is compiled
+  if (!likely.empty() && xacc::hasCompiler(likely)) {
+    if (auto tc = token_collectors().get(likely)) {
+      std::stringstream tmp_ss;
+      (*tc).collect(PP, Toks, tmp_ss);
+      xacc::info("Kernel tokens classified as " + likely);
+      kernel_src =
+          "__qpu__ " + function_prototype + " {\n" + tmp_ss.str() + " }";
+      return std::make_pair(kernel_src, likely);
+    }
+  }
+
+  // Ambiguous, try every language
+  int trial_parses = 0;
+  for (auto &tc : token_collectors().all()) {
     xacc::info("Running the " + tc->name() + " token collector");
     std::stringstream tmp_ss;
     (*tc).collect(PP, Toks, tmp_ss);
@@ -38,9 +261,11 @@ run_token_collector(clang::Preprocessor &PP, clang::CachedTokens &Toks,
 
       kernel_src =
           "__qpu__ " + function_prototype + " {\n" + tmp_ss.str() + " }";
+      trial_parses++;
       if (compiler->canParse(kernel_src)) {
         xacc::info(compiler->name() + " could parse tokens generated by " +
-                   tc->name());
+                   tc->name() + " after " + std::to_string(trial_parses) +
+                   " trial parses");
         compiler_name = compiler->name();
         return std::make_pair(kernel_src, compiler_name);
       } else {
@@ -55,6 +280,92 @@ run_token_collector(clang::Preprocessor &PP, clang::CachedTokens &Toks,
   return std::make_pair(kernel_src, compiler_name);
 }
 
+bool compile_kernel_ir(const std::string &kernel_src,
+                       const std::string &compiler_name,
+                       const std::vector<std::string> &arg_names,
+                       const std::vector<std::string> &arg_types,
+                       std::string &ir) {
+  // Loops and branches may depend on the arguments
+  static const std::regex control_flow("\\b(for|if|while)\\b");
+  if (std::regex_search(kernel_src, control_flow)) {
+    return false;
+  }
+  // A symbolic parameter must name a double argument or an element of a
+  // std::vector<double> argument
+  auto is_argument = [&](const std::string &symbol) {
+    static const std::regex element("([A-Za-z_]\\w*)(\\[\\d+\\])?");
+    std::smatch match;
+    if (!std::regex_match(symbol, match, element)) {
+      return false;
+    }
+    for (std::size_t a = 0; a < arg_names.size(); a++) {
+      if (arg_names[a] == match[1].str()) {
+        return match[2].matched
+                   ? arg_types[a].find("vector<double>") != std::string::npos
+                   : arg_types[a] == "double";
+      }
+    }
+    return false;
+  };
+
+  initialize_xacc();
+  auto program =
+      xacc::getCompiler(compiler_name)->compile(kernel_src)->getComposites()[0];
+
+  std::stringstream ss;
+  TapeWriter writer(ss);
+  std::vector<std::string> registers;
+  for (auto &inst : program->getInstructions()) {
+    if (!inst->isEnabled()) {
+      continue;
+    }
+    quantum::GateOp op;
+    if (inst->isComposite() || !quantum::gate_op_from_name(inst->name(), op)) {
+      xacc::info(inst->name() + " needs the " + compiler_name +
+                 " compiler at runtime");
+      return false;
+    }
+
+    quantum::TapeGate gate{op, {0, 0}, {0, 0}, {0.0, 0.0, 0.0}};
+    const auto bits = inst->bits();
+    const auto buffer_names = inst->getBufferNames();
+    const std::size_t n_qubits = quantum::gate_n_qubits(op);
+    if (bits.size() < n_qubits || buffer_names.size() < n_qubits) {
+      return false;
+    }
+    for (std::size_t q = 0; q < n_qubits; q++) {
+      auto iter =
+          std::find(registers.begin(), registers.end(), buffer_names[q]);
+      gate.reg[q] = iter - registers.begin();
+      if (iter == registers.end()) {
+        registers.push_back(buffer_names[q]);
+      }
+      gate.bit[q] = bits[q];
+    }
+
+    const int n_params = quantum::gate_n_params(op);
+    std::vector<std::string> symbols(n_params);
+    for (int p = 0; p < n_params && p < inst->nParameters(); p++) {
+      auto param = inst->getParameter(p);
+      if (param.which() == 0) {
+        gate.params[p] = param.as<int>();
+      } else if (param.which() == 1) {
+        gate.params[p] = param.as<double>();
+      } else if (is_argument(param.toString())) {
+        symbols[p] = param.toString();
+      } else {
+        xacc::info("Parameter " + param.toString() + " of " + inst->name() +
+                   " needs the " + compiler_name + " compiler at runtime");
+        return false;
+      }
+    }
+    writer.add(gate, registers, symbols);
+  }
+  writer.close();
+  ir = ss.str();
+  return true;
+}
+
 void run_token_collector_llvm_rt(clang::Preprocessor &PP,
                                  clang::CachedTokens &Toks,
                                  const std::string &function_prototype,
@@ -63,9 +374,7 @@ void run_token_collector_llvm_rt(clang::Preprocessor &PP,
                                  llvm::raw_string_ostream &OS,
                                  const std::string &qpu_name, int shots) {
 
-  if (!xacc::isInitialized()) {
-    xacc::Initialize();
-  }
+  initialize_xacc();
 
   // Used to have xasm return "", now " " needed
   // everywhere, being lazy here...
@@ -79,13 +388,12 @@ void run_token_collector_llvm_rt(clang::Preprocessor &PP,
 
   std::vector<std::pair<std::string, std::string>> classical_variables;
 
-  // Programmers can specify the language by saying
-  // using qcor::openqasm or something like that, default is xasm
-  auto process_inst_stmt = [&](int &i, std::shared_ptr<xacc::Compiler> compiler,
-                               clang::Token &current_token,
-                               std::string &terminating_char,
-                               std::string extra_preamble = "")
-      -> std::pair<std::shared_ptr<xacc::Instruction>, std::string> {
+  // Read the statement at i up to the terminating char, recording any
+  // classical variable it declares
+  auto slurp_inst_stmt = [&](int &i, std::shared_ptr<xacc::Compiler> compiler,
+                             clang::Token &current_token,
+                             std::string &terminating_char,
+                             std::string extra_preamble = "") -> std::string {
     std::stringstream ss;
     auto current_token_str = PP.getSpelling(current_token);
 
@@ -139,6 +447,12 @@ void run_token_collector_llvm_rt(clang::Preprocessor &PP,
       }
     }
 
+    return ss.str().substr(extra_preamble.length());
+  };
+
+  // The xacc kernel wrapping statements, with the classical variables
+  // declared so far as extra arguments so canParse passes
+  auto kernel_source = [&](const std::string &statements) {
     auto tmp_func_proto = function_prototype;
     if (!classical_variables.empty()) {
       for (auto &[type, name] : classical_variables) {
@@ -146,21 +460,67 @@ void run_token_collector_llvm_rt(clang::Preprocessor &PP,
                               "," + type + " " + name);
       }
     }
-    auto str_src = "__qpu__ " + tmp_func_proto + "{\n" + ss.str() + "\n}";
+    return "__qpu__ " + tmp_func_proto + "{\n" + statements + "\n}";
+  };
 
-    // std::cout << "COMPILING\n"
-    //           << tmp_func_proto + "{\n" + ss.str() + "\n}"
-    //           << "\n";
+  // Programmers can specify the language by saying
+  // using qcor::openqasm or something like that, default is xasm
+  auto process_inst_stmt = [&](int &i, std::shared_ptr<xacc::Compiler> compiler,
+                               clang::Token &current_token,
+                               std::string &terminating_char,
+                               std::string extra_preamble = "")
+      -> std::pair<std::shared_ptr<xacc::Instruction>, std::string> {
+    auto stmt = extra_preamble + slurp_inst_stmt(i, compiler, current_token,
+                                                 terminating_char,
+                                                 extra_preamble);
+    auto str_src = kernel_source(stmt);
 
     // If canParse, get the CompositeInst, if not, return the code
     // to be added to qrt_code
     if (compiler->canParse(str_src)) {
       return {compiler->compile(str_src)->getComposites()[0], ""};
     } else {
-      return {nullptr, ss.str() + "\n"};
+      return {nullptr, stmt + "\n"};
     }
   };
 
+  // Straight-line statements waiting to be translated, see translate_block
+  std::vector<std::string> pending_stmts;
+
+  // Translate pending_stmts[first, last) with one compile if they are all
+  // quantum statements. Otherwise split the range in halves, down to the
+  // classical statements, which are kept as they are. A block of n
+  // statements with k classical ones takes O(k log n) compiler runs
+  // rather than n.
+  std::function<void(std::shared_ptr<xacc::Compiler>, const std::string &,
+                     std::size_t, std::size_t, std::stringstream &)>
+      translate_block = [&](std::shared_ptr<xacc::Compiler> compiler,
+                            const std::string &extra_preamble,
+                            std::size_t first, std::size_t last,
+                            std::stringstream &qrt_code) {
+        std::string statements;
+        for (auto k = first; k < last; k++) {
+          statements += pending_stmts[k] + "\n";
+        }
+        auto str_src = kernel_source(extra_preamble + statements);
+        if (compiler->canParse(str_src)) {
+          auto comp_inst = compiler->compile(str_src)->getComposites()[0];
+          auto visitor = std::make_shared<qrt_mapper>(comp_inst->name());
+          xacc::InstructionIterator iter(comp_inst);
+          while (iter.hasNext()) {
+            auto next = iter.next();
+            next->accept(visitor);
+          }
+          qrt_code << visitor->get_new_src();
+        } else if (last - first == 1) {
+          qrt_code << statements;
+        } else {
+          const auto mid = first + (last - first) / 2;
+          translate_block(compiler, extra_preamble, first, mid, qrt_code);
+          translate_block(compiler, extra_preamble, mid, last, qrt_code);
+        }
+      };
+
   std::function<void(int &, std::shared_ptr<xacc::Compiler>, clang::Token &,
                      clang::CachedTokens &, std::string &, std::stringstream &,
                      std::string)>
@@ -268,10 +628,31 @@ void run_token_collector_llvm_rt(clang::Preprocessor &PP,
   std::map<std::string, int> creg_name_to_size;
   int countQregs = 0;
 
+  auto flush_pending = [&]() {
+    if (!pending_stmts.empty()) {
+      translate_block(compiler, extra_preamble, 0, pending_stmts.size(),
+                      qrt_code);
+      pending_stmts.clear();
+    }
+  };
+
   for (int i = 0; i < Toks.size(); i++) {
     auto current_token = Toks[i];
     auto current_token_str = PP.getSpelling(current_token);
 
+    // Anything but a plain statement ends the current block; a measure is
+    // plain unless it is the whole-register measure q -> c form
+    const bool measure_register =
+        current_token_str == "measure" &&
+        !(i + 2 < Toks.size() && Toks[i + 2].is(clang::tok::l_square));
+    if (current_token.is(clang::tok::kw_using) ||
+        current_token.is(clang::tok::kw_for) || current_token_str == "oracle" ||
+        oracle_name_to_extra_preamble.count(current_token_str) ||
+        current_token_str == "qreg" || current_token_str == "creg" ||
+        current_token_str == "OPENQASM" || measure_register) {
+      flush_pending();
+    }
+
     if (current_token.is(clang::tok::kw_using)) {
       // Found using
       // i+3 bc we skip using, qcor and ::;
@@ -403,19 +784,8 @@ void run_token_collector_llvm_rt(clang::Preprocessor &PP,
         i--;
         current_token = Toks[i];
         // This we can parse, so just eat it up and get the Measure IR node out
-        auto [comp_inst, src_str] = process_inst_stmt(
-            i, compiler, current_token, terminating_char, extra_preamble);
-        if (comp_inst) {
-          auto visitor = std::make_shared<qrt_mapper>(comp_inst->name());
-          xacc::InstructionIterator iter(comp_inst);
-          while (iter.hasNext()) {
-            auto next = iter.next();
-            next->accept(visitor);
-          }
-          qrt_code << visitor->get_new_src();
-        } else {
-          qrt_code << src_str;
-        }
+        pending_stmts.push_back(slurp_inst_stmt(
+            i, compiler, current_token, terminating_char, extra_preamble));
         continue;
       } else {
         // the token is ->
@@ -467,21 +837,12 @@ void run_token_collector_llvm_rt(clang::Preprocessor &PP,
     }
 
     // this is a quantum statement + terminating char
-    // slurp up to the terminating char
-    auto [comp_inst, src_str] = process_inst_stmt(
-        i, compiler, current_token, terminating_char, extra_preamble);
-    if (comp_inst) {
-      auto visitor = std::make_shared<qrt_mapper>(comp_inst->name());
-      xacc::InstructionIterator iter(comp_inst);
-      while (iter.hasNext()) {
-        auto next = iter.next();
-        next->accept(visitor);
-      }
-      qrt_code << visitor->get_new_src();
-    } else {
-      qrt_code << src_str;
-    }
+    // slurp up to the terminating char, it is translated with the rest
+    // of its block
+    pending_stmts.push_back(slurp_inst_stmt(
+        i, compiler, current_token, terminating_char, extra_preamble));
   }
+  flush_pending();
 
   //   std::cout << "QRT CODE:\n" << qrt_code.str() << "\n";
 
@@ -517,12 +878,34 @@ void run_token_collector_llvm_rt(clang::Preprocessor &PP,
   OS << ");\n";
   OS << "}";
 
-  // In runtime mode, we contribute each annotated *kernel* as a circuit.
-  // Hence, kernels can be used within other kernels similar to the way
-  // XACC circuits are instantiated in XASM.
-  auto circuit = std::shared_ptr<xacc::Instruction>(
-      new xacc::quantum::Circuit(kernel_name));
-  xacc::contributeService(kernel_name, circuit);
+  contribute(kernel_name);
+}
+
+std::string translation_identity() {
+  static const std::string identity = []() {
+    std::stringstream ss;
+    ss << "tape " << tape_version;
+    Dl_info xacc_library;
+    if (dladdr(reinterpret_cast<void *>(&xacc::isInitialized),
+               &xacc_library) &&
+        xacc_library.dli_fname) {
+      ss << " xacc " << modification_time(xacc_library.dli_fname);
+    }
+    ss << " index " << modification_time(plugin_index_path());
+    for (auto &[name, library] : token_collectors().libraries()) {
+      ss << " " << name << " " << modification_time(library);
+    }
+    return ss.str();
+  }();
+  return identity;
+}
+
+void contribute_qrt_kernel(const std::string &kernel_name) {
+  if (xacc::isInitialized()) {
+    contribute(kernel_name);
+  } else {
+    uncontributed_kernels.push_back(kernel_name);
+  }
 }
 
 } // namespace qcor
@@ -14,6 +14,18 @@ std::pair<std::string, std::string>
 run_token_collector(clang::Preprocessor &PP, clang::CachedTokens &Toks,
                     const std::string &function_prototype);
 
+// Compile a kernel found by run_token_collector ahead of time. On success
+// ir holds the program in the tape format of qcor_tape_io.hpp, to be
+// embedded in the object file (see qcor_aot.hpp). Returns false if the
+// kernel needs the xacc compiler at runtime: control flow, calls of other
+// kernels, gates the tape cannot hold, or gate parameters other than
+// double arguments and elements of std::vector<double> arguments.
+bool compile_kernel_ir(const std::string &kernel_src,
+                       const std::string &compiler_name,
+                       const std::vector<std::string> &arg_names,
+                       const std::vector<std::string> &arg_types,
+                       std::string &ir);
+
 void run_token_collector_llvm_rt(clang::Preprocessor &PP,
                                  clang::CachedTokens &Toks,
                                  const std::string &function_prototype,
@@ -22,6 +34,17 @@ void run_token_collector_llvm_rt(clang::Preprocessor &PP,
                                  llvm::raw_string_ostream &OS,
                                  const std::string &qpu_name, int shots = 0);
 
+// In QRT mode every kernel is contributed to XACC as a circuit, so later
+// kernels can call it. For a kernel whose translation was not run (e.g.
+// it came from the translation cache) this contributes it now, or once
+// XACC is initialized.
+void contribute_qrt_kernel(const std::string &kernel_name);
+
+// What a kernel translation depends on besides the handler and its
+// flags: the tape format version, the XACC library and the token
+// collectors of the plugin index, by modification time
+std::string translation_identity();
+
 void set_verbose(bool verbose);
 void info(const std::string &s);
 
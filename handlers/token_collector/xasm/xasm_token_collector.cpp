@@ -36,6 +36,7 @@ public:
 } // namespace
 
 CPPMICROSERVICES_EXPORT_BUNDLE_ACTIVATOR(XasmTokenCollectorActivator)
+QCOR_EXPORT_TOKEN_COLLECTOR(qcor::XasmTokenCollector)
 
 namespace qcor {
 
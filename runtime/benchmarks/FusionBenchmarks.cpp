@@ -0,0 +1,94 @@
+#include "qcor_sv_accelerator.hpp"
+#include "xacc.hpp"
+#include <benchmark/benchmark.h>
+
+namespace {
+using quantum::GateOp;
+
+// qft over n qubits, see examples/qrt/shared/qft.hpp
+quantum::GateTape qft_tape(const int n) {
+  quantum::GateTape tape;
+  for (int i = n - 1; i >= 0; --i) {
+    tape.add(GateOp::H, {"q", i});
+    for (int j = i - 1; j >= 0; --j) {
+      tape.add(GateOp::CPhase, {"q", i}, {"q", j},
+               {M_PI / std::pow(2.0, i - j)});
+    }
+  }
+  for (int i = 0; i < n / 2; ++i) {
+    tape.add(GateOp::Swap, {"q", i}, {"q", n - i - 1});
+  }
+  return tape;
+}
+
+// Ten layers of Ry rotations and a CNOT ladder, as in a hardware
+// efficient ansatz
+quantum::GateTape layers_tape(const int n) {
+  quantum::GateTape tape;
+  for (int layer = 0; layer < 10; ++layer) {
+    for (int i = 0; i < n; ++i) {
+      tape.add(GateOp::Ry, {"q", i}, {0.1 * (layer + i)});
+    }
+    for (int i = 0; i + 1 < n; ++i) {
+      tape.add(GateOp::CNOT, {"q", i}, {"q", i + 1});
+    }
+  }
+  return tape;
+}
+
+// Memory traffic of qcor-sv on the make_tape circuit over range(0)
+// qubits with fusion-qubits range(1) (0 disables fusion). Every pass over
+// the state reads and writes each amplitude once, so bytes counts
+// 2 * 16 * 2^n bytes per pass and its rate is the effective memory
+// bandwidth. range(2) = 1 keeps cache blocking on, 0 makes every pass a
+// full sweep of memory.
+void BM_FusionTraffic(benchmark::State &state,
+                      quantum::GateTape (*make_tape)(const int)) {
+  const int n_qubits = state.range(0);
+  const int fusion_qubits = state.range(1);
+  const bool blocking = state.range(2);
+  const auto tape = make_tape(n_qubits);
+
+  qcor::StateVectorAccelerator acc;
+  xacc::HeterogeneousMap config{{"fusion-qubits", fusion_qubits}};
+  if (!blocking) {
+    config.insert("block-qubits", n_qubits);
+  }
+  acc.initialize(config);
+
+  int passes = 0, blocks = 0, fused = 0;
+  for (auto _ : state) {
+    auto buffer = xacc::qalloc(n_qubits);
+    auto raw = buffer.get();
+    acc.execute(&raw, 1, tape);
+    passes = buffer->getInformation("sv-state-passes").as<int>();
+    blocks = buffer->getInformation("sv-fused-blocks").as<int>();
+    fused = buffer->getInformation("sv-fused-gates").as<int>();
+  }
+  const double bytes_per_pass =
+      2.0 * sizeof(std::complex<double>) * std::pow(2.0, n_qubits);
+  state.counters["gates"] = tape.size();
+  state.counters["passes"] = passes;
+  state.counters["fused_blocks"] = blocks;
+  state.counters["fused_gates"] = fused;
+  state.counters["bytes"] = benchmark::Counter(
+      passes * bytes_per_pass, benchmark::Counter::kIsIterationInvariantRate,
+      benchmark::Counter::kIs1024);
+}
+BENCHMARK_CAPTURE(BM_FusionTraffic, qft, qft_tape)
+    ->ArgsProduct({{16, 20, 24}, {0, 2, 3, 4, 5}, {0, 1}})
+    ->ArgNames({"qubits", "fusion", "blocking"})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FusionTraffic, layers, layers_tape)
+    ->ArgsProduct({{16, 20, 24}, {0, 2, 3, 4, 5}, {0, 1}})
+    ->ArgNames({"qubits", "fusion", "blocking"})
+    ->Unit(benchmark::kMillisecond);
+} // namespace
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  xacc::Initialize(argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  xacc::Finalize();
+  return 0;
+}
@@ -0,0 +1,58 @@
+#include "benchmark_kernels.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace qcor::benchmarks;
+
+namespace {
+// qcor::observe of the ansatz against a range(0) qubit Heisenberg chain,
+// on the backend given by QCOR_BENCHMARK_QPU
+void BM_Observe(benchmark::State &state) {
+  const int n_qubits = state.range(0);
+  auto H = heisenberg(n_qubits);
+  auto q = qalloc(n_qubits);
+  auto program =
+      qcor::__internal__::kernel_as_composite_instruction(ansatz, q, n_qubits,
+                                                          2, 0.3);
+  for (auto _ : state) {
+    // observe() appends a child buffer per term, start from a fresh one
+    state.PauseTiming();
+    q = qalloc(n_qubits);
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(qcor::__internal__::observe(program, H, q));
+  }
+  quantum::clearProgram();
+  state.counters["terms"] = H->getSubTerms().size();
+  state.SetComplexityN(n_qubits);
+}
+BENCHMARK(BM_Observe)
+    ->DenseRange(2, 20, 2)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity(benchmark::oAuto);
+
+// The reduction of the per-term child buffers observe() leaves on q
+void BM_WeightedSum(benchmark::State &state) {
+  const int n_qubits = state.range(0);
+  auto H = heisenberg(n_qubits);
+  auto q = qalloc(n_qubits);
+  auto program =
+      qcor::__internal__::kernel_as_composite_instruction(ansatz, q, n_qubits,
+                                                          1, 0.3);
+  qcor::__internal__::observe(program, H, q);
+  quantum::clearProgram();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(q.weighted_sum(H.get()));
+  }
+  const auto terms = H->getSubTerms().size();
+  state.counters["terms"] = terms;
+  state.SetItemsProcessed(state.iterations() * terms);
+}
+BENCHMARK(BM_WeightedSum)->DenseRange(2, 20, 6);
+} // namespace
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  xacc::Initialize(argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  xacc::Finalize();
+  return 0;
+}
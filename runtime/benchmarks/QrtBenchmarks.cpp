@@ -0,0 +1,110 @@
+#include "benchmark_kernels.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace qcor::benchmarks;
+
+namespace {
+// Record layers of H, Rz and CNOT with execution off, the work a QRT kernel
+// does per gate before anything is submitted
+void BM_RecordGates(benchmark::State &state) {
+  const int n_qubits = 16;
+  const int n_layers = state.range(0);
+  auto q = qalloc(n_qubits);
+  const auto cached_exec = __execute;
+  __execute = false;
+  for (auto _ : state) {
+    quantum::initialize(qpu_name(), "record");
+    q.setNameAndStore("q");
+    for (int layer = 0; layer < n_layers; layer++) {
+      for (int i = 0; i < n_qubits; i++) {
+        quantum::h(q[i]);
+        quantum::rz(q[i], 0.1 * layer);
+      }
+      for (int i = 0; i + 1 < n_qubits; i++) {
+        quantum::cnot(q[i], q[i + 1]);
+      }
+    }
+    benchmark::DoNotOptimize(quantum::getTape().size());
+    quantum::clearProgram();
+  }
+  __execute = cached_exec;
+  state.SetItemsProcessed(state.iterations() * n_layers *
+                          (3 * n_qubits - 1));
+}
+BENCHMARK(BM_RecordGates)->RangeMultiplier(4)->Range(1, 256);
+
+void BM_KernelAsComposite_Qft(benchmark::State &state) {
+  const int n_qubits = state.range(0);
+  auto q = qalloc(n_qubits);
+  for (auto _ : state) {
+    auto program =
+        qcor::__internal__::kernel_as_composite_instruction(qft, q, n_qubits);
+    benchmark::DoNotOptimize(program->nInstructions());
+    quantum::clearProgram();
+  }
+  state.SetComplexityN(n_qubits);
+}
+BENCHMARK(BM_KernelAsComposite_Qft)
+    ->RangeMultiplier(2)
+    ->Range(4, 64)
+    ->Complexity(benchmark::oNSquared);
+
+// quantum::exp for a Hamiltonian of range(0) terms, reported per term
+void BM_Exp(benchmark::State &state) {
+  const int n_terms = state.range(0);
+  const int n_qubits = 8;
+  std::string src = "1.0 X0 Y1";
+  for (int t = 1; t < n_terms; t++) {
+    // Distinct strings of up to four Paulis
+    src += " + 0.5";
+    for (int k = 0; k < 4; k++) {
+      if ((t >> (2 * k)) & 3) {
+        src += std::string(" ") + "XYZ"[((t >> (2 * k)) & 3) - 1] +
+               std::to_string((k + t) % n_qubits);
+      }
+    }
+  }
+  auto H = qcor::createObservable(src);
+  auto q = qalloc(n_qubits);
+  const auto cached_exec = __execute;
+  __execute = false;
+  for (auto _ : state) {
+    quantum::initialize(qpu_name(), "exp");
+    q.setNameAndStore("q");
+    quantum::exp(q, 0.25, H);
+    benchmark::DoNotOptimize(quantum::getTape().size());
+    quantum::clearProgram();
+  }
+  __execute = cached_exec;
+  const auto terms = H->getSubTerms().size();
+  state.counters["terms"] = terms;
+  state.SetItemsProcessed(state.iterations() * terms);
+}
+BENCHMARK(BM_Exp)->RangeMultiplier(4)->Range(1, 256);
+
+// Controlled::Apply expanding every gate of a qft through C-U
+void BM_ControlledApply_Qft(benchmark::State &state) {
+  const int n_qubits = state.range(0);
+  auto q = qalloc(n_qubits + 1);
+  for (auto _ : state) {
+    quantum::initialize(qpu_name(), "controlled");
+    qcor::Controlled::Apply(n_qubits, qft, q, n_qubits);
+    benchmark::DoNotOptimize(quantum::getTape().size());
+    state.counters["gates"] = quantum::getTape().size();
+    quantum::clearProgram();
+  }
+  state.SetComplexityN(n_qubits);
+}
+BENCHMARK(BM_ControlledApply_Qft)
+    ->RangeMultiplier(2)
+    ->Range(2, 16)
+    ->Complexity(benchmark::oNSquared);
+} // namespace
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  xacc::Initialize(argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  xacc::Finalize();
+  return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef RUNTIME_BENCHMARKS_BENCHMARK_KERNELS_HPP_
+#define RUNTIME_BENCHMARKS_BENCHMARK_KERNELS_HPP_
+
+#include "qcor.hpp"
+
+#include <cmath>
+#include <string>
+
+// Kernels shared by the benchmarks, written out as the QRT translation of
+// the corresponding __qpu__ functions so they build with a plain C++
+// compiler. The kernel bodies follow examples/qrt/shared/qft.hpp and a
+// hardware efficient ansatz.
+namespace qcor {
+namespace benchmarks {
+
+// The QPU the benchmark kernels initialize, qpp unless QCOR_BENCHMARK_QPU
+// names another one
+inline const char *qpu_name() {
+  static const std::string name = []() {
+    auto env = std::getenv("QCOR_BENCHMARK_QPU");
+    return std::string(env ? env : "qpp");
+  }();
+  return name.c_str();
+}
+
+inline void qft(qreg q, int nbQubits) {
+  quantum::initialize(qpu_name(), "qft");
+  q.setNameAndStore("q");
+  for (int qIdx = nbQubits - 1; qIdx >= 0; --qIdx) {
+    quantum::h(q[qIdx]);
+    for (int j = qIdx - 1; j >= 0; --j) {
+      const double theta = M_PI / std::pow(2.0, qIdx - j);
+      quantum::cphase(q[qIdx], q[j], theta);
+    }
+  }
+  for (int qIdx = 0; qIdx < nbQubits / 2; ++qIdx) {
+    quantum::swap(q[qIdx], q[nbQubits - qIdx - 1]);
+  }
+  if (__execute) {
+    quantum::submit(q.results());
+  }
+}
+
+// Layers of Ry rotations and a CNOT ladder on every qubit of q
+inline void ansatz(qreg q, int nbQubits, int nbLayers, double theta) {
+  quantum::initialize(qpu_name(), "ansatz");
+  q.setNameAndStore("q");
+  for (int layer = 0; layer < nbLayers; ++layer) {
+    for (int qIdx = 0; qIdx < nbQubits; ++qIdx) {
+      quantum::ry(q[qIdx], theta * (qIdx + 1) / nbQubits);
+    }
+    for (int qIdx = 0; qIdx + 1 < nbQubits; ++qIdx) {
+      quantum::cnot(q[qIdx], q[qIdx + 1]);
+    }
+  }
+  if (__execute) {
+    quantum::submit(q.results());
+  }
+}
+
+// Heisenberg chain with a field, 4 * n_qubits - 3 terms
+inline std::shared_ptr<Observable> heisenberg(const int n_qubits) {
+  std::string src = "0.5 Z0";
+  for (int i = 1; i < n_qubits; i++) {
+    const auto a = std::to_string(i - 1), b = std::to_string(i);
+    src += " + X" + a + " X" + b + " + Y" + a + " Y" + b + " + Z" + a +
+           " Z" + b + " + 0.5 Z" + b;
+  }
+  return createObservable(src);
+}
+
+} // namespace benchmarks
+} // namespace qcor
+
+#endif
@@ -0,0 +1,36 @@
+// Deuteron VQE, examples/xasm/deuteron_pauli.cpp with the optimizer loop
+// timed by phase
+#include "workload.hpp"
+
+__qpu__ void ansatz(qreg q, double theta) {
+  X(q[0]);
+  Ry(q[1], theta);
+  CNOT(q[1], q[0]);
+}
+
+int main(int argc, char **argv) {
+  qcor::workloads::Report report("deuteron_vqe");
+  auto q = qalloc(2);
+  auto H = qcor::createObservable(
+      "5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + .21829 Z0 - 6.125 Z1");
+
+  int evaluations = 0;
+  qcor::OptFunction f(
+      [&](const std::vector<double> &x, std::vector<double> &grad) {
+        auto program = qcor::workloads::trace(report, ansatz, q, x[0]);
+        auto e = qcor::workloads::observe(report, program, *H, q);
+        q.reset();
+        evaluations++;
+        return e;
+      },
+      1);
+  auto optimizer = qcor::createOptimizer(
+      "nlopt",
+      {std::make_pair("initial-parameters", std::vector<double>{0.0})});
+  auto result = optimizer->optimize(f);
+
+  report.parameter("qubits", 2);
+  report.result("energy", result.first);
+  report.result("evaluations", evaluations);
+  report.print();
+}
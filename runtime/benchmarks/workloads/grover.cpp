@@ -0,0 +1,37 @@
+// Grover search of examples/qrt/grover/grover_5.qasm, measured with
+// qcor::measure_all
+// Usage: grover [shots = 1024]
+#include "workload.hpp"
+
+__qpu__ void grover_5(qreg q) {
+  using qcor::openqasm;
+
+#include "grover_5.qasm"
+
+}
+
+int main(int argc, char **argv) {
+  const int shots = argc > 1 ? std::stoi(argv[1]) : 1024;
+  qcor::workloads::Report report("grover");
+  qcor::set_shots(shots);
+
+  auto q = qalloc(9);
+  auto measured = qcor::measure_all(grover_5, q);
+  qcor::workloads::trace(report, measured, q);
+  qcor::workloads::execute(report, q);
+  auto histogram = qcor::counts(q);
+  std::size_t best = 0;
+  for (std::size_t i = 1; i < histogram.size(); i++) {
+    if (histogram.count(i) > histogram.count(best)) {
+      best = i;
+    }
+  }
+
+  report.parameter("qubits", 9);
+  report.parameter("shots", shots);
+  report.result("top_probability",
+                histogram.size() ? double(histogram.count(best)) / shots
+                                 : 0.0);
+  report.result("distinct_outcomes", histogram.size());
+  report.print();
+}
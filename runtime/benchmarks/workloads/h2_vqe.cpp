@@ -0,0 +1,53 @@
+// H2 VQE with the UCC ansatz and Hamiltonian of VQETester.cpp
+#include "workload.hpp"
+
+__qpu__ void ansatz(qreg q, double t0) {
+  X(q[0]);
+  X(q[1]);
+  Rx(q[0], 1.5707);
+  H(q[1]);
+  H(q[2]);
+  H(q[3]);
+  CNOT(q[0], q[1]);
+  CNOT(q[1], q[2]);
+  CNOT(q[2], q[3]);
+  Rz(q[3], t0);
+  CNOT(q[2], q[3]);
+  CNOT(q[1], q[2]);
+  CNOT(q[0], q[1]);
+  Rx(q[0], -1.5707);
+  H(q[1]);
+  H(q[2]);
+  H(q[3]);
+}
+
+int main(int argc, char **argv) {
+  qcor::workloads::Report report("h2_vqe");
+  auto q = qalloc(4);
+  auto H = qcor::createObservable(
+      "(0.174073,0) Z2 Z3 + (0.1202,0) Z1 Z3 + (0.165607,0) Z1 Z2 + "
+      "(0.165607,0) Z0 Z3 + (0.1202,0) Z0 Z2 + (-0.0454063,0) Y0 Y1 X2 X3 + "
+      "(-0.220041,0) Z3 + (-0.106477,0) + (0.17028,0) Z0 + (-0.220041,0) Z2 "
+      "+ (0.17028,0) Z1 + (-0.0454063,0) X0 X1 Y2 Y3 + (0.0454063,0) X0 Y1 "
+      "Y2 X3 + (0.168336,0) Z0 Z1 + (0.0454063,0) Y0 X1 X2 Y3");
+
+  int evaluations = 0;
+  qcor::OptFunction f(
+      [&](const std::vector<double> &x, std::vector<double> &grad) {
+        auto program = qcor::workloads::trace(report, ansatz, q, x[0]);
+        auto e = qcor::workloads::observe(report, program, *H, q);
+        q.reset();
+        evaluations++;
+        return e;
+      },
+      1);
+  auto optimizer = qcor::createOptimizer(
+      "nlopt",
+      {std::make_pair("initial-parameters", std::vector<double>{0.0})});
+  auto result = optimizer->optimize(f);
+
+  report.parameter("qubits", 4);
+  report.result("energy", result.first);
+  report.result("evaluations", evaluations);
+  report.print();
+}
@@ -0,0 +1,29 @@
+// Shor period finding, periodFinding of examples/qrt/shared/arithmetic.hpp
+// for a small N. It takes 4 * bits(N) + 2 qubits, 18 for N = 15.
+// Usage: period_finding [N = 15] [a = 7] [shots = 1024]
+#include "workload.hpp"
+#include "arithmetic.hpp"
+
+int main(int argc, char **argv) {
+  const int N = argc > 1 ? std::stoi(argv[1]) : 15;
+  const int a = argc > 2 ? std::stoi(argv[2]) : 7;
+  const int shots = argc > 3 ? std::stoi(argv[3]) : 1024;
+  qcor::workloads::Report report("period_finding");
+  qcor::set_shots(shots);
+
+  int n = 0;
+  qcor::util::calcNumBits(n, N);
+  auto q = qalloc(4 * n + 2);
+  auto program = qcor::workloads::trace(report, periodFinding, q, a, N);
+  const auto n_gates = program->nInstructions();
+  qcor::workloads::execute(report, q);
+  auto histogram = qcor::counts(q);
+
+  report.parameter("N", N);
+  report.parameter("a", a);
+  report.parameter("qubits", 4 * n + 2);
+  report.parameter("shots", shots);
+  report.result("gates", n_gates);
+  report.result("distinct_outcomes", histogram.size());
+  report.print();
+}
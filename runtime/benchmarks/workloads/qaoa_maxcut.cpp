@@ -0,0 +1,87 @@
+// QAOA MaxCut on a random graph, the ansatz of
+// examples/qrt/qaoa/qaoa_example.cpp.
+// Usage: qaoa_maxcut [n_nodes = 6] [n_steps = 1] [seed = 7]
+#include "workload.hpp"
+#include <random>
+
+__qpu__ void qaoa_ansatz(qreg q, int n_steps, std::vector<double> gamma,
+                         std::vector<double> beta,
+                         qcor::PauliOperator &cost_ham) {
+  auto nQubits = q.size();
+  int gamma_counter = 0;
+  int beta_counter = 0;
+  for (int i = 0; i < nQubits; i++) {
+    H(q[i]);
+  }
+  auto cost_terms = cost_ham.getNonIdentitySubTerms();
+  for (int step = 0; step < n_steps; step++) {
+    for (int i = 0; i < cost_terms.size(); i++) {
+      auto cost_term = cost_terms[i];
+      auto m_gamma = gamma[gamma_counter];
+      exp_i_theta(q, m_gamma, cost_term);
+      gamma_counter++;
+    }
+    for (int i = 0; i < nQubits; i++) {
+      auto ref_ham_term = qcor::createObservable("X" + std::to_string(i));
+      auto m_beta = beta[beta_counter];
+      exp_i_theta(q, m_beta, ref_ham_term);
+      beta_counter++;
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  const int n_nodes = argc > 1 ? std::stoi(argv[1]) : 6;
+  const int n_steps = argc > 2 ? std::stoi(argv[2]) : 1;
+  const int seed = argc > 3 ? std::stoi(argv[3]) : 7;
+  qcor::workloads::Report report("qaoa_maxcut");
+
+  // G(n, 1/2), the same graph for a given seed on every machine
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  qcor::PauliOperator cost_ham;
+  int n_edges = 0;
+  for (int i = 0; i < n_nodes; i++) {
+    for (int j = i + 1; j < n_nodes; j++) {
+      if (dist(engine) < 0.5) {
+        // Cutting edge (i, j) lowers the energy by one
+        cost_ham += 0.5 * (qcor::Z(i) * qcor::Z(j));
+        cost_ham += qcor::PauliOperator(-0.5);
+        n_edges++;
+      }
+    }
+  }
+
+  auto q = qalloc(n_nodes);
+  const int n_gamma = n_edges * n_steps, n_beta = n_nodes * n_steps;
+  std::vector<double> initial(n_gamma + n_beta);
+  for (auto &x : initial) {
+    x = dist(engine);
+  }
+
+  int evaluations = 0;
+  qcor::OptFunction f(
+      [&](const std::vector<double> &x, std::vector<double> &grad) {
+        std::vector<double> gamma(x.begin(), x.begin() + n_gamma),
+            beta(x.begin() + n_gamma, x.end());
+        auto program = qcor::workloads::trace(report, qaoa_ansatz, q, n_steps,
+                                              gamma, beta, cost_ham);
+        auto e = qcor::workloads::observe(report, program, cost_ham, q);
+        q.reset();
+        evaluations++;
+        return e;
+      },
+      initial.size());
+  auto optimizer = qcor::createOptimizer(
+      "nlopt", {std::make_pair("initial-parameters", initial),
+                std::make_pair("nlopt-maxeval", 50)});
+  auto result = optimizer->optimize(f);
+
+  report.parameter("qubits", n_nodes);
+  report.parameter("edges", n_edges);
+  report.parameter("steps", n_steps);
+  report.parameter("seed", seed);
+  report.result("cut_energy", result.first);
+  report.result("evaluations", evaluations);
+  report.print();
+}
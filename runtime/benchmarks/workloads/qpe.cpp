@@ -0,0 +1,66 @@
+// Quantum phase estimation of the T gate,
+// examples/qrt/qpe/qpe_example_qrt.cpp at a chosen precision.
+// Usage: qpe [bits = 3] [shots = 1024]
+#include "workload.hpp"
+#include "qft.hpp"
+#include <cmath>
+
+using namespace qcor;
+
+__qpu__ void compositeOp(qreg q) {
+  int bitIdx = q.size() - 1;
+  T(q[bitIdx]);
+}
+
+__qpu__ void QuantumPhaseEstimation(qreg q) {
+  const auto nQubits = q.size();
+  X(q[nQubits - 1]);
+  for (int qIdx = 0; qIdx < nQubits - 1; ++qIdx) {
+    H(q[qIdx]);
+  }
+  const auto bitPrecision = nQubits - 1;
+  for (int32_t i = 0; i < bitPrecision; ++i) {
+    const int nbCalls = 1 << i;
+    for (int j = 0; j < nbCalls; ++j) {
+      int ctlBit = i;
+      Controlled::Apply(ctlBit, compositeOp, q);
+    }
+  }
+  int startIdx = 0;
+  int shouldSwap = 1;
+  iqft(q, startIdx, bitPrecision, shouldSwap);
+  for (int qIdx = 0; qIdx < bitPrecision; ++qIdx) {
+    Measure(q[qIdx]);
+  }
+}
+
+int main(int argc, char **argv) {
+  const int bits = argc > 1 ? std::stoi(argv[1]) : 3;
+  const int shots = argc > 2 ? std::stoi(argv[2]) : 1024;
+  workloads::Report report("qpe");
+  qcor::set_shots(shots);
+
+  auto q = qalloc(bits + 1);
+  workloads::trace(report, QuantumPhaseEstimation, q);
+  workloads::execute(report, q);
+
+  // The most frequent outcome, measured qubit k is the bit of weight
+  // 2^(k - bits), e.g. "100" is a phase of 1/8
+  auto histogram = qcor::counts(q);
+  std::size_t best = 0;
+  for (std::size_t i = 1; i < histogram.size(); i++) {
+    if (histogram.count(i) > histogram.count(best)) {
+      best = i;
+    }
+  }
+  double phase = 0.0;
+  for (int k = 0; k < bits && histogram.size() > 0; k++) {
+    phase += histogram.bit(best, k) ? std::ldexp(1.0, k - bits) : 0.0;
+  }
+
+  report.parameter("qubits", bits + 1);
+  report.parameter("shots", shots);
+  report.result("phase", phase);
+  report.result("distinct_outcomes", histogram.size());
+  report.print();
+}
@@ -0,0 +1,139 @@
+#ifndef RUNTIME_BENCHMARKS_WORKLOADS_WORKLOAD_HPP_
+#define RUNTIME_BENCHMARKS_WORKLOADS_WORKLOAD_HPP_
+
+#include "qcor.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <sys/resource.h>
+
+// Timing helpers for the end-to-end workloads, see run_workloads.in. A
+// workload splits its run into phases:
+//   trace        : running kernels with execution off to record their
+//                  programs, and building the per-term measured circuits
+//   execute      : handing programs to the accelerator
+//   post_process : everything else, e.g. weighted sums, optimizer steps
+//                  and reading counts
+// and prints one JSON object on the last line of its output. Compile
+// time is measured by the harness around the qcor invocation.
+namespace qcor {
+namespace workloads {
+
+class Report {
+public:
+  explicit Report(const std::string &name)
+      : m_name(name), m_start(clock::now()) {}
+
+  // Run f, adding its wall time to phase
+  template <typename F> auto time(const std::string &phase, F &&f) {
+    struct Stop {
+      double &seconds;
+      clock::time_point start = clock::now();
+      ~Stop() {
+        seconds +=
+            std::chrono::duration<double>(clock::now() - start).count();
+      }
+    } stop{m_phases[phase]};
+    return f();
+  }
+
+  void add_circuits(const std::size_t n) { m_circuits += n; }
+  // Workload parameters (problem size) and results (energies, phases)
+  void parameter(const std::string &key, const double value) {
+    m_parameters[key] = value;
+  }
+  void result(const std::string &key, const double value) {
+    m_results[key] = value;
+  }
+
+  // Print the report. Time not spent tracing or executing counts as
+  // post-processing.
+  void print(std::ostream &os = std::cout) {
+    const double total =
+        std::chrono::duration<double>(clock::now() - m_start).count();
+    const auto trace = m_phases["trace"], execute = m_phases["execute"];
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::stringstream ss;
+    ss.precision(9);
+    ss << "{\"workload\": \"" << m_name << "\", \"qpu\": \""
+       << xacc::internal_compiler::get_qpu()->name() << "\"";
+    ss << ", \"parameters\": " << to_json(m_parameters);
+    ss << ", \"trace_seconds\": " << trace;
+    ss << ", \"execute_seconds\": " << execute;
+    ss << ", \"post_process_seconds\": " << total - trace - execute;
+    ss << ", \"run_seconds\": " << total;
+    ss << ", \"circuits_executed\": " << m_circuits;
+    // ru_maxrss is in kB on Linux
+    ss << ", \"peak_rss_kb\": " << usage.ru_maxrss;
+    ss << ", \"results\": " << to_json(m_results) << "}";
+    os << ss.str() << std::endl;
+  }
+
+private:
+  using clock = std::chrono::steady_clock;
+  std::string m_name;
+  clock::time_point m_start;
+  std::map<std::string, double> m_phases;
+  std::map<std::string, double> m_parameters, m_results;
+  std::size_t m_circuits = 0;
+
+  static std::string to_json(const std::map<std::string, double> &values) {
+    std::stringstream ss;
+    ss.precision(12);
+    ss << "{";
+    for (auto iter = values.begin(); iter != values.end(); ++iter) {
+      ss << (iter == values.begin() ? "" : ", ") << "\"" << iter->first
+         << "\": " << iter->second;
+    }
+    ss << "}";
+    return ss.str();
+  }
+};
+
+// Record the program of a kernel without executing it
+template <typename QuantumKernel, typename... Args>
+std::shared_ptr<CompositeInstruction> trace(Report &report,
+                                            QuantumKernel &kernel,
+                                            Args... args) {
+  return report.time("trace", [&]() {
+    return __internal__::kernel_as_composite_instruction(kernel, args...);
+  });
+}
+
+// Execute the program last traced on q
+inline void execute(Report &report, qreg &q) {
+  report.time("execute", [&]() { quantum::submit(q.results()); });
+  report.add_circuits(1);
+}
+
+// <obs> for a traced program, split into phases the way
+// __internal__::observe proceeds
+inline double observe(Report &report,
+                      std::shared_ptr<CompositeInstruction> program,
+                      Observable &obs, qreg &q) {
+  double exp_val = 0.0;
+  const bool exact = report.time("execute", [&]() {
+    return __internal__::exact_observe(program, obs, q, exp_val);
+  });
+  if (exact) {
+    report.add_circuits(1);
+    return exp_val;
+  }
+  auto programs = report.time("trace", [&]() { return obs.observe(program); });
+  report.time("execute", [&]() {
+    xacc::internal_compiler::execute(q.results(), programs);
+  });
+  report.add_circuits(programs.size());
+  return q.weighted_sum(&obs);
+}
+
+} // namespace workloads
+} // namespace qcor
+
+#endif
@@ -84,24 +84,26 @@ protected:
 
     // Here we have an evaluated RBM, execute it, and get its counts back
     xacc::internal_compiler::execute(tmp_child.results(), tmp_kernel.get());
-    auto counts = tmp_child.counts();
+    auto counts = qcor::counts(tmp_child);
     std::cout << "EXECUTED\n";
     int shots = 0;
     std::vector<std::vector<int>> states;
     std::vector<int> state_counts_vec;
-    std::vector<std::string> states_str;
-    for (auto &kv : counts) {
-      std::cout << "COUNT: " << kv.first << ", " << kv.second << "\n";
+    // Visible units of each outcome as an integer, first unit highest
+    std::vector<int> state_index;
+    for (std::size_t k = 0; k < counts.size(); k++) {
+      std::cout << "COUNT: " << counts.bitstring(k) << ", "
+                << counts.count(k) << "\n";
       std::vector<int> tmp;
-      std::string tmp_str = "";
+      int index = 0;
       for (int i = 0; i < nv; i++) {
-        tmp.push_back(kv.first[i] == '1' ? 1 : -1);
-        tmp_str += kv.first[i];
+        tmp.push_back(counts.bit(k, i) ? 1 : -1);
+        index = 2 * index + counts.bit(k, i);
       }
-      state_counts_vec.push_back(kv.second);
+      state_counts_vec.push_back(counts.count(k));
       states.push_back(tmp);
-      states_str.push_back(tmp_str);
-      shots += kv.second;
+      state_index.push_back(index);
+      shots += counts.count(k);
     }
     
     Eigen::VectorXd state_counts(state_counts_vec.size());
@@ -170,13 +172,11 @@ protected:
     Eigen::VectorXd Eloc = Eigen::VectorXd::Zero(psi.rows());
     for (int i = 0; i < Eloc.rows(); i++) {
       double local_energy = 0.0;
-      auto x = states_str[i];
-      std::cout << "X IS " << x << "\n";
-      auto x_i = std::stoi(x, 0, 2);
-      for (int j = 0; j < states_str.size(); j++) {
-        auto x1 = states_str[j];
-        auto x1_j = std::stoi(x1, 0, 2);
-        std::cout << "X1 IS " << x1 << "\n";
+      auto x_i = state_index[i];
+      std::cout << "X IS " << x_i << "\n";
+      for (int j = 0; j < state_index.size(); j++) {
+        auto x1_j = state_index[j];
+        std::cout << "X1 IS " << x1_j << "\n";
 
         auto found_triplet =
             std::find_if(ham_mat_elements.begin(), ham_mat_elements.end(),
@@ -10,8 +10,57 @@
 #include "qrt.hpp"
 
 namespace qcor {
+PauliOperator X(int idx) { return PauliOperator({{idx, "X"}}); }
+
+PauliOperator Y(int idx) { return PauliOperator({{idx, "Y"}}); }
+
+PauliOperator Z(int idx) { return PauliOperator({{idx, "Z"}}); }
+
+PauliOperator allZs(const int nQubits) {
+  auto ret = Z(0);
+  for (int i = 1; i < nQubits; i++) {
+    ret *= Z(i);
+  }
+  return ret;
+}
+
+template PauliOperator operator+<double>(double, PauliOperator &);
+template PauliOperator operator+<double>(PauliOperator &, double);
+template PauliOperator operator-<double>(double, PauliOperator &);
+template PauliOperator operator-<double>(PauliOperator &, double);
+
+PauliOperator SP(int idx) {
+  std::complex<double> imag(0.0, 1.0);
+  return X(idx) + imag * Y(idx);
+}
+
+PauliOperator SM(int idx) {
+  std::complex<double> imag(0.0, 1.0);
+  return X(idx) - imag * Y(idx);
+}
+
+ResultsBuffer sync(Handle &handle) { return handle.get(); }
+
 void set_verbose(bool verbose) { xacc::set_verbose(verbose); }
 void set_shots(const int shots) { quantum::set_shots(shots); }
+void set_streaming(const std::size_t chunk_size) {
+  quantum::set_streaming(chunk_size);
+}
+void set_profiling(const bool enable, const std::string &trace_file) {
+  quantum::profiling::set_output(trace_file);
+  quantum::profiling::set_enabled(enable);
+}
+Histogram counts(xacc::internal_compiler::qreg &q) {
+  return Histogram::from_buffer(q.results());
+}
+void set_backend(const std::string &backend) {
+  xacc::internal_compiler::compiler_InitializeXACC();
+  xacc::internal_compiler::setAccelerator(backend.c_str());
+}
+void set_backend(const std::string &backend, HeterogeneousMap &&options) {
+  set_backend(backend);
+  xacc::internal_compiler::get_qpu()->updateConfiguration(options);
+}
 
 namespace __internal__ {
 std::shared_ptr<ObjectiveFunction> get_objective(const std::string &type) {
@@ -32,14 +81,77 @@ observe(std::shared_ptr<xacc::Observable> obs,
   return obs->observe(program);
 }
 
+namespace {
+// The backend as an ExactExpectation, and obs as a PauliSum with the term
+// names, if observe() can be evaluated exactly
+ExactExpectation *exact_backend(Observable &obs, PauliSum &sum,
+                                std::vector<std::string> &names) {
+  auto qpu = xacc::internal_compiler::get_qpu();
+  auto exact = dynamic_cast<ExactExpectation *>(qpu.get());
+  auto pauli = dynamic_cast<PauliOperator *>(&obs);
+  if (!exact || !pauli || !exact->exact_expectations()) {
+    return nullptr;
+  }
+
+  // Keep the term names, the child buffers are named like the
+  // kernels Observable::observe() would have produced
+  auto terms = pauli->getTerms();
+  sum.reserve(terms.size());
+  for (auto &[id, term] : terms) {
+    if (!std::get<1>(term).empty()) {
+      // Symbolic coefficient, leave it to the generic path
+      return nullptr;
+    }
+    names.push_back(id);
+    sum.add_term(std::get<0>(term), std::get<2>(term));
+  }
+  return exact;
+}
+} // namespace
+
+bool exact_observe(std::shared_ptr<CompositeInstruction> program,
+                   Observable &obs, xacc::internal_compiler::qreg &q,
+                   double &exp_val) {
+  PauliSum sum;
+  std::vector<std::string> names;
+  auto exact = exact_backend(obs, sum, names);
+  if (!exact) {
+    return false;
+  }
+
+  auto exp_vals = exact->pauli_expectations(q.results(), program, sum);
+  exp_val = 0.0;
+  for (std::size_t t = 0; t < sum.n_terms(); t++) {
+    exp_val += (sum.coefficient(t) * exp_vals[t]).real();
+    if (sum.weight(t) > 0) {
+      auto child = std::make_shared<xacc::AcceleratorBuffer>(names[t],
+                                                             q.size());
+      child->addExtraInfo("exp-val-z", exp_vals[t]);
+      q.results()->appendChild(names[t], child);
+    }
+  }
+  return true;
+}
+
 double observe(std::shared_ptr<CompositeInstruction> program,
                std::shared_ptr<xacc::Observable> obs,
                xacc::internal_compiler::qreg &q) {
   return [program, obs, &q]() {
+    quantum::profiling::Scope scope("observe");
+    double exp_val;
+    if (exact_observe(program, *obs, q, exp_val)) {
+      quantum::profiling::count("circuits executed");
+      return exp_val;
+    }
+
     // Observe the program
     auto programs = __internal__::observe(obs, program);
 
-    xacc::internal_compiler::execute(q.results(), programs);
+    {
+      quantum::profiling::Scope execute("xacc::internal_compiler::execute");
+      quantum::profiling::count("circuits executed", programs.size());
+      xacc::internal_compiler::execute(q.results(), programs);
+    }
 
     // We want to contract q children buffer
     // exp-val-zs with obs term coeffs
@@ -50,16 +162,71 @@ double observe(std::shared_ptr<CompositeInstruction> program,
 double observe(std::shared_ptr<CompositeInstruction> program, Observable &obs,
                xacc::internal_compiler::qreg &q) {
   return [program, &obs, &q]() {
+    quantum::profiling::Scope scope("observe");
+    double exp_val;
+    if (exact_observe(program, obs, q, exp_val)) {
+      quantum::profiling::count("circuits executed");
+      return exp_val;
+    }
+
     // Observe the program
     auto programs = obs.observe(program);
 
-    xacc::internal_compiler::execute(q.results(), programs);
+    {
+      quantum::profiling::Scope execute("xacc::internal_compiler::execute");
+      quantum::profiling::count("circuits executed", programs.size());
+      xacc::internal_compiler::execute(q.results(), programs);
+    }
 
     // We want to contract q children buffer
     // exp-val-zs with obs term coeffs
     return q.weighted_sum(&obs);
   }();
 }
+
+double observe(std::shared_ptr<CompositeInstruction> program,
+               const PauliSum &obs, xacc::internal_compiler::qreg &q) {
+  auto qpu = xacc::internal_compiler::get_qpu();
+  auto exact = dynamic_cast<ExactExpectation *>(qpu.get());
+  if (!exact || !exact->exact_expectations()) {
+    auto op = obs.to_pauli_operator();
+    return observe(program, op, q);
+  }
+
+  quantum::profiling::Scope scope("observe");
+  quantum::profiling::count("circuits executed");
+  auto exp_vals = exact->pauli_expectations(q.results(), program, obs);
+  double exp_val = 0.0;
+  for (std::size_t t = 0; t < obs.n_terms(); t++) {
+    exp_val += (obs.coefficient(t) * exp_vals[t]).real();
+  }
+  return exp_val;
+}
+
+std::vector<double>
+observe(const std::vector<std::shared_ptr<CompositeInstruction>> &programs,
+        Observable &obs, xacc::internal_compiler::qreg &q) {
+  PauliSum sum;
+  std::vector<std::string> names;
+  auto exact = exact_backend(obs, sum, names);
+  std::vector<double> results;
+  if (!exact) {
+    for (auto &program : programs) {
+      results.push_back(observe(program, obs, q));
+    }
+    return results;
+  }
+
+  for (auto &exp_vals : exact->pauli_expectations(q.results(), programs,
+                                                  sum)) {
+    double exp_val = 0.0;
+    for (std::size_t t = 0; t < sum.n_terms(); t++) {
+      exp_val += (sum.coefficient(t) * exp_vals[t]).real();
+    }
+    results.push_back(exp_val);
+  }
+  return results;
+}
 } // namespace __internal__
 
 std::shared_ptr<xacc::Optimizer> createOptimizer(const std::string &type,
@@ -75,10 +242,47 @@ std::shared_ptr<xacc::Observable> createObservable(const std::string &repr) {
   return xacc::quantum::getObservable("pauli", std::string(repr));
 }
 
+std::shared_ptr<xacc::Observable>
+createObservableFromFile(const std::string &file_name, const int n_threads) {
+  auto sum = load_pauli_sum(file_name, n_threads);
+  return std::make_shared<PauliOperator>(sum.to_pauli_operator());
+}
+
+std::shared_ptr<ObjectiveFunction> createObjectiveFunction(
+    const std::string &obj_name, std::shared_ptr<CompositeInstruction> kernel,
+    std::shared_ptr<Observable> observable, HeterogeneousMap &&options) {
+  auto obj_func = qcor::__internal__::get_objective(obj_name);
+  obj_func->initialize(observable.get(), kernel);
+  obj_func->set_options(options);
+  return obj_func;
+}
+
+std::shared_ptr<ObjectiveFunction> createObjectiveFunction(
+    const std::string &obj_name, std::shared_ptr<CompositeInstruction> kernel,
+    Observable &observable, HeterogeneousMap &&options) {
+  auto obj_func = qcor::__internal__::get_objective(obj_name);
+  obj_func->initialize(&observable, kernel);
+  obj_func->set_options(options);
+  return obj_func;
+}
+
 std::shared_ptr<xacc::CompositeInstruction> compile(const std::string &src) {
   return xacc::getCompiler("xasm")->compile(src)->getComposites()[0];
 }
 
+namespace {
+// f, with each evaluation the optimizer makes timed as one iteration
+qcor::OptFunction profiled(qcor::OptFunction &f) {
+  return qcor::OptFunction(
+      [&f](const std::vector<double> &x, std::vector<double> &dx) {
+        quantum::profiling::Scope scope("taskInitiate iteration");
+        quantum::profiling::count("taskInitiate iterations");
+        return f(x, dx);
+      },
+      f.dimensions());
+}
+} // namespace
+
 Handle taskInitiate(std::shared_ptr<ObjectiveFunction> objective,
                     std::shared_ptr<Optimizer> optimizer,
                     std::function<double(const std::vector<double>,
@@ -86,7 +290,8 @@ Handle taskInitiate(std::shared_ptr<ObjectiveFunction> objective,
                     const int nParameters) {
   return std::async(std::launch::async, [=]() -> ResultsBuffer {
     qcor::OptFunction f(opt_function, nParameters);
-    auto results = optimizer->optimize(f);
+    auto iteration = profiled(f);
+    auto results = optimizer->optimize(iteration);
     ResultsBuffer rb;
     rb.q_buffer = objective->get_qreg();
     rb.opt_params = results.second;
@@ -99,7 +304,8 @@ Handle taskInitiate(std::shared_ptr<ObjectiveFunction> objective,
                     std::shared_ptr<Optimizer> optimizer,
                     qcor::OptFunction &&opt_function) {
   return std::async(std::launch::async, [=, &opt_function]() -> ResultsBuffer {
-    auto results = optimizer->optimize(opt_function);
+    auto iteration = profiled(opt_function);
+    auto results = optimizer->optimize(iteration);
     ResultsBuffer rb;
     rb.q_buffer = objective->get_qreg();
     rb.opt_params = results.second;
@@ -112,7 +318,8 @@ Handle taskInitiate(std::shared_ptr<ObjectiveFunction> objective,
                     std::shared_ptr<Optimizer> optimizer,
                     qcor::OptFunction &opt_function) {
   return std::async(std::launch::async, [=, &opt_function]() -> ResultsBuffer {
-    auto results = optimizer->optimize(opt_function);
+    auto iteration = profiled(opt_function);
+    auto results = optimizer->optimize(iteration);
     ResultsBuffer rb;
     rb.q_buffer = objective->get_qreg();
     rb.opt_params = results.second;
@@ -12,9 +12,16 @@
 #include "Optimizer.hpp"
 
 #include "PauliOperator.hpp"
+#include "qcor_aot.hpp"
+#include "qcor_expectation.hpp"
+#include "qcor_histogram.hpp"
+#include "qcor_pauli.hpp"
+#include "qcor_pauli_io.hpp"
+#include "qcor_tape_io.hpp"
 #include "qalloc"
 #include "xacc_internal_compiler.hpp"
 
+#include "profiler.hpp"
 #include "qrt.hpp"
 
 namespace qcor {
@@ -26,19 +33,14 @@ using Optimizer = xacc::Optimizer;
 using CompositeInstruction = xacc::CompositeInstruction;
 using PauliOperator = xacc::quantum::PauliOperator;
 
-PauliOperator X(int idx) { return PauliOperator({{idx, "X"}}); }
+PauliOperator X(int idx);
 
-PauliOperator Y(int idx) { return PauliOperator({{idx, "Y"}}); }
+PauliOperator Y(int idx);
 
-PauliOperator Z(int idx) { return PauliOperator({{idx, "Z"}}); }
+PauliOperator Z(int idx);
 
-PauliOperator allZs(const int nQubits) {
-  auto ret = Z(0);
-  for (int i = 1; i < nQubits; i++) {
-    ret *= Z(i);
-  }
-  return ret;
-}
+// Z(0) * Z(1) * ... * Z(nQubits - 1)
+PauliOperator allZs(const int nQubits);
 
 template <typename T> PauliOperator operator+(T coeff, PauliOperator &op) {
   return PauliOperator(coeff) + op;
@@ -55,15 +57,17 @@ template <typename T> PauliOperator operator-(PauliOperator &op, T coeff) {
   return -1.0 * coeff + op;
 }
 
-PauliOperator SP(int idx) {
-  std::complex<double> imag(0.0, 1.0);
-  return X(idx) + imag * Y(idx);
-}
+// Instantiated once in libqcor for double coefficients
+extern template PauliOperator operator+<double>(double, PauliOperator &);
+extern template PauliOperator operator+<double>(PauliOperator &, double);
+extern template PauliOperator operator-<double>(double, PauliOperator &);
+extern template PauliOperator operator-<double>(PauliOperator &, double);
 
-PauliOperator SM(int idx) {
-  std::complex<double> imag(0.0, 1.0);
-  return X(idx) - imag * Y(idx);
-}
+// X(idx) + iY(idx)
+PauliOperator SP(int idx);
+
+// X(idx) - iY(idx)
+PauliOperator SM(int idx);
 
 class ResultsBuffer {
 public:
@@ -73,10 +77,23 @@ public:
 };
 
 using Handle = std::future<ResultsBuffer>;
-ResultsBuffer sync(Handle &handle) { return handle.get(); }
+ResultsBuffer sync(Handle &handle);
 
 void set_verbose(bool verbose);
 void set_shots(const int shots);
+// Stream kernels to in-process backends every chunk_size gates, 0 turns
+// streaming off. See quantum::set_streaming().
+void set_streaming(const std::size_t chunk_size);
+// Time the runtime phases (tracing, submission, execution, observe,
+// objective evaluations, optimizer iterations). At exit the times are
+// printed as a summary table, or written as a Chrome trace to trace_file
+// if given. See quantum::profiling.
+void set_profiling(const bool enable, const std::string &trace_file = "");
+
+// The measurement counts of q as a packed Histogram, whether the backend
+// recorded bitstrings or packed counts (e.g. qcor-sv with packed-counts).
+// Prefer it to q.counts() for wide registers and many shots.
+Histogram counts(xacc::internal_compiler::qreg &q);
 
 class ObjectiveFunction;
 
@@ -110,8 +127,14 @@ template <typename Function, typename Tuple> auto call(Function f, Tuple t) {
 template <typename QuantumKernel, typename... Args>
 std::shared_ptr<CompositeInstruction>
 kernel_as_composite_instruction(QuantumKernel &k, Args... args) {
+  quantum::profiling::Scope scope("kernel_as_composite_instruction");
 #ifdef QCOR_USE_QRT
   quantum::clearProgram();
+  // The IR is wanted here, so record it whole
+  const auto cached_chunk_size = quantum::get_streaming();
+  quantum::set_streaming(0);
+#else
+  __internal__::take_last_aot_kernel();
 #endif
   // turn off execution
   const auto cached_exec = xacc::internal_compiler::__execute;
@@ -121,8 +144,13 @@ kernel_as_composite_instruction(QuantumKernel &k, Args... args) {
   // turn execution on
   xacc::internal_compiler::__execute = cached_exec;
 #ifdef QCOR_USE_QRT
+  quantum::set_streaming(cached_chunk_size);
   return quantum::getProgram();
 #else
+  // Kernels compiled ahead of time are not known to the xacc compilers
+  if (auto program = __internal__::take_last_aot_kernel()) {
+    return program;
+  }
   return xacc::internal_compiler::getLastCompiled();
 #endif
 }
@@ -131,6 +159,28 @@ kernel_as_composite_instruction(QuantumKernel &k, Args... args) {
 double observe(std::shared_ptr<CompositeInstruction> program,
                std::shared_ptr<Observable> obs,
                xacc::internal_compiler::qreg &q);
+double observe(std::shared_ptr<CompositeInstruction> program, Observable &obs,
+               xacc::internal_compiler::qreg &q);
+// Observe a PauliSum. Exact backends take it as it is, with no per-term
+// child buffers appended to q; other backends observe it converted to a
+// PauliOperator.
+double observe(std::shared_ptr<CompositeInstruction> program,
+               const PauliSum &obs, xacc::internal_compiler::qreg &q);
+
+// <obs> for each of the programs, e.g. one ansatz at many parameter
+// sets. With an exact backend they are evaluated in one batched call and
+// no per-term child buffers are appended to q, otherwise each is
+// observed in turn.
+std::vector<double>
+observe(const std::vector<std::shared_ptr<CompositeInstruction>> &programs,
+        Observable &obs, xacc::internal_compiler::qreg &q);
+
+// If the backend supports it (see ExactExpectation) and obs is a Pauli
+// observable, compute <obs> for the kernel from a single simulation,
+// append per-term child buffers to q and return true.
+bool exact_observe(std::shared_ptr<CompositeInstruction> program,
+                   Observable &obs, xacc::internal_compiler::qreg &q,
+                   double &exp_val);
 
 // Observe the kernel and return the measured kernels
 std::vector<std::shared_ptr<CompositeInstruction>>
@@ -144,12 +194,40 @@ get_transformation(const std::string &transform_type);
 
 } // namespace __internal__
 
+// Print the kernel one instruction per line. In QRT mode the lines are
+// written from the gate tape as they go, so the program can be streamed
+// to e.g. a std::ofstream without building its string first. Kernels
+// with gates the tape cannot hold are printed from the xacc IR.
 template <typename QuantumKernel, typename... Args>
 void print_kernel(std::ostream &os, QuantumKernel &kernel, Args... args) {
+#ifdef QCOR_USE_QRT
+  auto program = __internal__::kernel_as_composite_instruction(kernel, args...);
+  if (auto tape = quantum::tryGetTape()) {
+    print_tape(os, *tape);
+  } else {
+    os << program->toString();
+  }
+  quantum::clearProgram();
+#else
   os << __internal__::kernel_as_composite_instruction(kernel, args...)
             ->toString();
+#endif
+}
+
+// Record the kernel and write it to file_name in the binary tape format,
+// see qcor_tape_io.hpp. Read it back with load_tape() or TapeReader.
+// Fails for kernels with gates the tape cannot hold.
+template <typename QuantumKernel, typename... Args>
+void save_kernel(const std::string &file_name, QuantumKernel &kernel,
+                 Args... args) {
 #ifdef QCOR_USE_QRT
+  __internal__::kernel_as_composite_instruction(kernel, args...);
+  save_tape(quantum::getTape(), file_name);
   quantum::clearProgram();
+#else
+  quantum::GateTape tape;
+  tape.add(__internal__::kernel_as_composite_instruction(kernel, args...));
+  save_tape(tape, file_name);
 #endif
 }
 
@@ -226,6 +304,7 @@ public:
   // quantum kernel
   template <typename... ArgumentTypes>
   double operator()(ArgumentTypes... args) {
+    quantum::profiling::Scope scope("objective evaluation");
 #ifdef QCOR_USE_QRT
     auto functor =
         reinterpret_cast<void (*)(ArgumentTypes...)>(pointer_to_functor);
@@ -250,10 +329,10 @@ public:
   }
 };
 
-void set_backend(const std::string &backend) {
-  xacc::internal_compiler::compiler_InitializeXACC();
-  xacc::internal_compiler::setAccelerator(backend.c_str());
-}
+void set_backend(const std::string &backend);
+// Select backend and configure it, e.g.
+// set_backend("qcor-sv", {{"precision", "single"}})
+void set_backend(const std::string &backend, HeterogeneousMap &&options);
 
 std::shared_ptr<CompositeInstruction> compile(const std::string &src);
 
@@ -271,14 +350,7 @@ auto observe(QuantumKernel &kernel, std::shared_ptr<Observable> obs,
     program->updateRuntimeArguments(args...);
 #endif
 
-    // Observe the program
-    auto programs = obs->observe(program);
-
-    xacc::internal_compiler::execute(q.results(), programs);
-
-    // We want to contract q children buffer
-    // exp-val-zs with obs term coeffs
-    return q.weighted_sum(obs.get());
+    return __internal__::observe(program, obs, q);
   }(args...);
 }
 
@@ -295,17 +367,63 @@ auto observe(QuantumKernel &kernel, Observable &obs, Args... args) {
     program->updateRuntimeArguments(args...);
 #endif
 
-    // Observe the program
-    auto programs = obs.observe(program);
+    return __internal__::observe(program, obs, q);
+  }(args...);
+}
+
+// Public observe function for an observable held as a PauliSum, e.g. a
+// Hamiltonian read with load_pauli_sum. On exact backends (qcor-sv) the
+// sum is never converted to a string-keyed PauliOperator.
+template <typename QuantumKernel, typename... Args>
+auto observe(QuantumKernel &kernel, const PauliSum &obs, Args... args) {
+  auto program = __internal__::kernel_as_composite_instruction(kernel, args...);
+  return [program, &obs](Args... args) {
+    // Get the first argument, which should be a qreg
+    auto q = std::get<0>(std::forward_as_tuple(args...));
 
-    xacc::internal_compiler::execute(q.results(), programs);
+    // Set the arguments on the IR
+#ifndef QCOR_USE_QRT
+    program->updateRuntimeArguments(args...);
+#endif
 
-    // We want to contract q children buffer
-    // exp-val-zs with obs term coeffs
-    return q.weighted_sum(&obs);
+    return __internal__::observe(program, obs, q);
   }(args...);
 }
 
+// Observe the kernel once per argument set, returning the expected value
+// of obs for each. On backends that simulate parameter sets together
+// (e.g. qcor-sv) this is much cheaper than calling observe() in a loop.
+template <typename QuantumKernel, typename... Args>
+std::vector<double>
+observe_batch(QuantumKernel &kernel, Observable &obs,
+              const std::vector<std::tuple<Args...>> &arg_sets) {
+  if (arg_sets.empty()) {
+    return {};
+  }
+#ifdef QCOR_USE_QRT
+  // Each recording starts a fresh program, so they can be kept together
+  std::vector<std::shared_ptr<CompositeInstruction>> programs;
+  for (auto &args : arg_sets) {
+    programs.push_back(std::apply(
+        [&kernel](Args... a) {
+          return __internal__::kernel_as_composite_instruction(kernel, a...);
+        },
+        args));
+  }
+  auto q = std::get<0>(arg_sets[0]);
+  return __internal__::observe(programs, obs, q);
+#else
+  // The compiled program is updated in place per argument set
+  std::vector<double> results;
+  for (auto &args : arg_sets) {
+    results.push_back(std::apply(
+        [&kernel, &obs](Args... a) { return observe(kernel, obs, a...); },
+        args));
+  }
+  return results;
+#endif
+}
+
 // Create the desired Optimizer
 std::shared_ptr<xacc::Optimizer>
 createOptimizer(const std::string &type, HeterogeneousMap &&options = {});
@@ -313,23 +431,22 @@ createOptimizer(const std::string &type, HeterogeneousMap &&options = {});
 // Create an observable from a string representation
 std::shared_ptr<Observable> createObservable(const std::string &repr);
 
+// Create an observable from a Hamiltonian file, either Pauli text or
+// the binary PauliSum format. The file is memory-mapped and parsed in
+// parallel, see load_pauli_sum. The result is converted to a
+// PauliOperator term by term; for large Hamiltonians prefer
+// load_pauli_sum and the PauliSum overload of observe().
+std::shared_ptr<Observable>
+createObservableFromFile(const std::string &file_name, const int n_threads = 0);
+
+// Create an Objective Function for an already compiled kernel
 std::shared_ptr<ObjectiveFunction> createObjectiveFunction(
     const std::string &obj_name, std::shared_ptr<CompositeInstruction> kernel,
-    std::shared_ptr<Observable> observable, HeterogeneousMap &&options = {}) {
-  auto obj_func = qcor::__internal__::get_objective(obj_name);
-  obj_func->initialize(observable.get(), kernel);
-  obj_func->set_options(options);
-  return obj_func;
-}
+    std::shared_ptr<Observable> observable, HeterogeneousMap &&options = {});
 
 std::shared_ptr<ObjectiveFunction> createObjectiveFunction(
     const std::string &obj_name, std::shared_ptr<CompositeInstruction> kernel,
-    Observable &observable, HeterogeneousMap &&options = {}) {
-  auto obj_func = qcor::__internal__::get_objective(obj_name);
-  obj_func->initialize(&observable, kernel);
-  obj_func->set_options(options);
-  return obj_func;
-}
+    Observable &observable, HeterogeneousMap &&options = {});
 
 // Create an Objective Function that makes calls to the
 // provided Quantum Kernel, with measurements dictated by
@@ -0,0 +1,130 @@
+#include "qcor_aot.hpp"
+#include "qcor_tape_io.hpp"
+
+#include "CompositeInstruction.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace qcor {
+namespace __internal__ {
+namespace {
+struct AotEntry {
+  std::once_flag decoded;
+  std::shared_ptr<xacc::CompositeInstruction> program;
+};
+
+// Entries are never removed, so a reference to one stays valid after the
+// lock is released
+class AotRegistry {
+public:
+  AotEntry &entry(const std::uint64_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &entry = m_entries[id];
+    if (!entry) {
+      entry = std::make_unique<AotEntry>();
+    }
+    return *entry;
+  }
+
+private:
+  std::mutex m_mutex;
+  std::unordered_map<std::uint64_t, std::unique_ptr<AotEntry>> m_entries;
+};
+
+AotRegistry &registry() {
+  static AotRegistry instance;
+  return instance;
+}
+
+thread_local std::shared_ptr<xacc::CompositeInstruction> last_aot_kernel;
+
+std::shared_ptr<xacc::CompositeInstruction>
+decode(const char *name, const void *ir, const std::size_t size,
+       const char *const *arguments, const std::size_t n_arguments) {
+  TapeReader reader(ir, size, std::string("IR of kernel ") + name);
+  auto provider = xacc::getIRProvider("quantum");
+  auto program = provider->createComposite(name);
+  for (std::size_t a = 0; a < n_arguments; a++) {
+    program->addArgument(arguments[2 * a], arguments[2 * a + 1]);
+  }
+
+  std::unordered_map<std::uint32_t, std::uint32_t> symbol_of;
+  for (std::size_t s = 0; s < reader.n_slots(); s++) {
+    symbol_of[reader.slots()[s].param] = reader.slots()[s].symbol;
+  }
+
+  const auto &registers = reader.registers();
+  const auto &symbols = reader.symbols();
+  for (std::size_t g = 0; g < reader.size(); g++) {
+    const auto &record = reader.records()[g];
+    const auto n_qubits = quantum::gate_n_qubits(record.op);
+    const auto n_params = quantum::gate_n_params(record.op);
+    if (record.param + n_params > reader.n_params()) {
+      xacc::error(std::string("[qcor] Corrupt IR of kernel ") + name);
+    }
+
+    std::vector<std::size_t> bits;
+    std::vector<std::string> buffer_names;
+    for (int q = 0; q < n_qubits; q++) {
+      bits.push_back(record.bit[q]);
+      buffer_names.push_back(registers.at(record.reg[q]));
+    }
+    // Symbolic parameters name the kernel argument they are bound to
+    std::vector<xacc::InstructionParameter> params;
+    std::vector<std::pair<int, std::string>> bound;
+    for (int p = 0; p < n_params; p++) {
+      const auto index = record.param + p;
+      auto symbol = symbol_of.end();
+      if (record.flags & tape_symbolic) {
+        symbol = symbol_of.find(index);
+      }
+      if (symbol == symbol_of.end()) {
+        params.emplace_back(reader.params()[index]);
+        continue;
+      }
+      const auto &expression = symbols.at(symbol->second);
+      params.emplace_back(expression);
+      bound.emplace_back(p, expression.substr(0, expression.find('[')));
+    }
+
+    auto inst = provider->createInstruction(quantum::gate_name(record.op),
+                                            bits, params);
+    inst->setBufferNames(buffer_names);
+    for (auto &[p, argument_name] : bound) {
+      auto argument = program->getArgument(argument_name);
+      if (!argument) {
+        xacc::error("[qcor] Kernel " + std::string(name) +
+                    " has no argument " + argument_name);
+      }
+      inst->addArgument(argument, p);
+    }
+    program->addInstruction(inst);
+  }
+
+  // Kernels compiled at runtime may call this one by name
+  xacc::appendCompiled(program, true);
+  return program;
+}
+} // namespace
+
+std::shared_ptr<xacc::CompositeInstruction>
+aot_kernel(const std::uint64_t id, const char *name, const void *ir,
+           const std::size_t size, const char *const *arguments,
+           const std::size_t n_arguments) {
+  auto &entry = registry().entry(id);
+  std::call_once(entry.decoded, [&]() {
+    entry.program = decode(name, ir, size, arguments, n_arguments);
+  });
+  last_aot_kernel = entry.program;
+  return entry.program;
+}
+
+std::shared_ptr<xacc::CompositeInstruction> take_last_aot_kernel() {
+  return std::move(last_aot_kernel);
+}
+
+} // namespace __internal__
+} // namespace qcor
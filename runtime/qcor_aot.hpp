@@ -0,0 +1,54 @@
+#ifndef RUNTIME_QCOR_AOT_HPP_
+#define RUNTIME_QCOR_AOT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace xacc {
+class CompositeInstruction;
+}
+
+namespace qcor {
+namespace __internal__ {
+
+// Kernels compiled ahead of time. Outside of QRT mode the syntax handler
+// compiles a kernel made only of gates while the program is built, and
+// embeds its IR as a constant array in the object file, in the binary
+// tape format of qcor_tape_io.hpp. Symbolic gate parameters are kept as
+// the kernel arguments they name, e.g. theta or x[1].
+//
+// The first call of a kernel decodes its IR into a CompositeInstruction,
+// later calls share it. aot_kernel() is thread safe and decodes each id
+// exactly once. arguments holds n_arguments name and type pairs, the
+// kernel arguments as the xacc compiler saw them, so the program binds
+// them on updateRuntimeArguments() like one compiled at runtime.
+std::shared_ptr<xacc::CompositeInstruction>
+aot_kernel(const std::uint64_t id, const char *name, const void *ir,
+           const std::size_t size, const char *const *arguments,
+           const std::size_t n_arguments);
+
+// The program of the last aot_kernel() call on this thread, or nullptr.
+// Taking it clears it.
+std::shared_ptr<xacc::CompositeInstruction> take_last_aot_kernel();
+
+// The id of a kernel, FNV-1a of its name and IR. Kernels of the same name
+// in different translation units only share an id if their IR matches.
+inline std::uint64_t aot_kernel_id(const std::string &name, const void *ir,
+                                   const std::size_t size) {
+  std::uint64_t h = 0xcbf29ce484222325ULL;
+  auto hash = [&h](const unsigned char *data, const std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+      h = (h ^ data[i]) * 0x100000001b3ULL;
+    }
+  };
+  hash(reinterpret_cast<const unsigned char *>(name.data()), name.size() + 1);
+  hash(static_cast<const unsigned char *>(ir), size);
+  return h;
+}
+
+} // namespace __internal__
+} // namespace qcor
+
+#endif
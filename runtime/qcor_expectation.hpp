@@ -0,0 +1,52 @@
+#ifndef RUNTIME_QCOR_EXPECTATION_HPP_
+#define RUNTIME_QCOR_EXPECTATION_HPP_
+
+#include "qcor_pauli.hpp"
+#include <memory>
+#include <vector>
+
+namespace xacc {
+class AcceleratorBuffer;
+class CompositeInstruction;
+} // namespace xacc
+
+namespace qcor {
+
+// Accelerators that keep the full final state (state-vector simulators)
+// implement this next to xacc::Accelerator. observe() then evaluates a
+// Pauli observable from one simulation of the un-rotated program, instead
+// of executing one basis-rotated, sampled circuit per term.
+class ExactExpectation {
+public:
+  // True if observe() should use pauli_expectations() with the current
+  // configuration, e.g. no shots have been requested
+  virtual bool exact_expectations() = 0;
+
+  // Run program on buffer once and return <P_t> for every term t of obs,
+  // the coefficients are not applied
+  virtual std::vector<double>
+  pauli_expectations(xacc::AcceleratorBuffer *buffer,
+                     std::shared_ptr<xacc::CompositeInstruction> program,
+                     const PauliSum &obs) = 0;
+
+  // pauli_expectations() for many programs, e.g. one ansatz at many
+  // parameter sets. Entry p holds the expectations for programs[p].
+  // Backends override this to simulate programs that differ only in
+  // their gate angles together.
+  virtual std::vector<std::vector<double>> pauli_expectations(
+      xacc::AcceleratorBuffer *buffer,
+      const std::vector<std::shared_ptr<xacc::CompositeInstruction>> &programs,
+      const PauliSum &obs) {
+    std::vector<std::vector<double>> exp_vals;
+    for (auto &program : programs) {
+      exp_vals.push_back(pauli_expectations(buffer, program, obs));
+    }
+    return exp_vals;
+  }
+
+  virtual ~ExactExpectation() {}
+};
+
+} // namespace qcor
+
+#endif
@@ -0,0 +1,254 @@
+#include "qcor_histogram.hpp"
+
+#include "AcceleratorBuffer.hpp"
+#include "xacc.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace qcor {
+namespace {
+// Key under which packed counts are attached to a buffer. The encoding is
+// n_bits, then per entry the key as 32 bit halves (low first) and the
+// count.
+const std::string packed_counts_key = "packed-counts";
+
+std::size_t words_for(const std::size_t n_bits) {
+  return (n_bits + Histogram::bits_per_word - 1) / Histogram::bits_per_word;
+}
+
+// The packed counts attached to buffer, empty if there are none
+Histogram packed_counts(xacc::AcceleratorBuffer *buffer) {
+  if (!buffer->hasExtraInfoKey(packed_counts_key)) {
+    return Histogram();
+  }
+  const auto data =
+      buffer->getInformation(packed_counts_key).as<std::vector<int>>();
+  Histogram h(data[0]);
+  std::vector<Histogram::word_t> key(h.n_words());
+  const auto stride = 2 * h.n_words() + 1;
+  for (std::size_t e = 1; e + stride <= data.size(); e += stride) {
+    for (std::size_t w = 0; w < h.n_words(); w++) {
+      key[w] = Histogram::word_t(std::uint32_t(data[e + 2 * w])) |
+               Histogram::word_t(std::uint32_t(data[e + 2 * w + 1])) << 32;
+    }
+    h.add(key.data(), data[e + stride - 1]);
+  }
+  return h;
+}
+} // namespace
+
+Histogram::Histogram(const std::size_t n_bits)
+    : m_bits(n_bits), m_words(words_for(n_bits)) {}
+
+void Histogram::add(const word_t *key, const std::size_t count) {
+  m_keys.insert(m_keys.end(), key, key + m_words);
+  m_counts.push_back(count);
+}
+
+void Histogram::add(const word_t key, const std::size_t count) {
+  if (m_words > 1) {
+    std::vector<word_t> words(m_words, 0);
+    words[0] = key;
+    return add(words.data(), count);
+  }
+  add(&key, count);
+}
+
+void Histogram::add(const std::string &bitstring, const std::size_t count) {
+  if (bitstring.size() != m_bits) {
+    xacc::error("[qcor] Bitstring " + bitstring + " does not have " +
+                std::to_string(m_bits) + " bits.");
+  }
+  std::vector<word_t> words(m_words, 0);
+  for (std::size_t m = 0; m < m_bits; m++) {
+    if (bitstring[m] == '1') {
+      words[m / bits_per_word] |= word_t(1) << (m % bits_per_word);
+    }
+  }
+  add(words.data(), count);
+}
+
+void Histogram::merge(const Histogram &other) {
+  if (other.empty()) {
+    return;
+  }
+  if (empty() && m_bits != other.m_bits) {
+    *this = Histogram(other.m_bits);
+  }
+  if (m_bits != other.m_bits) {
+    xacc::error("[qcor] Cannot merge histograms of " +
+                std::to_string(m_bits) + " and " +
+                std::to_string(other.m_bits) + " bits.");
+  }
+  m_keys.insert(m_keys.end(), other.m_keys.begin(), other.m_keys.end());
+  m_counts.insert(m_counts.end(), other.m_counts.begin(),
+                  other.m_counts.end());
+}
+
+void Histogram::normalize() const {
+  const auto n = m_counts.size();
+  if (m_sorted == n) {
+    return;
+  }
+  auto less = [&](std::size_t a, std::size_t b) {
+    for (std::size_t w = m_words; w-- > 0;) {
+      const auto ka = m_keys[a * m_words + w], kb = m_keys[b * m_words + w];
+      if (ka != kb) {
+        return ka < kb;
+      }
+    }
+    return false;
+  };
+  std::vector<std::size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  // The sorted prefix stays in order, only the appended entries are
+  // sorted before the two runs are merged
+  std::sort(order.begin() + m_sorted, order.end(), less);
+  std::inplace_merge(order.begin(), order.begin() + m_sorted, order.end(),
+                     less);
+
+  std::vector<word_t> keys;
+  std::vector<std::size_t> counts;
+  keys.reserve(m_keys.size());
+  counts.reserve(n);
+  for (std::size_t k = 0; k < n; k++) {
+    const auto e = order[k];
+    if (k > 0 && !less(order[k - 1], e)) {
+      counts.back() += m_counts[e];
+      continue;
+    }
+    keys.insert(keys.end(), m_keys.begin() + e * m_words,
+                m_keys.begin() + (e + 1) * m_words);
+    counts.push_back(m_counts[e]);
+  }
+  keys.shrink_to_fit();
+  counts.shrink_to_fit();
+  m_keys = std::move(keys);
+  m_counts = std::move(counts);
+  m_sorted = m_counts.size();
+}
+
+std::size_t Histogram::size() const {
+  normalize();
+  return m_counts.size();
+}
+
+const Histogram::word_t *Histogram::key(const std::size_t i) const {
+  normalize();
+  return m_keys.data() + i * m_words;
+}
+
+std::size_t Histogram::count(const std::size_t i) const {
+  normalize();
+  return m_counts[i];
+}
+
+bool Histogram::bit(const std::size_t i, const std::size_t m) const {
+  return key(i)[m / bits_per_word] >> (m % bits_per_word) & 1;
+}
+
+std::string Histogram::bitstring(const std::size_t i) const {
+  const auto k = key(i);
+  std::string s(m_bits, '0');
+  for (std::size_t m = 0; m < m_bits; m++) {
+    if (k[m / bits_per_word] >> (m % bits_per_word) & 1) {
+      s[m] = '1';
+    }
+  }
+  return s;
+}
+
+std::size_t Histogram::total() const {
+  return std::accumulate(m_counts.begin(), m_counts.end(), std::size_t(0));
+}
+
+std::size_t Histogram::count_of(const std::string &bitstring) const {
+  Histogram probe(m_bits);
+  probe.add(bitstring);
+  normalize();
+  // Binary search over the sorted entries
+  std::size_t lo = 0, hi = m_counts.size();
+  while (lo < hi) {
+    const auto mid = (lo + hi) / 2;
+    const auto k = m_keys.data() + mid * m_words;
+    int cmp = 0;
+    for (std::size_t w = m_words; w-- > 0 && cmp == 0;) {
+      cmp = k[w] < probe.m_keys[w] ? -1 : k[w] > probe.m_keys[w] ? 1 : 0;
+    }
+    if (cmp == 0) {
+      return m_counts[mid];
+    }
+    if (cmp < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return 0;
+}
+
+double Histogram::expectation_z() const {
+  double sum = 0.0;
+  std::size_t shots = 0;
+  for (std::size_t e = 0; e < m_counts.size(); e++) {
+    int parity = 0;
+    for (std::size_t w = 0; w < m_words; w++) {
+      parity ^= __builtin_parityll(m_keys[e * m_words + w]);
+    }
+    sum += parity ? -double(m_counts[e]) : double(m_counts[e]);
+    shots += m_counts[e];
+  }
+  return shots ? sum / shots : 0.0;
+}
+
+std::map<std::string, int> Histogram::to_map() const {
+  std::map<std::string, int> counts;
+  for (std::size_t i = 0; i < size(); i++) {
+    counts.emplace_hint(counts.end(), bitstring(i), (int)m_counts[i]);
+  }
+  return counts;
+}
+
+Histogram Histogram::from_map(const std::map<std::string, int> &counts) {
+  Histogram h(counts.empty() ? 0 : counts.begin()->first.size());
+  for (auto &[bitstring, count] : counts) {
+    h.add(bitstring, count);
+  }
+  return h;
+}
+
+std::size_t Histogram::memory_bytes() const {
+  return m_keys.capacity() * sizeof(word_t) +
+         m_counts.capacity() * sizeof(std::size_t);
+}
+
+void Histogram::append_to(xacc::AcceleratorBuffer *buffer) const {
+  auto all = packed_counts(buffer);
+  all.merge(*this);
+  if (all.empty()) {
+    return;
+  }
+  all.normalize();
+
+  std::vector<int> data;
+  data.reserve(1 + all.m_counts.size() * (2 * all.m_words + 1));
+  data.push_back(all.m_bits);
+  for (std::size_t e = 0; e < all.m_counts.size(); e++) {
+    for (std::size_t w = 0; w < all.m_words; w++) {
+      const auto word = all.m_keys[e * all.m_words + w];
+      data.push_back(int(std::uint32_t(word)));
+      data.push_back(int(std::uint32_t(word >> 32)));
+    }
+    data.push_back(all.m_counts[e]);
+  }
+  buffer->addExtraInfo(packed_counts_key, data);
+}
+
+Histogram Histogram::from_buffer(xacc::AcceleratorBuffer *buffer) {
+  auto h = from_map(buffer->getMeasurementCounts());
+  h.merge(packed_counts(buffer));
+  return h;
+}
+
+} // namespace qcor
@@ -0,0 +1,90 @@
+#ifndef RUNTIME_QCOR_HISTOGRAM_HPP_
+#define RUNTIME_QCOR_HISTOGRAM_HPP_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace xacc {
+class AcceleratorBuffer;
+}
+
+namespace qcor {
+
+// Histogram is a compact record of measurement outcomes, keyed by the
+// measured bits packed into 64 bit words rather than by bitstrings.
+// Bit m of a key (bit m % 64 of word m / 64) is character m of the
+// outcome's bitstring, i.e. the m-th measured qubit.
+//
+// Entries live in two flat arrays, the keys (n_words() per entry) and
+// their counts, kept sorted by key. Outcomes added since the last read are
+// appended and merged in one sort on the next access, so counting a
+// million shots costs a sort rather than a million tree insertions. An
+// entry takes 8 * n_words() + 8 bytes. The std::map<std::string, int> of
+// xacc::AcceleratorBuffer takes a tree node, a heap allocated string
+// beyond 15 bits and the allocator overhead of both, about 128 bytes for
+// a 25 bit outcome; see memory_bytes().
+//
+// Bitstrings are only built on demand, see bitstring() and to_map().
+class Histogram {
+public:
+  using word_t = std::uint64_t;
+  static constexpr std::size_t bits_per_word = 64;
+
+  Histogram() = default;
+  explicit Histogram(const std::size_t n_bits);
+
+  std::size_t n_bits() const { return m_bits; }
+  std::size_t n_words() const { return m_words; }
+
+  // Count an outcome n_words() words long
+  void add(const word_t *key, const std::size_t count = 1);
+  // Count an outcome of at most 64 bits
+  void add(const word_t key, const std::size_t count = 1);
+  void add(const std::string &bitstring, const std::size_t count = 1);
+  void merge(const Histogram &other);
+
+  // Distinct outcomes, in increasing key order (highest word first)
+  std::size_t size() const;
+  bool empty() const { return m_counts.empty(); }
+  const word_t *key(const std::size_t i) const;
+  std::size_t count(const std::size_t i) const;
+  bool bit(const std::size_t i, const std::size_t m) const;
+  std::string bitstring(const std::size_t i) const;
+  // Number of shots, the sum of all counts
+  std::size_t total() const;
+  // Count of one outcome, 0 if never seen
+  std::size_t count_of(const std::string &bitstring) const;
+  // <Z...Z> over all bits, from the parity of every outcome
+  double expectation_z() const;
+
+  // Legacy views, one string per distinct outcome
+  std::map<std::string, int> to_map() const;
+  static Histogram from_map(const std::map<std::string, int> &counts);
+
+  // Bytes held by the keys and counts
+  std::size_t memory_bytes() const;
+
+  // Add the counts to the buffer as the "packed-counts" information,
+  // merged with any packed counts already there. Buffer bitstring counts
+  // are left alone.
+  void append_to(xacc::AcceleratorBuffer *buffer) const;
+  // The packed counts of the buffer merged with its bitstring counts
+  static Histogram from_buffer(xacc::AcceleratorBuffer *buffer);
+
+private:
+  std::size_t m_bits = 0;
+  std::size_t m_words = 0;
+  // Entries [0, m_sorted) are sorted and distinct
+  mutable std::vector<word_t> m_keys;
+  mutable std::vector<std::size_t> m_counts;
+  mutable std::size_t m_sorted = 0;
+
+  // Sort the appended entries in and merge duplicates
+  void normalize() const;
+};
+
+} // namespace qcor
+
+#endif
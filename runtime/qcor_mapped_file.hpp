@@ -0,0 +1,62 @@
+#ifndef RUNTIME_QCOR_MAPPED_FILE_HPP_
+#define RUNTIME_QCOR_MAPPED_FILE_HPP_
+
+#include "xacc.hpp"
+
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace qcor {
+
+// Read-only memory mapping of a whole file, unmapped on destruction. kind
+// names the file in error messages, e.g. "Hamiltonian file".
+class MappedFile {
+public:
+  MappedFile(const std::string &file_name, const std::string &kind = "file") {
+    fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+      xacc::error("[qcor] Could not open " + kind + " " + file_name);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      xacc::error("[qcor] Could not stat " + kind + " " + file_name);
+    }
+    length = st.st_size;
+    if (length > 0) {
+      auto ptr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr == MAP_FAILED) {
+        xacc::error("[qcor] Could not mmap " + kind + " " + file_name);
+      }
+      // Files are consumed front to back
+      ::madvise(ptr, length, MADV_SEQUENTIAL);
+      data = static_cast<const char *>(ptr);
+    }
+  }
+  ~MappedFile() {
+    if (data) {
+      ::munmap(const_cast<char *>(data), length);
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *begin() const { return data; }
+  const char *end() const { return data + length; }
+  std::size_t size() const { return length; }
+
+private:
+  int fd = -1;
+  const char *data = nullptr;
+  std::size_t length = 0;
+};
+
+} // namespace qcor
+
+#endif
@@ -0,0 +1,507 @@
+#include "qcor_pauli.hpp"
+
+#include "PauliOperator.hpp"
+#include "xacc.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <unordered_map>
+
+namespace qcor {
+namespace {
+
+inline std::size_t popcount(PauliSum::word_t w) {
+  return __builtin_popcountll(w);
+}
+
+inline std::size_t words_for(const std::size_t n_qubits) {
+  return std::max<std::size_t>(
+      1, (n_qubits + PauliSum::bits_per_word - 1) / PauliSum::bits_per_word);
+}
+
+// i^k for k in [0, 4)
+inline std::complex<double> i_pow(const std::uint8_t k) {
+  switch (k & 3) {
+  case 0:
+    return {1.0, 0.0};
+  case 1:
+    return {0.0, 1.0};
+  case 2:
+    return {-1.0, 0.0};
+  default:
+    return {0.0, -1.0};
+  }
+}
+
+inline void hash_combine(std::size_t &seed, PauliSum::word_t w) {
+  seed ^= std::hash<PauliSum::word_t>{}(w) + 0x9e3779b97f4a7c15ULL +
+          (seed << 6) + (seed >> 2);
+}
+
+// Hash of the n mask words of a term
+inline std::size_t hash_masks(const PauliSum::word_t *masks,
+                              const std::size_t n) {
+  std::size_t seed = 0;
+  for (std::size_t k = 0; k < n; k++) {
+    hash_combine(seed, masks[k]);
+  }
+  return seed;
+}
+} // namespace
+
+PauliSum::PauliSum(const std::size_t n_qubits) : words(words_for(n_qubits)) {}
+
+PauliSum::PauliSum(std::complex<double> coeff) {
+  const word_t zero = 0;
+  add_term(coeff, &zero, &zero);
+}
+
+PauliSum PauliSum::X(const int idx) {
+  PauliSum ret(idx + 1);
+  ret.add_term(1.0, {{idx, "X"}});
+  return ret;
+}
+
+PauliSum PauliSum::Y(const int idx) {
+  PauliSum ret(idx + 1);
+  ret.add_term(1.0, {{idx, "Y"}});
+  return ret;
+}
+
+PauliSum PauliSum::Z(const int idx) {
+  PauliSum ret(idx + 1);
+  ret.add_term(1.0, {{idx, "Z"}});
+  return ret;
+}
+
+void PauliSum::reserve(const std::size_t n) {
+  masks.reserve(2 * n * words);
+  phases.reserve(n);
+  coeffs.reserve(n);
+}
+
+void PauliSum::resize_qubits(const std::size_t n_qubits) {
+  const auto new_words = words_for(n_qubits);
+  if (new_words <= words) {
+    return;
+  }
+
+  std::vector<word_t> new_masks(2 * n_terms() * new_words, 0);
+  for (std::size_t t = 0; t < n_terms(); t++) {
+    std::copy(x_mask(t), x_mask(t) + words,
+              new_masks.begin() + 2 * t * new_words);
+    std::copy(z_mask(t), z_mask(t) + words,
+              new_masks.begin() + (2 * t + 1) * new_words);
+  }
+  masks = std::move(new_masks);
+  words = new_words;
+  drop_index();
+}
+
+void PauliSum::add_term(std::complex<double> coeff,
+                        const std::map<int, std::string> &ops) {
+  if (!ops.empty()) {
+    resize_qubits(ops.rbegin()->first + 1);
+  }
+
+  const auto t = n_terms();
+  masks.resize(masks.size() + 2 * words, 0);
+  phases.push_back(0);
+  coeffs.push_back(coeff);
+
+  auto x = x_mask(t);
+  auto z = z_mask(t);
+  for (auto &[idx, pauli] : ops) {
+    if (idx < 0) {
+      xacc::error("[PauliSum] Invalid negative qubit index " +
+                  std::to_string(idx));
+    }
+    const auto word = idx / bits_per_word;
+    const auto bit = word_t(1) << (idx % bits_per_word);
+    if (pauli == "X") {
+      x[word] |= bit;
+    } else if (pauli == "Z") {
+      z[word] |= bit;
+    } else if (pauli == "Y") {
+      x[word] |= bit;
+      z[word] |= bit;
+    } else if (pauli != "I" && !pauli.empty()) {
+      xacc::error("[PauliSum] Invalid Pauli operator '" + pauli + "'");
+    }
+  }
+}
+
+void PauliSum::add_term(std::complex<double> coeff, const word_t *x,
+                        const word_t *z, const std::uint8_t phase) {
+  masks.insert(masks.end(), x, x + words);
+  masks.insert(masks.end(), z, z + words);
+  phases.push_back(phase & 3);
+  coeffs.push_back(coeff);
+}
+
+std::complex<double> PauliSum::coefficient(const std::size_t term) const {
+  return i_pow(phases[term]) * coeffs[term];
+}
+
+char PauliSum::op(const std::size_t term, const int qubit) const {
+  const std::size_t word = qubit / bits_per_word;
+  if (word >= words) {
+    return 'I';
+  }
+  const auto bit = word_t(1) << (qubit % bits_per_word);
+  const bool x = x_mask(term)[word] & bit;
+  const bool z = z_mask(term)[word] & bit;
+  return x ? (z ? 'Y' : 'X') : (z ? 'Z' : 'I');
+}
+
+std::size_t PauliSum::weight(const std::size_t term) const {
+  std::size_t w = 0;
+  auto x = x_mask(term);
+  auto z = z_mask(term);
+  for (std::size_t k = 0; k < words; k++) {
+    w += popcount(x[k] | z[k]);
+  }
+  return w;
+}
+
+bool PauliSum::is_diagonal(const std::size_t term) const {
+  auto x = x_mask(term);
+  return std::all_of(x, x + words, [](word_t w) { return w == 0; });
+}
+
+std::map<int, std::string> PauliSum::ops(const std::size_t term) const {
+  std::map<int, std::string> ret;
+  auto x = x_mask(term);
+  auto z = z_mask(term);
+  for (std::size_t k = 0; k < words; k++) {
+    auto support = x[k] | z[k];
+    while (support) {
+      const auto bit = __builtin_ctzll(support);
+      const int idx = k * bits_per_word + bit;
+      ret.insert({idx, std::string(1, op(term, idx))});
+      support &= support - 1;
+    }
+  }
+  return ret;
+}
+
+bool PauliSum::terms_commute(const std::size_t i, const PauliSum &other,
+                             const std::size_t j) const {
+  // P_i and P_j commute iff the symplectic product |x_i z_j| + |z_i x_j|
+  // is even.
+  const auto n = std::min(words, other.words);
+  auto xi = x_mask(i), zi = z_mask(i);
+  auto xj = other.x_mask(j), zj = other.z_mask(j);
+  std::size_t count = 0;
+  for (std::size_t k = 0; k < n; k++) {
+    count += popcount((xi[k] & zj[k]) ^ (zi[k] & xj[k]));
+  }
+  return (count & 1) == 0;
+}
+
+bool PauliSum::commutes(const PauliSum &other, const double tol) const {
+  // [A, B] = sum_ij a_i b_j [P_i, P_j], and [P_i, P_j] is either 0 or
+  // 2 P_i P_j, so only anti-commuting pairs contribute.
+  PauliSum commutator(std::max(n_qubits(), other.n_qubits()));
+  for (std::size_t i = 0; i < n_terms(); i++) {
+    for (std::size_t j = 0; j < other.n_terms(); j++) {
+      if (!terms_commute(i, other, j)) {
+        commutator.append_product(*this, i, other, j, 2.0);
+      }
+    }
+  }
+  return commutator.simplify(tol).empty();
+}
+
+void PauliSum::append_product(const PauliSum &a, const std::size_t i,
+                              const PauliSum &b, const std::size_t j,
+                              std::complex<double> scale) {
+  // With P(x, z) = i^{|x & z|} X^x Z^z we have
+  //   P(x1, z1) P(x2, z2) = i^k P(x1 ^ x2, z1 ^ z2)
+  //   k = |x1 z1| + |x2 z2| + 2 |z1 x2| - |(x1 ^ x2)(z1 ^ z2)|  (mod 4)
+  const auto t = n_terms();
+  masks.resize(masks.size() + 2 * words, 0);
+  auto x = x_mask(t);
+  auto z = z_mask(t);
+
+  auto x1 = a.x_mask(i), z1 = a.z_mask(i);
+  auto x2 = b.x_mask(j), z2 = b.z_mask(j);
+  std::size_t k = 0;
+  for (std::size_t w = 0; w < words; w++) {
+    const word_t xa = w < a.words ? x1[w] : 0, za = w < a.words ? z1[w] : 0;
+    const word_t xb = w < b.words ? x2[w] : 0, zb = w < b.words ? z2[w] : 0;
+    x[w] = xa ^ xb;
+    z[w] = za ^ zb;
+    k += popcount(xa & za) + popcount(xb & zb) + 2 * popcount(za & xb);
+    k += 4 * bits_per_word - popcount(x[w] & z[w]);
+  }
+
+  phases.push_back((k + a.phases[i] + b.phases[j]) & 3);
+  coeffs.push_back(scale * a.coeffs[i] * b.coeffs[j]);
+}
+
+PauliSum &PauliSum::simplify(const double tol) {
+  const auto stride = 2 * words;
+  std::vector<word_t> new_masks;
+  std::vector<std::complex<double>> new_coeffs;
+  new_masks.reserve(masks.size());
+  new_coeffs.reserve(coeffs.size());
+
+  // Keys are term indices into new_masks, hashed over their mask words
+  auto hasher = [&](const std::size_t t) {
+    return hash_masks(new_masks.data() + t * stride, stride);
+  };
+  auto equal = [&](const std::size_t a, const std::size_t b) {
+    return std::equal(new_masks.begin() + a * stride,
+                      new_masks.begin() + (a + 1) * stride,
+                      new_masks.begin() + b * stride);
+  };
+  std::unordered_map<std::size_t, std::size_t, decltype(hasher),
+                     decltype(equal)>
+      seen(coeffs.size(), hasher, equal);
+
+  for (std::size_t t = 0; t < n_terms(); t++) {
+    const auto candidate = new_coeffs.size();
+    new_masks.insert(new_masks.end(), masks.begin() + t * stride,
+                     masks.begin() + (t + 1) * stride);
+    auto [iter, inserted] = seen.insert({candidate, candidate});
+    if (inserted) {
+      new_coeffs.push_back(coefficient(t));
+    } else {
+      new_coeffs[iter->second] += coefficient(t);
+      new_masks.resize(new_masks.size() - stride);
+    }
+  }
+
+  // Drop vanishing terms
+  masks.clear();
+  coeffs.clear();
+  for (std::size_t t = 0; t < new_coeffs.size(); t++) {
+    if (std::abs(new_coeffs[t]) > tol) {
+      masks.insert(masks.end(), new_masks.begin() + t * stride,
+                   new_masks.begin() + (t + 1) * stride);
+      coeffs.push_back(new_coeffs[t]);
+    }
+  }
+  phases.assign(coeffs.size(), 0);
+  drop_index();
+  return *this;
+}
+
+std::size_t PauliSum::find_term(const word_t *term,
+                                const std::size_t hash) const {
+  const auto stride = 2 * words;
+  auto range = index.equal_range(hash);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (std::equal(term, term + stride,
+                   masks.begin() + iter->second * stride)) {
+      return iter->second;
+    }
+  }
+  return n_terms();
+}
+
+void PauliSum::remove_term(const std::size_t t) {
+  const auto stride = 2 * words;
+  auto unindex = [&](const std::size_t term) {
+    auto range = index.equal_range(hash_masks(x_mask(term), stride));
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (iter->second == term) {
+        index.erase(iter);
+        return;
+      }
+    }
+  };
+  unindex(t);
+
+  const auto last = n_terms() - 1;
+  if (t != last) {
+    unindex(last);
+    std::copy(x_mask(last), x_mask(last) + stride, x_mask(t));
+    phases[t] = phases[last];
+    coeffs[t] = coeffs[last];
+    index.insert({hash_masks(x_mask(t), stride), t});
+  }
+  masks.resize(masks.size() - stride);
+  phases.pop_back();
+  coeffs.pop_back();
+}
+
+PauliSum &PauliSum::append(const PauliSum &other) {
+  if (&other == this) {
+    return append(PauliSum(other));
+  }
+
+  resize_qubits(other.n_qubits());
+  if (other.words == words) {
+    masks.insert(masks.end(), other.masks.begin(), other.masks.end());
+    phases.insert(phases.end(), other.phases.begin(), other.phases.end());
+    coeffs.insert(coeffs.end(), other.coeffs.begin(), other.coeffs.end());
+    return *this;
+  }
+
+  reserve(n_terms() + other.n_terms());
+  std::vector<word_t> x(words, 0), z(words, 0);
+  for (std::size_t t = 0; t < other.n_terms(); t++) {
+    std::copy(other.x_mask(t), other.x_mask(t) + other.words, x.begin());
+    std::copy(other.z_mask(t), other.z_mask(t) + other.words, z.begin());
+    add_term(other.coeffs[t], x.data(), z.data(), other.phases[t]);
+  }
+  return *this;
+}
+
+PauliSum &PauliSum::operator+=(const PauliSum &other) {
+  if (&other == this) {
+    return operator+=(PauliSum(other));
+  }
+
+  resize_qubits(other.n_qubits());
+  const auto stride = 2 * words;
+  if (index.size() != n_terms()) {
+    // Merge the terms added otherwise since, then index them all
+    simplify();
+    index.reserve(n_terms());
+    for (std::size_t t = 0; t < n_terms(); t++) {
+      index.insert({hash_masks(x_mask(t), stride), t});
+    }
+  }
+
+  std::vector<word_t> term(stride, 0);
+  std::vector<std::size_t> touched;
+  touched.reserve(other.n_terms());
+  for (std::size_t t = 0; t < other.n_terms(); t++) {
+    std::copy(other.x_mask(t), other.x_mask(t) + other.words, term.begin());
+    std::copy(other.z_mask(t), other.z_mask(t) + other.words,
+              term.begin() + words);
+    const auto hash = hash_masks(term.data(), stride);
+    const auto i = find_term(term.data(), hash);
+    if (i == n_terms()) {
+      masks.insert(masks.end(), term.begin(), term.end());
+      phases.push_back(0);
+      coeffs.push_back(other.coefficient(t));
+      index.insert({hash, i});
+    } else {
+      coeffs[i] = coefficient(i) + other.coefficient(t);
+      phases[i] = 0;
+    }
+    touched.push_back(i);
+  }
+
+  // Drop the terms that vanish, the last first so that the terms moved
+  // into their places have been looked at already
+  std::sort(touched.begin(), touched.end(), std::greater<std::size_t>());
+  touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+  for (auto t : touched) {
+    if (std::abs(coeffs[t]) <= 1e-12) {
+      remove_term(t);
+    }
+  }
+  return *this;
+}
+
+PauliSum &PauliSum::operator-=(const PauliSum &other) {
+  return operator+=(-other);
+}
+
+PauliSum &PauliSum::operator*=(const PauliSum &other) {
+  PauliSum product(std::max(n_qubits(), other.n_qubits()));
+  product.reserve(n_terms() * other.n_terms());
+  for (std::size_t i = 0; i < n_terms(); i++) {
+    for (std::size_t j = 0; j < other.n_terms(); j++) {
+      product.append_product(*this, i, other, j);
+    }
+  }
+  *this = std::move(product.simplify());
+  return *this;
+}
+
+PauliSum &PauliSum::operator*=(std::complex<double> scalar) {
+  for (auto &c : coeffs) {
+    c *= scalar;
+  }
+  return *this;
+}
+
+PauliSum PauliSum::operator+(const PauliSum &other) const {
+  PauliSum ret(*this);
+  ret += other;
+  return ret;
+}
+
+PauliSum PauliSum::operator-(const PauliSum &other) const {
+  PauliSum ret(*this);
+  ret -= other;
+  return ret;
+}
+
+PauliSum PauliSum::operator*(const PauliSum &other) const {
+  PauliSum ret(*this);
+  ret *= other;
+  return ret;
+}
+
+PauliSum PauliSum::operator*(std::complex<double> scalar) const {
+  PauliSum ret(*this);
+  ret *= scalar;
+  return ret;
+}
+
+PauliSum PauliSum::operator-() const { return *this * -1.0; }
+
+PauliSum operator*(std::complex<double> scalar, const PauliSum &op) {
+  return op * scalar;
+}
+
+PauliSum PauliSum::from_pauli_operator(xacc::quantum::PauliOperator &op) {
+  auto terms = op.getTerms();
+
+  // Size the masks once up front
+  int max_idx = 0;
+  for (auto &[id, term] : terms) {
+    auto &term_ops = std::get<2>(term);
+    if (!term_ops.empty()) {
+      max_idx = std::max(max_idx, term_ops.rbegin()->first);
+    }
+  }
+
+  PauliSum ret(max_idx + 1);
+  ret.reserve(terms.size());
+  for (auto &[id, term] : terms) {
+    if (!std::get<1>(term).empty()) {
+      xacc::error("[PauliSum] Cannot convert term " + id +
+                  " with symbolic coefficient " + std::get<1>(term));
+    }
+    ret.add_term(std::get<0>(term), std::get<2>(term));
+  }
+  return ret;
+}
+
+xacc::quantum::PauliOperator PauliSum::to_pauli_operator() const {
+  xacc::quantum::PauliOperator ret;
+  for (std::size_t t = 0; t < n_terms(); t++) {
+    auto term_ops = ops(t);
+    if (term_ops.empty()) {
+      ret += xacc::quantum::PauliOperator(coefficient(t));
+    } else {
+      ret += xacc::quantum::PauliOperator(term_ops, coefficient(t));
+    }
+  }
+  return ret;
+}
+
+std::string PauliSum::to_string() const {
+  std::stringstream ss;
+  for (std::size_t t = 0; t < n_terms(); t++) {
+    if (t > 0) {
+      ss << " + ";
+    }
+    ss << coefficient(t);
+    for (auto &[idx, pauli] : ops(t)) {
+      ss << " " << pauli << idx;
+    }
+  }
+  return ss.str();
+}
+
+} // namespace qcor
@@ -0,0 +1,162 @@
+#ifndef RUNTIME_QCOR_PAULI_HPP_
+#define RUNTIME_QCOR_PAULI_HPP_
+
+#include <complex>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+class PauliOperator;
+}
+} // namespace xacc
+
+namespace qcor {
+
+// PauliSum is a compact, bitmask-based representation of a sum of
+// weighted Pauli strings, meant for building and manipulating large
+// Hamiltonians without the string-keyed maps of xacc::quantum::PauliOperator.
+//
+// Each term is stored in symplectic form as an X mask and a Z mask
+// (one bit per qubit, packed into 64 bit words), a phase exponent k
+// (the term carries an extra factor of i^k), and a complex coefficient.
+// On qubit q the term acts as
+//   I if x_q = 0, z_q = 0
+//   X if x_q = 1, z_q = 0
+//   Z if x_q = 0, z_q = 1
+//   Y if x_q = 1, z_q = 1
+// All masks live in one flat array (term t owns words
+// [2 * t * n_words(), 2 * (t + 1) * n_words()), X words first), so
+// products and commutation checks reduce to word-wise xor/and/popcount.
+//
+// Conversion to and from PauliOperator happens only at the boundary,
+// see from_pauli_operator() and to_pauli_operator().
+class PauliSum {
+public:
+  using word_t = std::uint64_t;
+  static constexpr std::size_t bits_per_word = 64;
+
+  PauliSum() = default;
+  // Create an empty sum wide enough to address n_qubits without re-layout
+  explicit PauliSum(const std::size_t n_qubits);
+  // Create the scalar sum coeff * I
+  PauliSum(std::complex<double> coeff);
+
+  // Single-qubit constructors, mirroring qcor::X/Y/Z
+  static PauliSum X(const int idx);
+  static PauliSum Y(const int idx);
+  static PauliSum Z(const int idx);
+
+  std::size_t n_terms() const { return coeffs.size(); }
+  std::size_t n_words() const { return words; }
+  std::size_t n_qubits() const { return words * bits_per_word; }
+  bool empty() const { return coeffs.empty(); }
+
+  // Reserve storage for n terms
+  void reserve(const std::size_t n);
+  // Widen the masks so that qubit indices < n_qubits can be stored
+  void resize_qubits(const std::size_t n_qubits);
+
+  // Append a term given as {qubit index -> "X"/"Y"/"Z"/"I"}
+  void add_term(std::complex<double> coeff,
+                const std::map<int, std::string> &ops);
+  // Append a term given by its raw masks (n_words() words each)
+  void add_term(std::complex<double> coeff, const word_t *x, const word_t *z,
+                const std::uint8_t phase = 0);
+
+  // Concatenate the terms of other to this sum without simplifying
+  PauliSum &append(const PauliSum &other);
+
+  // Raw access to the masks of a term
+  const word_t *x_mask(const std::size_t term) const {
+    return masks.data() + 2 * term * words;
+  }
+  const word_t *z_mask(const std::size_t term) const {
+    return masks.data() + (2 * term + 1) * words;
+  }
+
+  // The full coefficient of a term, i^phase * coeff
+  std::complex<double> coefficient(const std::size_t term) const;
+  // The operator on a qubit of a term: 'I', 'X', 'Y' or 'Z'
+  char op(const std::size_t term, const int qubit) const;
+  // Number of non-identity factors of a term
+  std::size_t weight(const std::size_t term) const;
+  // True if the term only contains I and Z factors
+  bool is_diagonal(const std::size_t term) const;
+  // {qubit index -> "X"/"Y"/"Z"} map of a term, as used by xacc Terms
+  std::map<int, std::string> ops(const std::size_t term) const;
+
+  // True if term i of this sum commutes with term j of other
+  bool terms_commute(const std::size_t i, const PauliSum &other,
+                     const std::size_t j) const;
+  // True if the operators commute, i.e. the commutator [*this, other]
+  // simplifies to zero (up to tol)
+  bool commutes(const PauliSum &other, const double tol = 1e-12) const;
+
+  // Merge terms with identical masks (hash-combined over the mask words),
+  // fold phases into coefficients and drop terms with |coeff| <= tol.
+  PauliSum &simplify(const double tol = 1e-12);
+
+  // Adds the terms of other into their matching terms, dropping the ones
+  // that cancel. Only the first += simplifies the whole sum, the term
+  // index it builds is kept, so building a sum term by term is linear.
+  // Cancelled terms are replaced by the last term, changing the order.
+  PauliSum &operator+=(const PauliSum &other);
+  PauliSum &operator-=(const PauliSum &other);
+  PauliSum &operator*=(const PauliSum &other);
+  PauliSum &operator*=(std::complex<double> scalar);
+
+  PauliSum operator+(const PauliSum &other) const;
+  PauliSum operator-(const PauliSum &other) const;
+  PauliSum operator*(const PauliSum &other) const;
+  PauliSum operator*(std::complex<double> scalar) const;
+  PauliSum operator-() const;
+
+  // Boundary conversions
+  static PauliSum from_pauli_operator(xacc::quantum::PauliOperator &op);
+  xacc::quantum::PauliOperator to_pauli_operator() const;
+
+  std::string to_string() const;
+
+protected:
+  std::size_t words = 1;
+  std::vector<word_t> masks;
+  std::vector<std::uint8_t> phases;
+  std::vector<std::complex<double>> coeffs;
+  // Hash of the masks -> term, for operator+=. Out of date unless it has
+  // one entry per term.
+  std::unordered_multimap<std::size_t, std::size_t> index;
+
+  word_t *x_mask(const std::size_t term) {
+    return masks.data() + 2 * term * words;
+  }
+  word_t *z_mask(const std::size_t term) {
+    return masks.data() + (2 * term + 1) * words;
+  }
+
+  // Write the product of term i of a and term j of b to the back of this sum
+  void append_product(const PauliSum &a, const std::size_t i,
+                      const PauliSum &b, const std::size_t j,
+                      std::complex<double> scale = 1.0);
+
+  // Called when existing terms move. Appended terms leave the index out
+  // of date by themselves.
+  void drop_index() {
+    if (!index.empty()) {
+      index.clear();
+    }
+  }
+  // The term with the given masks (2 * n_words() words), or n_terms()
+  std::size_t find_term(const word_t *term, const std::size_t hash) const;
+  // Remove a term, moving the last one into its place
+  void remove_term(const std::size_t t);
+};
+
+PauliSum operator*(std::complex<double> scalar, const PauliSum &op);
+
+} // namespace qcor
+
+#endif
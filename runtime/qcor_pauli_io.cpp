@@ -0,0 +1,379 @@
+#include "qcor_pauli_io.hpp"
+#include "qcor_mapped_file.hpp"
+
+#include "xacc.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <thread>
+
+#include <sys/resource.h>
+
+namespace qcor {
+namespace {
+
+constexpr char binary_magic[8] = {'Q', 'C', 'O', 'R', 'P', 'S', 'U', 'M'};
+constexpr std::uint32_t binary_version = 1;
+
+struct BinaryHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t n_words;
+  std::uint64_t n_terms;
+};
+static_assert(sizeof(BinaryHeader) == 24, "unexpected BinaryHeader padding");
+
+long peak_rss_kb() {
+  struct rusage usage;
+  ::getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  // bytes on macOS
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+inline bool is_space(const char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+inline bool is_digit(const char c) { return c >= '0' && c <= '9'; }
+
+// Parses the text Pauli syntax over [p, end), one term at a time
+class TextChunkParser {
+public:
+  TextChunkParser(const char *begin, const char *end) : p(begin), e(end) {}
+
+  void parse(PauliSum &out) {
+    std::vector<PauliSum::word_t> x(out.n_words(), 0), z(out.n_words(), 0);
+    while (true) {
+      skip_space();
+      if (p == e) {
+        return;
+      }
+
+      double sign = 1.0;
+      if (*p == '+' || *p == '-') {
+        sign = *p == '-' ? -1.0 : 1.0;
+        p++;
+        skip_space();
+      }
+
+      bool has_coeff = false;
+      std::complex<double> coeff = 1.0;
+      if (p != e && *p == '(') {
+        p++;
+        const auto re = read_number();
+        skip_space();
+        expect(',');
+        const auto im = read_number();
+        skip_space();
+        expect(')');
+        coeff = {re, im};
+        has_coeff = true;
+      } else if (p != e && (is_digit(*p) || *p == '.')) {
+        coeff = read_number();
+        has_coeff = true;
+      }
+      skip_space();
+      if (p != e && *p == '*') {
+        p++;
+        skip_space();
+      }
+
+      std::fill(x.begin(), x.end(), 0);
+      std::fill(z.begin(), z.end(), 0);
+      bool has_ops = false;
+      while (p != e && (*p == 'X' || *p == 'Y' || *p == 'Z' || *p == 'I')) {
+        const auto pauli = *p++;
+        has_ops = true;
+        if (p == e || !is_digit(*p)) {
+          // bare identity
+          if (pauli != 'I') {
+            error("missing qubit index");
+          }
+          skip_space();
+          continue;
+        }
+        std::size_t idx = 0;
+        while (p != e && is_digit(*p)) {
+          idx = 10 * idx + (*p++ - '0');
+        }
+        skip_space();
+        if (pauli == 'I') {
+          continue;
+        }
+
+        if (idx >= out.n_qubits()) {
+          out.resize_qubits(idx + 1);
+          x.resize(out.n_words(), 0);
+          z.resize(out.n_words(), 0);
+        }
+        const auto bit = PauliSum::word_t(1) << (idx % PauliSum::bits_per_word);
+        if (pauli != 'Z') {
+          x[idx / PauliSum::bits_per_word] |= bit;
+        }
+        if (pauli != 'X') {
+          z[idx / PauliSum::bits_per_word] |= bit;
+        }
+      }
+
+      if (!has_coeff && !has_ops) {
+        if (p == e) {
+          error("unexpected end of input");
+        }
+        error(std::string("unexpected character '") + *p + "'");
+      }
+      out.add_term(sign * coeff, x.data(), z.data());
+    }
+  }
+
+private:
+  const char *p;
+  const char *e;
+
+  void skip_space() {
+    while (p != e && is_space(*p)) {
+      p++;
+    }
+  }
+
+  void expect(const char c) {
+    if (p == e || *p != c) {
+      error(std::string("expected '") + c + "'");
+    }
+    p++;
+  }
+
+  double read_number() {
+    skip_space();
+    // Copy the literal out, the mapped buffer is not null terminated
+    char buffer[64];
+    std::size_t n = 0;
+    while (p != e && n < sizeof(buffer) - 1) {
+      const auto c = *p;
+      const bool exponent_sign =
+          (c == '+' || c == '-') &&
+          (n == 0 || buffer[n - 1] == 'e' || buffer[n - 1] == 'E');
+      if (!(is_digit(c) || c == '.' || c == 'e' || c == 'E' ||
+            exponent_sign)) {
+        break;
+      }
+      buffer[n++] = c;
+      p++;
+    }
+    buffer[n] = '\0';
+    char *parsed_end = nullptr;
+    const auto value = std::strtod(buffer, &parsed_end);
+    if (n == 0 || parsed_end != buffer + n) {
+      error("invalid number '" + std::string(buffer) + "'");
+    }
+    return value;
+  }
+
+  void error(const std::string &msg) {
+    xacc::error("[qcor] Invalid Hamiltonian text, " + msg + " near '" +
+                std::string(p, std::min<std::size_t>(e - p, 32)) + "'");
+  }
+};
+
+// Move p forward to the next '+' or '-' that starts a term, i.e. one that
+// follows whitespace and is not inside a complex literal '(re, im)'.
+const char *next_term_boundary(const char *p, const char *end) {
+  for (; p < end; p++) {
+    if ((*p != '+' && *p != '-') || !is_space(*(p - 1))) {
+      continue;
+    }
+    auto q = p + 1;
+    while (q < end && *q != '(' && *q != ')') {
+      q++;
+    }
+    if (q == end || *q == '(') {
+      return p;
+    }
+  }
+  return end;
+}
+
+std::vector<PauliSum>
+parse_chunks(const std::vector<std::function<void(PauliSum &)>> &tasks) {
+  std::vector<std::future<PauliSum>> futures;
+  for (auto &task : tasks) {
+    futures.push_back(std::async(std::launch::async, [&task]() {
+      PauliSum partial;
+      task(partial);
+      return partial;
+    }));
+  }
+  std::vector<PauliSum> partials;
+  for (auto &f : futures) {
+    partials.push_back(f.get());
+  }
+  return partials;
+}
+
+} // namespace
+
+PauliSum load_pauli_sum(const std::string &file_name, int n_threads,
+                        PauliLoadStats *stats) {
+  const auto start = std::chrono::high_resolution_clock::now();
+  if (n_threads <= 0) {
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  MappedFile file(file_name, "Hamiltonian file");
+  PauliLoadStats local_stats;
+  local_stats.file_bytes = file.size();
+
+  std::vector<std::function<void(PauliSum &)>> tasks;
+  const bool binary =
+      file.size() >= sizeof(BinaryHeader) &&
+      std::memcmp(file.begin(), binary_magic, sizeof(binary_magic)) == 0;
+
+  if (binary) {
+    BinaryHeader header;
+    std::memcpy(&header, file.begin(), sizeof(header));
+    if (header.version != binary_version) {
+      xacc::error("[qcor] Unsupported binary Hamiltonian version " +
+                  std::to_string(header.version));
+    }
+    const std::size_t n_words = header.n_words;
+    if (n_words == 0) {
+      xacc::error("[qcor] Binary Hamiltonian file " + file_name +
+                  " has no mask words");
+    }
+    const std::size_t record_bytes =
+        2 * sizeof(double) + 2 * n_words * sizeof(PauliSum::word_t);
+    // Divided rather than multiplied, so a corrupt count cannot wrap
+    const std::size_t data_bytes = file.size() - sizeof(header);
+    if (header.n_terms > data_bytes / record_bytes ||
+        data_bytes != header.n_terms * record_bytes) {
+      xacc::error("[qcor] Truncated binary Hamiltonian file " + file_name);
+    }
+
+    // Fixed size records, so chunks are plain index ranges
+    const std::size_t n_terms = header.n_terms;
+    const std::size_t n_chunks =
+        std::max<std::size_t>(1, std::min<std::size_t>(n_threads, n_terms));
+    const auto records = file.begin() + sizeof(header);
+    for (std::size_t c = 0; c < n_chunks; c++) {
+      const auto first = c * n_terms / n_chunks;
+      const auto last = (c + 1) * n_terms / n_chunks;
+      tasks.push_back([=](PauliSum &out) {
+        out.resize_qubits(n_words * PauliSum::bits_per_word);
+        out.reserve(last - first);
+        std::vector<PauliSum::word_t> masks(2 * n_words);
+        for (auto t = first; t < last; t++) {
+          const auto record = records + t * record_bytes;
+          double re, im;
+          std::memcpy(&re, record, sizeof(double));
+          std::memcpy(&im, record + sizeof(double), sizeof(double));
+          std::memcpy(masks.data(), record + 2 * sizeof(double),
+                      2 * n_words * sizeof(PauliSum::word_t));
+          out.add_term({re, im}, masks.data(), masks.data() + n_words);
+        }
+      });
+    }
+  } else {
+    // Split into roughly equal byte ranges, snapped to term boundaries
+    std::vector<const char *> bounds{file.begin()};
+    for (int c = 1; c < n_threads; c++) {
+      auto target = file.begin() + c * file.size() / n_threads;
+      target = std::max(target, bounds.back() + 1);
+      if (target >= file.end()) {
+        break;
+      }
+      auto b = next_term_boundary(target, file.end());
+      if (b == file.end()) {
+        break;
+      }
+      bounds.push_back(b);
+    }
+    bounds.push_back(file.end());
+
+    for (std::size_t c = 0; c + 1 < bounds.size(); c++) {
+      const auto first = bounds[c], last = bounds[c + 1];
+      tasks.push_back([=](PauliSum &out) {
+        // Guess ~32 bytes per term to avoid regrowing
+        out.reserve((last - first) / 32);
+        TextChunkParser(first, last).parse(out);
+      });
+    }
+  }
+
+  auto partials = parse_chunks(tasks);
+  PauliSum ret;
+  std::size_t total = 0, max_qubits = 0;
+  for (auto &partial : partials) {
+    total += partial.n_terms();
+    max_qubits = std::max(max_qubits, partial.n_qubits());
+  }
+  ret.resize_qubits(max_qubits);
+  ret.reserve(total);
+  for (auto &partial : partials) {
+    ret.append(partial);
+    partial = PauliSum();
+  }
+
+  const auto stop = std::chrono::high_resolution_clock::now();
+  local_stats.n_terms = ret.n_terms();
+  local_stats.n_chunks = tasks.size();
+  local_stats.n_threads = n_threads;
+  local_stats.binary = binary;
+  local_stats.load_seconds = std::chrono::duration<double>(stop - start).count();
+  local_stats.peak_rss_kb = peak_rss_kb();
+  xacc::info("[qcor] Loaded " + std::to_string(local_stats.n_terms) +
+             " terms from " + file_name + " (" +
+             std::to_string(local_stats.file_bytes) + " bytes, " +
+             std::to_string(local_stats.n_chunks) + " chunks) in " +
+             std::to_string(local_stats.load_seconds) + " s, peak RSS " +
+             std::to_string(local_stats.peak_rss_kb) + " kB");
+  if (stats) {
+    *stats = local_stats;
+  }
+  return ret;
+}
+
+void save_pauli_sum(const PauliSum &sum, const std::string &file_name,
+                    const bool binary) {
+  std::ofstream out(file_name, binary ? std::ios::binary : std::ios::out);
+  if (!out) {
+    xacc::error("[qcor] Could not open " + file_name + " for writing");
+  }
+
+  if (binary) {
+    BinaryHeader header;
+    std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+    header.version = binary_version;
+    header.n_words = sum.n_words();
+    header.n_terms = sum.n_terms();
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (std::size_t t = 0; t < sum.n_terms(); t++) {
+      const auto c = sum.coefficient(t);
+      const double re = std::real(c), im = std::imag(c);
+      out.write(reinterpret_cast<const char *>(&re), sizeof(double));
+      out.write(reinterpret_cast<const char *>(&im), sizeof(double));
+      out.write(reinterpret_cast<const char *>(sum.x_mask(t)),
+                sum.n_words() * sizeof(PauliSum::word_t));
+      out.write(reinterpret_cast<const char *>(sum.z_mask(t)),
+                sum.n_words() * sizeof(PauliSum::word_t));
+    }
+    return;
+  }
+
+  out << std::setprecision(17);
+  for (std::size_t t = 0; t < sum.n_terms(); t++) {
+    const auto c = sum.coefficient(t);
+    out << "+ (" << std::real(c) << ", " << std::imag(c) << ")";
+    for (auto &[idx, pauli] : sum.ops(t)) {
+      out << " " << pauli << idx;
+    }
+    out << "\n";
+  }
+}
+
+} // namespace qcor
@@ -0,0 +1,47 @@
+#ifndef RUNTIME_QCOR_PAULI_IO_HPP_
+#define RUNTIME_QCOR_PAULI_IO_HPP_
+
+#include "qcor_pauli.hpp"
+
+namespace qcor {
+
+// Statistics gathered by load_pauli_sum
+struct PauliLoadStats {
+  std::size_t file_bytes = 0;
+  std::size_t n_terms = 0;
+  std::size_t n_chunks = 0;
+  int n_threads = 1;
+  bool binary = false;
+  double load_seconds = 0.0;
+  // Peak resident set size of the process after loading, in kB
+  long peak_rss_kb = 0;
+};
+
+// Load a Hamiltonian from file into the bitmask PauliSum representation.
+//
+// Two formats are understood:
+//  - text, in the same syntax accepted by createObservable, e.g.
+//      5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + (0.5, -0.1) Z0 Z1
+//    terms may span any number of lines.
+//  - the compact binary format written by save_pauli_sum(..., true),
+//    detected by its leading magic bytes.
+//
+// The file is memory-mapped and split into n_threads chunks on term
+// boundaries, which are parsed concurrently and concatenated in order.
+// n_threads <= 0 uses std::thread::hardware_concurrency(). Load time and
+// peak memory are reported with xacc::info and written to stats if given.
+PauliSum load_pauli_sum(const std::string &file_name, int n_threads = 0,
+                        PauliLoadStats *stats = nullptr);
+
+// Write a PauliSum to file, either in the text syntax above or in the
+// binary format:
+//   header : char[8] magic "QCORPSUM", uint32 version, uint32 n_words,
+//            uint64 n_terms
+//   terms  : n_terms records of double re, double im,
+//            uint64 x[n_words], uint64 z[n_words]
+void save_pauli_sum(const PauliSum &sum, const std::string &file_name,
+                    const bool binary = false);
+
+} // namespace qcor
+
+#endif
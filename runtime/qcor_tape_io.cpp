@@ -0,0 +1,691 @@
+#include "qcor_tape_io.hpp"
+#include "qcor_mapped_file.hpp"
+
+#include "xacc.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+namespace qcor {
+namespace {
+using quantum::GateOp;
+using quantum::GateTape;
+using quantum::TapeGate;
+
+// Records are buffered and written this many at a time
+const std::size_t pending_records = 4096;
+
+// Opcodes and their qelib1.inc names
+const std::vector<std::pair<GateOp, std::string>> &qasm_names() {
+  static const std::vector<std::pair<GateOp, std::string>> names{
+      {GateOp::I, "id"},         {GateOp::H, "h"},
+      {GateOp::X, "x"},          {GateOp::Y, "y"},
+      {GateOp::Z, "z"},          {GateOp::S, "s"},
+      {GateOp::Sdg, "sdg"},      {GateOp::T, "t"},
+      {GateOp::Tdg, "tdg"},      {GateOp::Rx, "rx"},
+      {GateOp::Ry, "ry"},        {GateOp::Rz, "rz"},
+      {GateOp::U1, "u1"},        {GateOp::U, "u3"},
+      {GateOp::Measure, "measure"}, {GateOp::CNOT, "cx"},
+      {GateOp::CY, "cy"},        {GateOp::CZ, "cz"},
+      {GateOp::CH, "ch"},        {GateOp::Swap, "swap"},
+      {GateOp::CPhase, "cu1"},   {GateOp::CRZ, "crz"}};
+  return names;
+}
+
+const std::string &qasm_name(const GateOp op) {
+  return qasm_names()[static_cast<std::size_t>(op)].second;
+}
+
+bool qasm_op(const std::string &name, GateOp &op) {
+  static const std::map<std::string, GateOp> by_name = []() {
+    std::map<std::string, GateOp> m;
+    for (auto &[op, name] : qasm_names()) {
+      m.insert({name, op});
+    }
+    // Other spellings of the same gates
+    m.insert({"u", GateOp::U});
+    m.insert({"U", GateOp::U});
+    m.insert({"CX", GateOp::CNOT});
+    m.insert({"p", GateOp::U1});
+    m.insert({"cp", GateOp::CPhase});
+    return m;
+  }();
+  auto iter = by_name.find(name);
+  if (iter == by_name.end()) {
+    return false;
+  }
+  op = iter->second;
+  return true;
+}
+
+void pad_to_8(std::ostream &out, const std::streamoff base) {
+  static const char zeros[8] = {};
+  const auto pos = static_cast<std::size_t>(out.tellp() - base);
+  out.write(zeros, (8 - pos % 8) % 8);
+}
+
+std::string trim(const std::string &s) {
+  const auto first = s.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) {
+    return "";
+  }
+  return s.substr(first, s.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+// Splits s on the commas that are not inside parentheses
+std::vector<std::string> split_arguments(const std::string &s) {
+  std::vector<std::string> parts;
+  int depth = 0;
+  std::string part;
+  for (auto c : s) {
+    depth += c == '(' ? 1 : c == ')' ? -1 : 0;
+    if (c == ',' && depth == 0) {
+      parts.push_back(trim(part));
+      part.clear();
+    } else {
+      part += c;
+    }
+  }
+  if (!trim(part).empty() || !parts.empty()) {
+    parts.push_back(trim(part));
+  }
+  return parts;
+}
+
+// Recursive descent evaluation of OpenQASM gate arguments:
+//   expr   := term (('+' | '-') term)*
+//   term   := factor (('*' | '/') factor)*
+//   factor := ('+' | '-') factor | '(' expr ')' | number | 'pi'
+class Expression {
+public:
+  Expression(const std::string &text) : s(text) {}
+
+  double evaluate() {
+    const auto value = expr();
+    skip_spaces();
+    if (pos != s.size()) {
+      fail();
+    }
+    return value;
+  }
+
+private:
+  const std::string &s;
+  std::size_t pos = 0;
+
+  void fail() {
+    xacc::error("[qcor] Cannot evaluate OpenQASM expression " + s);
+  }
+  void skip_spaces() {
+    while (pos < s.size() && std::isspace(s[pos])) {
+      pos++;
+    }
+  }
+  bool accept(const char c) {
+    skip_spaces();
+    if (pos < s.size() && s[pos] == c) {
+      pos++;
+      return true;
+    }
+    return false;
+  }
+  double expr() {
+    auto value = term();
+    while (true) {
+      if (accept('+')) {
+        value += term();
+      } else if (accept('-')) {
+        value -= term();
+      } else {
+        return value;
+      }
+    }
+  }
+  double term() {
+    auto value = factor();
+    while (true) {
+      if (accept('*')) {
+        value *= factor();
+      } else if (accept('/')) {
+        value /= factor();
+      } else {
+        return value;
+      }
+    }
+  }
+  double factor() {
+    if (accept('-')) {
+      return -factor();
+    }
+    if (accept('+')) {
+      return factor();
+    }
+    if (accept('(')) {
+      const auto value = expr();
+      if (!accept(')')) {
+        fail();
+      }
+      return value;
+    }
+    skip_spaces();
+    if (s.compare(pos, 2, "pi") == 0) {
+      pos += 2;
+      return M_PI;
+    }
+    const char *begin = s.c_str() + pos;
+    char *end = nullptr;
+    const auto value = std::strtod(begin, &end);
+    if (end == begin) {
+      fail();
+    }
+    pos += end - begin;
+    return value;
+  }
+};
+} // namespace
+
+bool TapeWriter::ParamKey::operator==(const ParamKey &other) const {
+  return n == other.n && std::equal(bits, bits + n, other.bits);
+}
+
+std::size_t TapeWriter::ParamKeyHash::operator()(const ParamKey &key) const {
+  std::size_t h = key.n;
+  for (int p = 0; p < key.n; p++) {
+    h ^= std::hash<std::uint64_t>()(key.bits[p]) + 0x9e3779b97f4a7c15ULL +
+         (h << 6) + (h >> 2);
+  }
+  return h;
+}
+
+TapeWriter::TapeWriter(const std::string &file_name)
+    : m_file_name(file_name), m_file(file_name, std::ios::binary),
+      m_out(&m_file) {
+  if (!m_file) {
+    xacc::error("[qcor] Could not open " + file_name + " for writing");
+  }
+  // Zeroed until close(), so an unfinished file is not mistaken for a tape
+  const TapeFileHeader header{};
+  m_out->write(reinterpret_cast<const char *>(&header), sizeof(header));
+  m_pending.reserve(pending_records);
+}
+
+TapeWriter::TapeWriter(std::ostream &out)
+    : m_file_name("tape stream"), m_out(&out), m_base(out.tellp()) {
+  const TapeFileHeader header{};
+  m_out->write(reinterpret_cast<const char *>(&header), sizeof(header));
+  m_pending.reserve(pending_records);
+}
+
+TapeWriter::~TapeWriter() { close(); }
+
+std::uint16_t TapeWriter::register_id(const std::string &name) {
+  auto iter = m_register_ids.find(name);
+  if (iter != m_register_ids.end()) {
+    return iter->second;
+  }
+  if (m_registers.size() > std::numeric_limits<std::uint16_t>::max()) {
+    xacc::error("[qcor] Too many registers for tape file " + m_file_name);
+  }
+  m_registers.push_back(name);
+  return m_register_ids[name] = m_registers.size() - 1;
+}
+
+void TapeWriter::add(const TapeGate &gate,
+                     const std::vector<std::string> &registers,
+                     const std::vector<std::string> &symbols) {
+  const auto n_qubits = quantum::gate_n_qubits(gate.op);
+  const auto n_params = quantum::gate_n_params(gate.op);
+  TapeRecord record{gate.op, 0, {0, 0}, 0, {gate.bit[0], 0}, 0};
+  for (int q = 0; q < n_qubits; q++) {
+    record.reg[q] = register_id(registers.at(gate.reg[q]));
+  }
+  if (n_qubits == 2) {
+    record.bit[1] = gate.bit[1];
+  }
+
+  if (m_params.size() + n_params > std::numeric_limits<std::uint32_t>::max()) {
+    xacc::error("[qcor] Too many parameters for tape file " + m_file_name);
+  }
+  bool symbolic = false;
+  for (int p = 0; p < n_params && p < symbols.size(); p++) {
+    symbolic |= !symbols[p].empty();
+  }
+  if (symbolic) {
+    // Slots are bound per gate, so symbolic tuples get their own entries
+    record.flags = tape_symbolic;
+    record.param = m_params.size();
+    m_params.insert(m_params.end(), gate.params, gate.params + n_params);
+    for (int p = 0; p < n_params && p < symbols.size(); p++) {
+      if (symbols[p].empty()) {
+        continue;
+      }
+      auto iter = m_symbol_ids.find(symbols[p]);
+      if (iter == m_symbol_ids.end()) {
+        m_symbols.push_back(symbols[p]);
+        iter = m_symbol_ids.insert({symbols[p], m_symbols.size() - 1}).first;
+      }
+      m_slots.push_back({std::uint32_t(record.param + p), iter->second});
+    }
+  } else if (n_params > 0) {
+    // Compare bit patterns, so -0.0 and NaN round trip exactly
+    ParamKey key{n_params, {0, 0, 0}};
+    std::memcpy(key.bits, gate.params, n_params * sizeof(double));
+    auto [iter, inserted] = m_param_ids.insert({key, m_params.size()});
+    if (inserted) {
+      m_params.insert(m_params.end(), gate.params, gate.params + n_params);
+    }
+    record.param = iter->second;
+  }
+
+  m_pending.push_back(record);
+  m_n_gates++;
+  if (m_pending.size() == pending_records) {
+    flush();
+  }
+}
+
+void TapeWriter::add(const GateTape &tape) {
+  for (auto &gate : tape.gates()) {
+    add(gate, tape.registers());
+  }
+}
+
+void TapeWriter::flush() {
+  m_out->write(reinterpret_cast<const char *>(m_pending.data()),
+              m_pending.size() * sizeof(TapeRecord));
+  m_pending.clear();
+}
+
+void TapeWriter::close() {
+  if (m_closed) {
+    return;
+  }
+  m_closed = true;
+  flush();
+
+  TapeFileHeader header;
+  std::memcpy(header.magic, tape_magic, sizeof(tape_magic));
+  header.version = tape_version;
+  header.record_size = sizeof(TapeRecord);
+  header.n_gates = m_n_gates;
+  header.n_params = m_params.size();
+  header.n_registers = m_registers.size();
+  header.n_symbols = m_symbols.size();
+  header.n_slots = m_slots.size();
+
+  auto &out = *m_out;
+  pad_to_8(out, m_base);
+  header.params_offset = out.tellp() - m_base;
+  out.write(reinterpret_cast<const char *>(m_params.data()),
+            m_params.size() * sizeof(double));
+  header.slots_offset = out.tellp() - m_base;
+  out.write(reinterpret_cast<const char *>(m_slots.data()),
+            m_slots.size() * sizeof(TapeSlot));
+  header.strings_offset = out.tellp() - m_base;
+  for (auto names : {&m_registers, &m_symbols}) {
+    for (auto &name : *names) {
+      const std::uint32_t length = name.size();
+      out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+      out.write(name.data(), length);
+    }
+  }
+
+  const auto end = out.tellp();
+  out.seekp(m_base);
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.seekp(end);
+  if (m_file.is_open()) {
+    m_file.close();
+  }
+  if (!out) {
+    xacc::error("[qcor] Could not write tape file " + m_file_name);
+  }
+}
+
+TapeReader::TapeReader(const std::string &file_name)
+    : m_file_name(file_name),
+      m_file(std::make_unique<MappedFile>(file_name, "tape file")) {
+  parse(m_file->begin(), m_file->size());
+}
+
+TapeReader::TapeReader(const void *data, const std::size_t size,
+                       const std::string &name)
+    : m_file_name(name) {
+  if (reinterpret_cast<std::uintptr_t>(data) % 8 != 0) {
+    xacc::error("[qcor] Unaligned " + name);
+  }
+  parse(static_cast<const char *>(data), size);
+}
+
+void TapeReader::parse(const char *begin, const std::size_t size) {
+  const auto &file_name = m_file_name;
+  const auto end = begin + size;
+  TapeFileHeader header;
+  if (size < sizeof(header) ||
+      std::memcmp(begin, tape_magic, sizeof(tape_magic)) != 0) {
+    xacc::error("[qcor] " + file_name + " is not a tape file");
+  }
+  std::memcpy(&header, begin, sizeof(header));
+  if (header.version != tape_version) {
+    xacc::error("[qcor] Unsupported tape file version " +
+                std::to_string(header.version));
+  }
+  // The sections follow each other. Counts are compared against the
+  // section sizes divided by the element size, so they cannot wrap.
+  if (header.record_size != sizeof(TapeRecord) ||
+      header.params_offset < sizeof(header) ||
+      header.params_offset % 8 != 0 ||
+      header.slots_offset < header.params_offset ||
+      header.strings_offset < header.slots_offset ||
+      header.strings_offset > size ||
+      header.n_gates >
+          (header.params_offset - sizeof(header)) / sizeof(TapeRecord) ||
+      header.n_params >
+          (header.slots_offset - header.params_offset) / sizeof(double) ||
+      header.n_slots >
+          (header.strings_offset - header.slots_offset) / sizeof(TapeSlot)) {
+    xacc::error("[qcor] Truncated tape file " + file_name);
+  }
+
+  m_n_gates = header.n_gates;
+  m_records = reinterpret_cast<const TapeRecord *>(begin + sizeof(header));
+  m_n_params = header.n_params;
+  m_params = reinterpret_cast<const double *>(begin + header.params_offset);
+  m_n_slots = header.n_slots;
+  m_slots = reinterpret_cast<const TapeSlot *>(begin + header.slots_offset);
+
+  auto pos = begin + header.strings_offset;
+  auto read_names = [&](const std::size_t n, std::vector<std::string> &out) {
+    // Every name takes at least its length field
+    out.reserve(std::min<std::size_t>(n, (end - pos) / sizeof(std::uint32_t)));
+    for (std::size_t i = 0; i < n; i++) {
+      std::uint32_t length;
+      if (std::size_t(end - pos) < sizeof(length)) {
+        xacc::error("[qcor] Truncated tape file " + file_name);
+      }
+      std::memcpy(&length, pos, sizeof(length));
+      pos += sizeof(length);
+      if (std::size_t(end - pos) < length) {
+        xacc::error("[qcor] Truncated tape file " + file_name);
+      }
+      out.emplace_back(pos, length);
+      pos += length;
+    }
+  };
+  read_names(header.n_registers, m_registers);
+  read_names(header.n_symbols, m_symbols);
+}
+
+TapeReader::~TapeReader() = default;
+
+std::vector<double>
+TapeReader::bound_params(const std::map<std::string, double> &values) const {
+  std::vector<double> params(m_params, m_params + m_n_params);
+  for (std::size_t s = 0; s < m_n_slots; s++) {
+    const auto slot = m_slots[s];
+    if (slot.param >= m_n_params || slot.symbol >= m_symbols.size()) {
+      xacc::error("[qcor] Corrupt symbol slot in tape file " + m_file_name);
+    }
+    auto iter = values.find(m_symbols[slot.symbol]);
+    if (iter != values.end()) {
+      params[slot.param] = iter->second;
+    }
+  }
+  return params;
+}
+
+void TapeReader::decode(const std::size_t first, const std::size_t last,
+                        const double *params, GateTape &tape) const {
+  // Registering the names in file order makes the register ids the same
+  for (auto &name : m_registers) {
+    tape.register_id(name);
+  }
+  tape.reserve(last - first);
+  const auto max_op = static_cast<std::uint8_t>(GateOp::CRZ);
+  for (auto i = first; i < last; i++) {
+    const auto &record = m_records[i];
+    if (static_cast<std::uint8_t>(record.op) > max_op) {
+      xacc::error("[qcor] Corrupt gate " + std::to_string(i) +
+                  " in tape file " + m_file_name);
+    }
+    const auto n_qubits = quantum::gate_n_qubits(record.op);
+    const auto n_params = quantum::gate_n_params(record.op);
+    TapeGate gate{record.op,
+                  {record.reg[0], record.reg[1]},
+                  {record.bit[0], record.bit[1]},
+                  {0.0, 0.0, 0.0}};
+    if (record.reg[0] >= m_registers.size() ||
+        (n_qubits == 2 && record.reg[1] >= m_registers.size()) ||
+        (n_params > 0 && record.param + n_params > m_n_params)) {
+      xacc::error("[qcor] Corrupt gate " + std::to_string(i) +
+                  " in tape file " + m_file_name);
+    }
+    std::copy_n(params + record.param, n_params, gate.params);
+    tape.add(gate);
+  }
+}
+
+GateTape
+TapeReader::to_tape(const std::map<std::string, double> &values) const {
+  GateTape tape;
+  if (m_n_slots > 0) {
+    const auto params = bound_params(values);
+    decode(0, m_n_gates, params.data(), tape);
+  } else {
+    decode(0, m_n_gates, m_params, tape);
+  }
+  return tape;
+}
+
+void TapeReader::for_each_chunk(
+    const std::size_t chunk_size,
+    const std::function<void(const GateTape &)> &f,
+    const std::map<std::string, double> &values) const {
+  std::vector<double> bound;
+  if (m_n_slots > 0) {
+    bound = bound_params(values);
+  }
+  const auto params = m_n_slots > 0 ? bound.data() : m_params;
+  const auto step = std::max<std::size_t>(chunk_size, 1);
+  for (std::size_t first = 0; first < m_n_gates; first += step) {
+    GateTape chunk;
+    decode(first, std::min(first + step, m_n_gates), params, chunk);
+    f(chunk);
+  }
+}
+
+void save_tape(const GateTape &tape, const std::string &file_name) {
+  TapeWriter writer(file_name);
+  writer.add(tape);
+  writer.close();
+}
+
+GateTape load_tape(const std::string &file_name,
+                   const std::map<std::string, double> &values) {
+  return TapeReader(file_name).to_tape(values);
+}
+
+void print_tape(std::ostream &os, const GateTape &tape) {
+  auto &registers = tape.registers();
+  for (auto &gate : tape.gates()) {
+    os << quantum::gate_name(gate.op);
+    const auto n_params = quantum::gate_n_params(gate.op);
+    for (int p = 0; p < n_params; p++) {
+      os << (p == 0 ? "(" : ",") << gate.params[p];
+    }
+    os << (n_params > 0 ? ") " : " ") << registers[gate.reg[0]]
+       << gate.bit[0];
+    if (quantum::gate_n_qubits(gate.op) == 2) {
+      os << "," << registers[gate.reg[1]] << gate.bit[1];
+    }
+    os << "\n";
+  }
+}
+
+void write_openqasm(std::ostream &os, const GateTape &tape) {
+  auto &registers = tape.registers();
+  const auto extents = tape.register_extents();
+  std::vector<bool> measured(registers.size(), false);
+  for (auto &gate : tape.gates()) {
+    if (gate.op == GateOp::Measure) {
+      measured[gate.reg[0]] = true;
+    }
+  }
+
+  const auto precision = os.precision(17);
+  os << "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n";
+  for (std::size_t r = 0; r < registers.size(); r++) {
+    os << "qreg " << registers[r] << "[" << extents[r] << "];\n";
+  }
+  for (std::size_t r = 0; r < registers.size(); r++) {
+    if (measured[r]) {
+      os << "creg c_" << registers[r] << "[" << extents[r] << "];\n";
+    }
+  }
+  for (auto &gate : tape.gates()) {
+    auto &q0 = registers[gate.reg[0]];
+    if (gate.op == GateOp::Measure) {
+      os << "measure " << q0 << "[" << gate.bit[0] << "] -> c_" << q0 << "["
+         << gate.bit[0] << "];\n";
+      continue;
+    }
+    os << qasm_name(gate.op);
+    const auto n_params = quantum::gate_n_params(gate.op);
+    for (int p = 0; p < n_params; p++) {
+      os << (p == 0 ? "(" : ",") << gate.params[p];
+    }
+    os << (n_params > 0 ? ") " : " ") << q0 << "[" << gate.bit[0] << "]";
+    if (quantum::gate_n_qubits(gate.op) == 2) {
+      os << "," << registers[gate.reg[1]] << "[" << gate.bit[1] << "]";
+    }
+    os << ";\n";
+  }
+  os.precision(precision);
+}
+
+GateTape read_openqasm(std::istream &is) {
+  // Drop comments, statements are then separated by semicolons
+  std::string source;
+  std::string line;
+  while (std::getline(is, line)) {
+    source += line.substr(0, line.find("//")) + "\n";
+  }
+
+  GateTape tape;
+  std::map<std::string, std::size_t> sizes;
+  auto declaration = [](const std::string &s, std::string &name,
+                        std::size_t &size) {
+    const auto open = s.find('['), close = s.find(']');
+    if (open == std::string::npos || close == std::string::npos ||
+        close < open) {
+      return false;
+    }
+    name = trim(s.substr(0, open));
+    size = std::stoul(s.substr(open + 1, close - open - 1));
+    return true;
+  };
+  // The qubits an argument names, every qubit of a register if it has no
+  // index
+  auto qubits = [&](const std::string &arg) {
+    std::string name;
+    std::size_t idx;
+    if (declaration(arg, name, idx)) {
+      return std::vector<qubit>{{name, idx}};
+    }
+    auto iter = sizes.find(arg);
+    if (iter == sizes.end()) {
+      xacc::error("[qcor] Unknown OpenQASM register " + arg);
+    }
+    std::vector<qubit> all;
+    for (std::size_t i = 0; i < iter->second; i++) {
+      all.push_back({arg, i});
+    }
+    return all;
+  };
+
+  std::stringstream statements(source);
+  std::string statement;
+  while (std::getline(statements, statement, ';')) {
+    statement = trim(statement);
+    if (statement.empty() || statement.rfind("OPENQASM", 0) == 0 ||
+        statement.rfind("include", 0) == 0 ||
+        statement.rfind("creg", 0) == 0 ||
+        statement.rfind("barrier", 0) == 0) {
+      continue;
+    }
+    if (statement.rfind("qreg", 0) == 0) {
+      std::string name;
+      std::size_t size;
+      if (!declaration(statement.substr(4), name, size)) {
+        xacc::error("[qcor] Invalid OpenQASM declaration " + statement);
+      }
+      sizes[name] = size;
+      tape.register_id(name);
+      continue;
+    }
+
+    std::size_t end = 0;
+    while (end < statement.size() &&
+           (std::isalnum(statement[end]) || statement[end] == '_')) {
+      end++;
+    }
+    const auto name = statement.substr(0, end);
+    GateOp op;
+    if (!qasm_op(name, op)) {
+      xacc::error("[qcor] Unsupported OpenQASM statement " + statement);
+    }
+    auto rest = trim(statement.substr(end));
+
+    std::vector<double> params;
+    if (!rest.empty() && rest[0] == '(') {
+      int depth = 0;
+      std::size_t close = 0;
+      for (; close < rest.size(); close++) {
+        depth += rest[close] == '(' ? 1 : rest[close] == ')' ? -1 : 0;
+        if (depth == 0) {
+          break;
+        }
+      }
+      if (close == rest.size()) {
+        xacc::error("[qcor] Unbalanced parentheses in " + statement);
+      }
+      for (auto &arg : split_arguments(rest.substr(1, close - 1))) {
+        params.push_back(Expression(arg).evaluate());
+      }
+      rest = trim(rest.substr(close + 1));
+    }
+    if (params.size() != quantum::gate_n_params(op)) {
+      xacc::error("[qcor] Wrong number of parameters in " + statement);
+    }
+
+    if (op == GateOp::Measure) {
+      // The classical target does not matter to the tape
+      rest = trim(rest.substr(0, rest.find("->")));
+    }
+    const auto args = split_arguments(rest);
+    if (args.size() != quantum::gate_n_qubits(op)) {
+      xacc::error("[qcor] Wrong number of qubits in " + statement);
+    }
+    if (args.size() == 1) {
+      for (auto &q : qubits(args[0])) {
+        tape.add(op, q, params);
+      }
+      continue;
+    }
+    const auto q1 = qubits(args[0]), q2 = qubits(args[1]);
+    if (q1.size() != 1 || q2.size() != 1) {
+      xacc::error("[qcor] Two qubit gates need indexed qubits in " +
+                  statement);
+    }
+    tape.add(op, q1[0], q2[0], params);
+  }
+  return tape;
+}
+
+} // namespace qcor
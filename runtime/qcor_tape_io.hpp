@@ -0,0 +1,195 @@
+#ifndef RUNTIME_QCOR_TAPE_IO_HPP_
+#define RUNTIME_QCOR_TAPE_IO_HPP_
+
+#include "gate_tape.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace qcor {
+
+// Binary format of a recorded QRT program (a quantum::GateTape), written
+// by TapeWriter and memory-mapped by TapeReader:
+//   header    : TapeFileHeader
+//   records   : n_gates TapeRecords, the opcode stream
+//   params    : n_params doubles, every distinct parameter tuple once
+//   slots     : n_slots TapeSlots, the symbolic parameters
+//   strings   : n_registers register names then n_symbols symbol names,
+//               each a uint32 length and its characters
+// Sections are 8 byte aligned and stored in host byte order. Records are
+// fixed size, so gate i is found without parsing the gates before it.
+constexpr char tape_magic[8] = {'Q', 'C', 'O', 'R', 'T', 'A', 'P', 'E'};
+constexpr std::uint32_t tape_version = 1;
+
+struct TapeFileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint64_t n_gates;
+  std::uint64_t n_params;
+  std::uint64_t params_offset;
+  std::uint64_t slots_offset;
+  std::uint64_t strings_offset;
+  std::uint32_t n_registers;
+  std::uint32_t n_symbols;
+  std::uint64_t n_slots;
+};
+static_assert(sizeof(TapeFileHeader) == 72, "unexpected TapeFileHeader size");
+
+// One gate. Its gate_n_params(op) parameters are params[param] onwards.
+struct TapeRecord {
+  quantum::GateOp op;
+  // tape_symbolic if a slot refers to the parameters of this gate
+  std::uint8_t flags;
+  std::uint16_t reg[2];
+  std::uint16_t reserved;
+  std::uint32_t bit[2];
+  std::uint32_t param;
+};
+static_assert(sizeof(TapeRecord) == 20, "unexpected TapeRecord size");
+constexpr std::uint8_t tape_symbolic = 1;
+
+// params[param] is the value of symbols[symbol] when the tape is read.
+// Symbolic parameters are never shared between gates.
+struct TapeSlot {
+  std::uint32_t param;
+  std::uint32_t symbol;
+};
+
+// Writes a tape file gate by gate, so a program never has to be held in
+// memory whole. The file is complete once close() is called or the
+// writer is destroyed.
+class TapeWriter {
+public:
+  explicit TapeWriter(const std::string &file_name);
+  // Write to out, e.g. a std::stringstream, instead of a file. out must
+  // be seekable and outlive the writer.
+  explicit TapeWriter(std::ostream &out);
+  ~TapeWriter();
+  TapeWriter(const TapeWriter &) = delete;
+  TapeWriter &operator=(const TapeWriter &) = delete;
+
+  // Append a gate whose register ids index registers. A non-empty
+  // symbols[p] makes parameter p symbolic, gate.params[p] is kept as its
+  // default value.
+  void add(const quantum::TapeGate &gate,
+           const std::vector<std::string> &registers,
+           const std::vector<std::string> &symbols = {});
+  // Append every gate of tape
+  void add(const quantum::GateTape &tape);
+
+  // Write the tables and the header
+  void close();
+  std::size_t size() const { return m_n_gates; }
+
+private:
+  struct ParamKey {
+    int n;
+    std::uint64_t bits[3];
+    bool operator==(const ParamKey &other) const;
+  };
+  struct ParamKeyHash {
+    std::size_t operator()(const ParamKey &key) const;
+  };
+
+  std::string m_file_name;
+  std::ofstream m_file;
+  std::ostream *m_out;
+  std::streamoff m_base = 0;
+  bool m_closed = false;
+  std::size_t m_n_gates = 0;
+  std::vector<TapeRecord> m_pending;
+  std::vector<std::string> m_registers;
+  std::unordered_map<std::string, std::uint16_t> m_register_ids;
+  std::vector<std::string> m_symbols;
+  std::unordered_map<std::string, std::uint32_t> m_symbol_ids;
+  std::vector<double> m_params;
+  std::unordered_map<ParamKey, std::uint32_t, ParamKeyHash> m_param_ids;
+  std::vector<TapeSlot> m_slots;
+
+  std::uint16_t register_id(const std::string &name);
+  void flush();
+};
+
+class MappedFile;
+
+// Read-only view of a tape file. The file is memory-mapped, opening it
+// only reads the header and the register and symbol names; records() and
+// params() point into the mapping.
+class TapeReader {
+public:
+  explicit TapeReader(const std::string &file_name);
+  // View a tape held in memory, e.g. embedded in the program. data must
+  // be 8 byte aligned and outlive the reader.
+  TapeReader(const void *data, const std::size_t size,
+             const std::string &name = "tape");
+  ~TapeReader();
+
+  std::size_t size() const { return m_n_gates; }
+  const TapeRecord *records() const { return m_records; }
+  std::size_t n_params() const { return m_n_params; }
+  const double *params() const { return m_params; }
+  std::size_t n_slots() const { return m_n_slots; }
+  const TapeSlot *slots() const { return m_slots; }
+  const std::vector<std::string> &registers() const { return m_registers; }
+  const std::vector<std::string> &symbols() const { return m_symbols; }
+
+  // Decode the program into a GateTape, binding each symbol to its entry
+  // in values or, if it has none, to the value it was written with
+  quantum::GateTape
+  to_tape(const std::map<std::string, double> &values = {}) const;
+  // Decode the program chunk_size gates at a time, e.g. to feed a
+  // quantum::StreamingTapeExecutor. f is called with each chunk in order.
+  void for_each_chunk(const std::size_t chunk_size,
+                      const std::function<void(const quantum::GateTape &)> &f,
+                      const std::map<std::string, double> &values = {}) const;
+
+private:
+  std::string m_file_name;
+  std::unique_ptr<MappedFile> m_file;
+  std::size_t m_n_gates = 0;
+  const TapeRecord *m_records = nullptr;
+  std::size_t m_n_params = 0;
+  const double *m_params = nullptr;
+  std::size_t m_n_slots = 0;
+  const TapeSlot *m_slots = nullptr;
+  std::vector<std::string> m_registers;
+  std::vector<std::string> m_symbols;
+
+  void parse(const char *begin, const std::size_t size);
+  // The parameter table with the symbols bound
+  std::vector<double>
+  bound_params(const std::map<std::string, double> &values) const;
+  void decode(const std::size_t first, const std::size_t last,
+              const double *params, quantum::GateTape &tape) const;
+};
+
+// Write tape to file_name in the binary format above
+void save_tape(const quantum::GateTape &tape, const std::string &file_name);
+// Read a tape file written by save_tape or TapeWriter
+quantum::GateTape load_tape(const std::string &file_name,
+                            const std::map<std::string, double> &values = {});
+
+// One gate per line in the syntax of xacc Instruction::toString(), e.g.
+//   Rz(0.5) q0
+//   CNOT q0,q1
+void print_tape(std::ostream &os, const quantum::GateTape &tape);
+
+// OpenQASM 2.0 conversions, mostly for debugging. Gates map to their
+// qelib1.inc names (CNOT is cx, CPhase is cu1, U is u3) and a Measure of
+// q[i] writes c_q[i]. Gate arguments are read as expressions of numbers
+// and pi with + - * / and parentheses; whole register arguments apply a
+// single qubit gate or measure to every qubit of the register.
+void write_openqasm(std::ostream &os, const quantum::GateTape &tape);
+quantum::GateTape read_openqasm(std::istream &is);
+
+} // namespace qcor
+
+#endif
@@ -0,0 +1,302 @@
+#include "gate_tape.hpp"
+
+#include "AcceleratorBuffer.hpp"
+#include "CompositeInstruction.hpp"
+#include "xacc.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace quantum {
+namespace {
+
+struct GateInfo {
+  GateOp op;
+  std::string name;
+  int n_qubits;
+  int n_params;
+};
+
+// Indexed by GateOp
+const std::vector<GateInfo> &gate_infos() {
+  static const std::vector<GateInfo> infos{
+      {GateOp::I, "I", 1, 0},          {GateOp::H, "H", 1, 0},
+      {GateOp::X, "X", 1, 0},          {GateOp::Y, "Y", 1, 0},
+      {GateOp::Z, "Z", 1, 0},          {GateOp::S, "S", 1, 0},
+      {GateOp::Sdg, "Sdg", 1, 0},      {GateOp::T, "T", 1, 0},
+      {GateOp::Tdg, "Tdg", 1, 0},      {GateOp::Rx, "Rx", 1, 1},
+      {GateOp::Ry, "Ry", 1, 1},        {GateOp::Rz, "Rz", 1, 1},
+      {GateOp::U1, "U1", 1, 1},        {GateOp::U, "U", 1, 3},
+      {GateOp::Measure, "Measure", 1, 0}, {GateOp::CNOT, "CNOT", 2, 0},
+      {GateOp::CY, "CY", 2, 0},        {GateOp::CZ, "CZ", 2, 0},
+      {GateOp::CH, "CH", 2, 0},        {GateOp::Swap, "Swap", 2, 0},
+      {GateOp::CPhase, "CPhase", 2, 1}, {GateOp::CRZ, "CRZ", 2, 1}};
+  return infos;
+}
+
+const GateInfo &info(const GateOp op) {
+  return gate_infos()[static_cast<std::size_t>(op)];
+}
+
+double parameter_as_double(const xacc::InstructionParameter &p,
+                           const std::string &gate) {
+  if (p.which() == 0) {
+    return p.as<int>();
+  }
+  if (p.which() == 1) {
+    return p.as<double>();
+  }
+  xacc::error("[qrt] Cannot record " + gate +
+              " with non-numeric parameter " + p.toString());
+  return 0.0;
+}
+} // namespace
+
+int gate_n_qubits(const GateOp op) { return info(op).n_qubits; }
+int gate_n_params(const GateOp op) { return info(op).n_params; }
+const std::string &gate_name(const GateOp op) { return info(op).name; }
+
+bool gate_op_from_name(const std::string &name, GateOp &op) {
+  static const std::unordered_map<std::string, GateOp> by_name = []() {
+    std::unordered_map<std::string, GateOp> m;
+    for (auto &i : gate_infos()) {
+      m.insert({i.name, i.op});
+    }
+    // Aliases used by some xacc compilers
+    m.insert({"CX", GateOp::CNOT});
+    m.insert({"Identity", GateOp::I});
+    return m;
+  }();
+  auto iter = by_name.find(name);
+  if (iter == by_name.end()) {
+    return false;
+  }
+  op = iter->second;
+  return true;
+}
+
+bool gate_is_clifford(const GateOp op) {
+  switch (op) {
+  case GateOp::I:
+  case GateOp::H:
+  case GateOp::S:
+  case GateOp::Sdg:
+  case GateOp::X:
+  case GateOp::Y:
+  case GateOp::Z:
+  case GateOp::CNOT:
+  case GateOp::CZ:
+  case GateOp::CY:
+  case GateOp::Swap:
+  case GateOp::Measure:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool gate_matrix(const GateOp op, const double *params,
+                 std::complex<double> *m) {
+  using amplitude_t = std::complex<double>;
+  static const double inv_sqrt2 = 1.0 / std::sqrt(2.0);
+  static const amplitude_t i_unit(0.0, 1.0);
+  auto set = [m](const amplitude_t m00, const amplitude_t m01,
+                 const amplitude_t m10, const amplitude_t m11) {
+    m[0] = m00;
+    m[1] = m01;
+    m[2] = m10;
+    m[3] = m11;
+    return true;
+  };
+
+  switch (op) {
+  case GateOp::I:
+  case GateOp::Measure:
+    return set(1.0, 0.0, 0.0, 1.0);
+  case GateOp::H:
+  case GateOp::CH:
+    return set(inv_sqrt2, inv_sqrt2, inv_sqrt2, -inv_sqrt2);
+  case GateOp::X:
+  case GateOp::CNOT:
+    return set(0.0, 1.0, 1.0, 0.0);
+  case GateOp::Y:
+  case GateOp::CY:
+    return set(0.0, -i_unit, i_unit, 0.0);
+  case GateOp::Z:
+  case GateOp::CZ:
+    return set(1.0, 0.0, 0.0, -1.0);
+  case GateOp::S:
+    return set(1.0, 0.0, 0.0, i_unit);
+  case GateOp::Sdg:
+    return set(1.0, 0.0, 0.0, -i_unit);
+  case GateOp::T:
+    return set(1.0, 0.0, 0.0, std::polar(1.0, M_PI / 4.0));
+  case GateOp::Tdg:
+    return set(1.0, 0.0, 0.0, std::polar(1.0, -M_PI / 4.0));
+  case GateOp::Rx: {
+    const double c = std::cos(params[0] / 2.0), s = std::sin(params[0] / 2.0);
+    return set(c, -i_unit * s, -i_unit * s, c);
+  }
+  case GateOp::Ry: {
+    const double c = std::cos(params[0] / 2.0), s = std::sin(params[0] / 2.0);
+    return set(c, -s, s, c);
+  }
+  case GateOp::Rz:
+  case GateOp::CRZ:
+    return set(std::polar(1.0, -params[0] / 2.0), 0.0, 0.0,
+               std::polar(1.0, params[0] / 2.0));
+  case GateOp::U1:
+  case GateOp::CPhase:
+    return set(1.0, 0.0, 0.0, std::polar(1.0, params[0]));
+  case GateOp::U: {
+    const double theta = params[0], phi = params[1], lambda = params[2];
+    const double c = std::cos(theta / 2.0), s = std::sin(theta / 2.0);
+    return set(c, -s * std::polar(1.0, lambda), s * std::polar(1.0, phi),
+               c * std::polar(1.0, phi + lambda));
+  }
+  case GateOp::Swap:
+    return false;
+  }
+  return false;
+}
+
+bool GateTape::is_clifford() const {
+  return std::all_of(m_gates.begin(), m_gates.end(), [](const TapeGate &g) {
+    return gate_is_clifford(g.op);
+  });
+}
+
+std::uint16_t GateTape::register_id(const std::string &name) {
+  // Kernels touch one or two registers, so remember the last hit
+  if (m_last_register < m_registers.size() &&
+      m_registers[m_last_register] == name) {
+    return m_last_register;
+  }
+  auto iter = std::find(m_registers.begin(), m_registers.end(), name);
+  if (iter == m_registers.end()) {
+    m_registers.push_back(name);
+    iter = m_registers.end() - 1;
+  }
+  m_last_register = iter - m_registers.begin();
+  return m_last_register;
+}
+
+void GateTape::add(const GateOp op, const qubit &q,
+                   const std::vector<double> &params) {
+  TapeGate gate{op, {register_id(q.first), 0}, {(std::uint32_t)q.second, 0},
+                {0.0, 0.0, 0.0}};
+  std::copy_n(params.begin(), std::min<std::size_t>(params.size(), 3),
+              gate.params);
+  m_gates.push_back(gate);
+}
+
+void GateTape::add(const GateOp op, const qubit &q1, const qubit &q2,
+                   const std::vector<double> &params) {
+  TapeGate gate{op,
+                {register_id(q1.first), register_id(q2.first)},
+                {(std::uint32_t)q1.second, (std::uint32_t)q2.second},
+                {0.0, 0.0, 0.0}};
+  std::copy_n(params.begin(), std::min<std::size_t>(params.size(), 3),
+              gate.params);
+  m_gates.push_back(gate);
+}
+
+void GateTape::add(xacc::Instruction &inst, const std::string &buffer_name) {
+  if (!try_add(inst, buffer_name)) {
+    xacc::error("[qrt] Gate " + inst.name() +
+                " is not supported by the gate tape.");
+  }
+}
+
+bool GateTape::try_add(xacc::Instruction &inst,
+                       const std::string &buffer_name) {
+  if (!inst.isEnabled()) {
+    return true;
+  }
+  if (inst.isComposite()) {
+    auto &composite = dynamic_cast<xacc::CompositeInstruction &>(inst);
+    for (auto &child : composite.getInstructions()) {
+      if (!try_add(*child, buffer_name)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  GateOp op;
+  if (!gate_op_from_name(inst.name(), op)) {
+    return false;
+  }
+
+  const auto &buffer_names = inst.getBufferNames();
+  auto reg = [&](const int i) {
+    if (!buffer_name.empty()) {
+      return register_id(buffer_name);
+    }
+    return register_id(i < buffer_names.size() ? buffer_names[i] : "");
+  };
+
+  TapeGate gate{op, {0, 0}, {0, 0}, {0.0, 0.0, 0.0}};
+  const auto bits = inst.bits();
+  for (int i = 0; i < gate_n_qubits(op); i++) {
+    gate.reg[i] = reg(i);
+    gate.bit[i] = bits[i];
+  }
+  for (int i = 0; i < gate_n_params(op) && i < inst.nParameters(); i++) {
+    gate.params[i] = parameter_as_double(inst.getParameter(i), inst.name());
+  }
+  m_gates.push_back(gate);
+  return true;
+}
+
+void GateTape::add(std::shared_ptr<xacc::CompositeInstruction> program,
+                   const std::string &buffer_name) {
+  add(*program, buffer_name);
+}
+
+void GateTape::clear() {
+  m_gates.clear();
+  m_registers.clear();
+  m_last_register = 0;
+}
+
+std::vector<std::size_t>
+GateTape::register_offsets(xacc::AcceleratorBuffer **buffers,
+                           const int n) const {
+  std::vector<std::size_t> offsets(m_registers.size(), 0);
+  if (n <= 1) {
+    return offsets;
+  }
+
+  for (std::size_t r = 0; r < m_registers.size(); r++) {
+    std::size_t offset = 0;
+    bool found = false;
+    for (int b = 0; b < n; b++) {
+      if (buffers[b]->name() == m_registers[r]) {
+        offsets[r] = offset;
+        found = true;
+        break;
+      }
+      offset += buffers[b]->size();
+    }
+    if (!found) {
+      xacc::error("[qrt] Gate tape register " + m_registers[r] +
+                  " is not one of the submitted buffers.");
+    }
+  }
+  return offsets;
+}
+
+std::vector<std::size_t> GateTape::register_extents() const {
+  std::vector<std::size_t> extents(m_registers.size(), 0);
+  for (auto &gate : m_gates) {
+    for (int i = 0; i < gate_n_qubits(gate.op); i++) {
+      extents[gate.reg[i]] =
+          std::max<std::size_t>(extents[gate.reg[i]], gate.bit[i] + 1);
+    }
+  }
+  return extents;
+}
+
+} // namespace quantum
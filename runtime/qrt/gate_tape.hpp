@@ -0,0 +1,143 @@
+#ifndef RUNTIME_QCOR_QRT_GATE_TAPE_HPP_
+#define RUNTIME_QCOR_QRT_GATE_TAPE_HPP_
+
+#include "qalloc.hpp"
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xacc {
+class AcceleratorBuffer;
+class CompositeInstruction;
+class Instruction;
+} // namespace xacc
+
+namespace quantum {
+
+// Opcodes of the gates recorded by the QRT.
+enum class GateOp : std::uint8_t {
+  I,
+  H,
+  X,
+  Y,
+  Z,
+  S,
+  Sdg,
+  T,
+  Tdg,
+  Rx,
+  Ry,
+  Rz,
+  U1,
+  U,
+  Measure,
+  CNOT,
+  CY,
+  CZ,
+  CH,
+  Swap,
+  CPhase,
+  CRZ
+};
+
+// Number of qubits / parameters of a gate, and its xacc IR name
+int gate_n_qubits(const GateOp op);
+int gate_n_params(const GateOp op);
+const std::string &gate_name(const GateOp op);
+// Map an xacc IR gate name to an opcode, returns false if unknown
+bool gate_op_from_name(const std::string &name, GateOp &op);
+// True for the gates a stabilizer simulator can apply: I, H, S, Sdg,
+// X, Y, Z, CNOT, CZ, CY, Swap and Measure
+bool gate_is_clifford(const GateOp op);
+// The 2x2 matrix (row major) a gate applies to its target, for controlled
+// gates the matrix applied when the control is set. Returns false for
+// Swap, which has no such form.
+bool gate_matrix(const GateOp op, const double *params,
+                 std::complex<double> *m);
+
+// One recorded gate. Qubits are (register id, index) pairs,
+// register ids index GateTape::registers().
+struct TapeGate {
+  GateOp op;
+  std::uint16_t reg[2];
+  std::uint32_t bit[2];
+  double params[3];
+};
+
+// The GateTape is a flat, compact record of the gates a QRT kernel
+// invocation produces, kept alongside the xacc CompositeInstruction.
+// Backends that implement TapeExecutor consume it directly instead of
+// walking the xacc IR with visitors.
+class GateTape {
+public:
+  void add(const GateOp op, const qubit &q,
+           const std::vector<double> &params = {});
+  void add(const GateOp op, const qubit &q1, const qubit &q2,
+           const std::vector<double> &params = {});
+  // Add a gate from xacc IR. If buffer_name is non-empty it overrides
+  // the instruction buffer names.
+  void add(xacc::Instruction &inst, const std::string &buffer_name = "");
+  // As add(), but returns false instead of failing for a gate that has no
+  // GateOp. The gates of a composite before that one are kept.
+  bool try_add(xacc::Instruction &inst, const std::string &buffer_name = "");
+  // Add all (flattened) gates of a composite
+  void add(std::shared_ptr<xacc::CompositeInstruction> program,
+           const std::string &buffer_name = "");
+  // Add a gate whose register ids are already ids of this tape
+  void add(const TapeGate &gate) { m_gates.push_back(gate); }
+  void reserve(const std::size_t n_gates) { m_gates.reserve(n_gates); }
+
+  void clear();
+  bool empty() const { return m_gates.empty(); }
+  std::size_t size() const { return m_gates.size(); }
+  const std::vector<TapeGate> &gates() const { return m_gates; }
+  const std::vector<std::string> &registers() const { return m_registers; }
+  // True if every gate is a Clifford gate, see gate_is_clifford()
+  bool is_clifford() const;
+  std::uint16_t register_id(const std::string &name);
+
+  // The flat qubit offset of every register when executing on the given
+  // buffers, which are laid out one after another. With a single buffer
+  // every register maps to it.
+  std::vector<std::size_t>
+  register_offsets(xacc::AcceleratorBuffer **buffers, const int n) const;
+
+  // Largest (index + 1) used for each register
+  std::vector<std::size_t> register_extents() const;
+
+private:
+  std::vector<TapeGate> m_gates;
+  std::vector<std::string> m_registers;
+  std::uint16_t m_last_register = 0;
+};
+
+// Accelerators that can execute a GateTape directly implement this
+// interface next to xacc::Accelerator. quantum::submit() checks for it
+// and bypasses xacc::internal_compiler::execute if present.
+class TapeExecutor {
+public:
+  virtual void execute(xacc::AcceleratorBuffer **buffers, const int nBuffers,
+                       const GateTape &tape) = 0;
+  virtual ~TapeExecutor() {}
+};
+
+// TapeExecutors that can also apply a program piece by piece while it is
+// still being recorded implement this, see quantum::set_streaming(). The
+// QRT calls begin_stream() with the buffers of the registers recorded so
+// far, then execute_chunk() for consecutive pieces of the tape in program
+// order, one call at a time from a worker thread, and finally
+// end_stream() to record the results on those buffers.
+class StreamingTapeExecutor {
+public:
+  virtual void begin_stream(xacc::AcceleratorBuffer **buffers,
+                            const int nBuffers) = 0;
+  virtual void execute_chunk(const GateTape &chunk) = 0;
+  virtual void end_stream() = 0;
+  virtual ~StreamingTapeExecutor() {}
+};
+
+} // namespace quantum
+
+#endif
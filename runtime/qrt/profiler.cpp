@@ -0,0 +1,270 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+
+namespace quantum {
+namespace profiling {
+
+std::atomic<bool> enabled_flag(false);
+
+namespace {
+struct Span {
+  const char *name;
+  std::uint64_t start_ns, end_ns;
+};
+
+struct CounterSample {
+  const char *name;
+  std::uint64_t time_ns;
+  std::int64_t value;
+};
+
+// Spans of one thread. Only that thread appends; the lock is taken by it
+// and by reports and reset(), so it is uncontended while recording.
+struct ThreadBuffer {
+  int tid;
+  std::mutex mutex;
+  std::vector<Span> spans;
+};
+
+// Copy of everything recorded, taken for a report
+struct Snapshot {
+  std::vector<std::pair<int, std::vector<Span>>> spans;
+  std::map<std::string, std::int64_t> counters;
+  std::vector<CounterSample> samples;
+  bool empty() const {
+    return counters.empty() &&
+           std::all_of(spans.begin(), spans.end(),
+                       [](auto &thread) { return thread.second.empty(); });
+  }
+};
+
+// Spans live in buffers owned by the registry, so they outlive the
+// threads that recorded them
+class Registry {
+public:
+  std::shared_ptr<ThreadBuffer> add_thread() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto buffer = std::make_shared<ThreadBuffer>();
+    buffer->tid = m_buffers.size();
+    m_buffers.push_back(buffer);
+    return buffer;
+  }
+
+  void count(const char *name, const std::int64_t delta) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto value = m_counters[name] += delta;
+    m_samples.push_back({name, now_ns(), value});
+  }
+
+  Snapshot snapshot() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Snapshot snapshot;
+    for (auto &buffer : m_buffers) {
+      std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+      snapshot.spans.push_back({buffer->tid, buffer->spans});
+    }
+    snapshot.counters = m_counters;
+    snapshot.samples = m_samples;
+    return snapshot;
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &buffer : m_buffers) {
+      std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+      buffer->spans.clear();
+    }
+    m_counters.clear();
+    m_samples.clear();
+  }
+
+  std::string output;
+  std::uint64_t origin_ns = now_ns();
+
+private:
+  std::mutex m_mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+  std::map<std::string, std::int64_t> m_counters;
+  std::vector<CounterSample> m_samples;
+};
+
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+ThreadBuffer &thread_buffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer =
+      registry().add_thread();
+  return *buffer;
+}
+
+// Reads QCOR_PROFILE at load time and writes the report at exit
+struct AtExit {
+  AtExit() {
+    // Construct the registry first, so it is destroyed after this
+    registry();
+    if (auto env = std::getenv("QCOR_PROFILE")) {
+      const std::string value(env);
+      if (!value.empty() && value != "0") {
+        if (value != "1" && value != "summary") {
+          registry().output = value;
+        }
+        set_enabled(true);
+      }
+    }
+  }
+  ~AtExit() {
+    if (registry().snapshot().empty()) {
+      return;
+    }
+    if (registry().output.empty()) {
+      write_summary(std::cerr);
+      return;
+    }
+    std::ofstream out(registry().output);
+    if (!out) {
+      std::cerr << "[qcor] Could not write profile to " << registry().output
+                << "\n";
+      return;
+    }
+    write_trace(out);
+    std::cerr << "[qcor] Profile written to " << registry().output << "\n";
+  }
+} at_exit;
+
+void write_escaped(std::ostream &os, const std::string &s) {
+  os << '"';
+  for (auto c : s) {
+    if (c == '"' || c == '\\') {
+      os << '\\';
+    }
+    os << c;
+  }
+  os << '"';
+}
+} // namespace
+
+void set_enabled(const bool enable) {
+  enabled_flag.store(enable, std::memory_order_relaxed);
+}
+
+void set_output(const std::string &trace_file) {
+  registry().output = trace_file;
+}
+
+std::uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void record(const char *name, const std::uint64_t start_ns,
+            const std::uint64_t end_ns) {
+  auto &buffer = thread_buffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.spans.push_back({name, start_ns, end_ns});
+}
+
+void count(const char *name, const std::int64_t delta) {
+  if (enabled()) {
+    registry().count(name, delta);
+  }
+}
+
+void write_trace(std::ostream &os) {
+  const auto origin = registry().origin_ns;
+  const auto pid = ::getpid();
+  auto us = [origin](const std::uint64_t ns) {
+    return (double(ns) - double(origin)) * 1e-3;
+  };
+  const auto recorded = registry().snapshot();
+  const auto flags = os.flags();
+  const auto precision = os.precision();
+  os << std::fixed << std::setprecision(3);
+  os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  bool first = true;
+  for (auto &[tid, spans] : recorded.spans) {
+    for (auto &span : spans) {
+      os << (first ? "\n" : ",\n") << "{\"name\": ";
+      write_escaped(os, span.name);
+      os << ", \"cat\": \"qcor\", \"ph\": \"X\", \"ts\": "
+         << us(span.start_ns)
+         << ", \"dur\": " << (span.end_ns - span.start_ns) * 1e-3
+         << ", \"pid\": " << pid << ", \"tid\": " << tid << "}";
+      first = false;
+    }
+  }
+  for (auto &sample : recorded.samples) {
+    os << (first ? "\n" : ",\n") << "{\"name\": ";
+    write_escaped(os, sample.name);
+    os << ", \"cat\": \"qcor\", \"ph\": \"C\", \"ts\": " << us(sample.time_ns)
+       << ", \"pid\": " << pid << ", \"args\": {\"value\": " << sample.value
+       << "}}";
+    first = false;
+  }
+  os << "\n]}\n";
+  os.flags(flags);
+  os.precision(precision);
+}
+
+void write_summary(std::ostream &os) {
+  struct Totals {
+    std::size_t calls = 0;
+    std::uint64_t total_ns = 0, max_ns = 0;
+  };
+  std::map<std::string, Totals> totals;
+  const auto recorded = registry().snapshot();
+  for (auto &thread : recorded.spans) {
+    for (auto &span : thread.second) {
+      auto &t = totals[span.name];
+      const auto ns = span.end_ns - span.start_ns;
+      t.calls++;
+      t.total_ns += ns;
+      t.max_ns = std::max(t.max_ns, ns);
+    }
+  }
+
+  // Most expensive first
+  std::vector<std::pair<std::string, Totals>> rows(totals.begin(),
+                                                   totals.end());
+  std::sort(rows.begin(), rows.end(), [](auto &a, auto &b) {
+    return a.second.total_ns > b.second.total_ns;
+  });
+  const auto flags = os.flags();
+  const auto precision = os.precision();
+  os << "[qcor] Profile\n"
+     << std::left << std::setw(36) << "phase" << std::right << std::setw(10)
+     << "calls" << std::setw(14) << "total ms" << std::setw(12) << "mean ms"
+     << std::setw(12) << "max ms" << "\n";
+  os << std::fixed << std::setprecision(3);
+  for (auto &[name, t] : rows) {
+    os << std::left << std::setw(36) << name << std::right << std::setw(10)
+       << t.calls << std::setw(14) << t.total_ns * 1e-6 << std::setw(12)
+       << t.total_ns * 1e-6 / t.calls << std::setw(12) << t.max_ns * 1e-6
+       << "\n";
+  }
+  for (auto &[name, value] : recorded.counters) {
+    os << std::left << std::setw(36) << name << std::right << std::setw(10)
+       << value << "\n";
+  }
+  os.flags(flags);
+  os.precision(precision);
+}
+
+void reset() { registry().reset(); }
+
+} // namespace profiling
+} // namespace quantum
@@ -0,0 +1,78 @@
+#ifndef RUNTIME_QCOR_QRT_PROFILER_HPP_
+#define RUNTIME_QCOR_QRT_PROFILER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace quantum {
+
+// Per-phase timing of the runtime. Scopes around kernel tracing,
+// submission, accelerator execution, observe(), objective evaluations and
+// taskInitiate iterations record spans, and counters accumulate e.g. the
+// circuits executed. Both are compiled in; while profiling is off a scope
+// costs one relaxed atomic load.
+//
+// Profiling is turned on by qcor::set_profiling(true) or the QCOR_PROFILE
+// environment variable:
+//   QCOR_PROFILE=1          print a summary table to stderr at exit
+//   QCOR_PROFILE=file.json  write a Chrome trace_event file at exit, to
+//                           be opened in chrome://tracing or Perfetto
+// Spans are buffered per thread, behind a lock only reports and reset()
+// contend for, so they can run while other threads record.
+namespace profiling {
+
+extern std::atomic<bool> enabled_flag;
+
+inline bool enabled() {
+  return enabled_flag.load(std::memory_order_relaxed);
+}
+// Turn recording on or off. Spans recorded so far are kept.
+void set_enabled(const bool enable);
+// Where the at-exit report goes: a trace file name, or empty for the
+// summary table on stderr
+void set_output(const std::string &trace_file);
+
+// Nanoseconds on a monotonic clock
+std::uint64_t now_ns();
+// Record a span of the calling thread. name must outlive the profiler,
+// e.g. a string literal.
+void record(const char *name, const std::uint64_t start_ns,
+            const std::uint64_t end_ns);
+// Add delta to a counter, recorded while profiling is on
+void count(const char *name, const std::int64_t delta = 1);
+
+// Times its own lifetime as a span named name
+class Scope {
+public:
+  explicit Scope(const char *name) : m_name(enabled() ? name : nullptr) {
+    if (m_name) {
+      m_start = now_ns();
+    }
+  }
+  ~Scope() {
+    if (m_name) {
+      record(m_name, m_start, now_ns());
+    }
+  }
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+private:
+  const char *m_name;
+  std::uint64_t m_start = 0;
+};
+
+// Chrome trace_event JSON of everything recorded: complete ("X") events
+// for spans and counter ("C") events, timestamps in microseconds
+void write_trace(std::ostream &os);
+// Per span name: calls, total, mean and max milliseconds, then counters
+void write_summary(std::ostream &os);
+// Drop everything recorded
+void reset();
+
+} // namespace profiling
+} // namespace quantum
+
+#endif
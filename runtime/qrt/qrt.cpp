@@ -1,11 +1,17 @@
 #include "qrt.hpp"
 #include "Instruction.hpp"
+#include "profiler.hpp"
 #include "PauliOperator.hpp"
 #include "xacc.hpp"
 #include "xacc_internal_compiler.hpp"
 #include "xacc_service.hpp"
 #include <Eigen/Dense>
 #include <Utils.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 std::vector<int> xacc::internal_compiler::__controlledIdx = {};
 
@@ -38,6 +44,7 @@ void simplified_qrt_call_two_qbits(const char *gate_name,
 namespace quantum {
 std::shared_ptr<xacc::CompositeInstruction> program = nullptr;
 std::shared_ptr<xacc::IRProvider> provider = nullptr;
+GateTape tape;
 // We only allow *single* quantum entry point,
 // i.e. a master quantum kernel which is invoked from classical code.
 // Multiple kernels can be defined to be used inside the *entry-point* kernel.
@@ -45,14 +52,216 @@ std::shared_ptr<xacc::IRProvider> provider = nullptr;
 // by sub-kernels will be ignored.
 bool __entry_point_initialized = false;
 
+namespace {
+// Applies chunks of the tape on a worker thread while the kernel keeps
+// recording the next one. At most one chunk waits while another is
+// applied, so recording blocks when it gets ahead of the backend.
+class ChunkPipeline {
+public:
+  ChunkPipeline(StreamingTapeExecutor &executor,
+                std::vector<xacc::AcceleratorBuffer *> buffers)
+      : m_executor(executor), m_buffers(std::move(buffers)) {
+    m_executor.begin_stream(m_buffers.data(), m_buffers.size());
+    m_worker = std::thread([this]() { work(); });
+  }
+
+  ~ChunkPipeline() { stop(); }
+
+  void push(GateTape &&chunk) {
+    for (auto &name : chunk.registers()) {
+      if (std::none_of(m_buffers.begin(), m_buffers.end(),
+                       [&](xacc::AcceleratorBuffer *buffer) {
+                         return buffer->name() == name;
+                       })) {
+        xacc::error("[qrt] Register " + name +
+                    " is first used after streaming of the kernel began, "
+                    "use it earlier or raise the chunk size.");
+      }
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [&]() { return !m_pending || m_failure; });
+    rethrow();
+    m_queued = std::move(chunk);
+    m_pending = true;
+    m_changed.notify_all();
+  }
+
+  // Wait for the queued chunks, then let the backend record results
+  void finish() {
+    stop();
+    rethrow();
+    m_executor.end_stream();
+  }
+
+private:
+  StreamingTapeExecutor &m_executor;
+  std::vector<xacc::AcceleratorBuffer *> m_buffers;
+  std::thread m_worker;
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  GateTape m_queued;
+  bool m_pending = false, m_done = false;
+  std::exception_ptr m_failure;
+
+  void work() {
+    while (true) {
+      GateTape chunk;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [&]() { return m_pending || m_done; });
+        if (!m_pending) {
+          return;
+        }
+        chunk = std::move(m_queued);
+        m_queued.clear();
+        m_pending = false;
+        m_changed.notify_all();
+      }
+      try {
+        m_executor.execute_chunk(chunk);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failure = std::current_exception();
+        m_changed.notify_all();
+        return;
+      }
+    }
+  }
+
+  void stop() {
+    if (!m_worker.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_done = true;
+      m_changed.notify_all();
+    }
+    m_worker.join();
+  }
+
+  void rethrow() {
+    if (m_failure) {
+      std::rethrow_exception(m_failure);
+    }
+  }
+};
+
+// Gates per streamed chunk, see set_streaming()
+std::size_t stream_chunk_size = 0;
+// The backend of the kernel being recorded, if it is streamed
+StreamingTapeExecutor *streamer = nullptr;
+// Set if the registers could not be resolved when the first chunk filled
+bool stream_declined = false;
+std::unique_ptr<ChunkPipeline> pipeline;
+// Whether gates are recorded on the tape as the kernel runs. Only tape
+// executing and streaming backends read it, see initialize().
+bool record_tape = false;
+// Set when a recorded gate has no GateOp. The program then runs from the
+// xacc IR, which is always built when not streaming.
+bool tape_unusable = false;
+
+// The current accelerator, if streaming is on and it can be streamed to.
+// Backends that stream also execute whole tapes, so the xacc IR is never
+// needed for them.
+StreamingTapeExecutor *streaming_backend() {
+  auto qpu = xacc::internal_compiler::get_qpu();
+  if (stream_chunk_size == 0 || !qpu ||
+      !dynamic_cast<TapeExecutor *>(qpu.get())) {
+    return nullptr;
+  }
+  return dynamic_cast<StreamingTapeExecutor *>(qpu.get());
+}
+
+// Hand the recorded gates to the backend, starting the stream on the
+// first chunk
+void push_chunk() {
+  if (!pipeline) {
+    if (stream_declined) {
+      return;
+    }
+    std::vector<xacc::AcceleratorBuffer *> buffers;
+    for (auto &name : tape.registers()) {
+      if (!xacc::hasBuffer(name)) {
+        // Keep recording, the whole tape is executed on submit
+        stream_declined = true;
+        return;
+      }
+      buffers.push_back(xacc::getBuffer(name).get());
+    }
+    pipeline = std::make_unique<ChunkPipeline>(*streamer, buffers);
+  }
+  pipeline->push(std::move(tape));
+  tape.clear();
+}
+
+// Called after every recorded gate
+void check_chunk() {
+  if (streamer && tape.size() >= stream_chunk_size) {
+    push_chunk();
+  }
+}
+
+// Record an xacc IR gate on the tape, if the tape is recorded
+void record(xacc::Instruction &inst, const std::string &buffer_name = "") {
+  if (streamer) {
+    tape.add(inst, buffer_name);
+    return check_chunk();
+  }
+  if (record_tape && !tape_unusable && !tape.try_add(inst, buffer_name)) {
+    tape_unusable = true;
+  }
+}
+
+// Look up the GateOp of a gate that goes on the tape. False if the tape
+// is not recorded, or if the gate has none, which ends its use.
+bool record_op(const std::string &name, GateOp &op) {
+  if (!record_tape || tape_unusable) {
+    return false;
+  }
+  if (!gate_op_from_name(name, op)) {
+    tape_unusable = true;
+    return false;
+  }
+  return true;
+}
+
+// The current accelerator, if it can execute the gate tape directly
+TapeExecutor *tape_executor() {
+  auto qpu = xacc::internal_compiler::get_qpu();
+  return qpu ? dynamic_cast<TapeExecutor *>(qpu.get()) : nullptr;
+}
+
+// The backend to hand the tape to on submit, null if the program runs
+// from the xacc IR
+TapeExecutor *tape_runner() {
+  return record_tape && !tape_unusable ? tape_executor() : nullptr;
+}
+
+void finish_stream() {
+  if (!tape.empty()) {
+    push_chunk();
+  }
+  pipeline->finish();
+  pipeline.reset();
+  tape.clear();
+}
+} // namespace
+
 void initialize(const std::string qpu_name, const std::string kernel_name) {
   if (!__entry_point_initialized) {
+    profiling::Scope scope("xacc initialize");
     xacc::internal_compiler::compiler_InitializeXACC(qpu_name.c_str());
     provider = xacc::getIRProvider("quantum");
     program = provider->createComposite(kernel_name);
   }
 
   __entry_point_initialized = true;
+  if (!pipeline) {
+    // Sub-kernels of a streamed kernel see the same setting
+    streamer = streaming_backend();
+    record_tape = streamer || tape_executor();
+  }
 }
 
 void set_shots(int shots) {
@@ -60,6 +269,12 @@ void set_shots(int shots) {
       {std::make_pair("shots", shots)});
 }
 
+void set_streaming(const std::size_t chunk_size) {
+  stream_chunk_size = chunk_size;
+}
+
+std::size_t get_streaming() { return stream_chunk_size; }
+
 // Add a controlled instruction:
 void add_controlled_inst(xacc::InstPtr &inst, int ctrlIdx) {
   auto tempKernel = provider->createComposite("temp_control");
@@ -72,12 +287,29 @@ void add_controlled_inst(xacc::InstPtr &inst, int ctrlIdx) {
   });
 
   for (int instId = 0; instId < ctrlKernel->nInstructions(); ++instId) {
-    program->addInstruction(ctrlKernel->getInstruction(instId)->clone());
+    auto ctrl_inst = ctrlKernel->getInstruction(instId)->clone();
+    if (!streamer) {
+      program->addInstruction(ctrl_inst);
+    }
+    record(*ctrl_inst);
+  }
+}
+
+// Map a gate name to its tape opcode, the QRT only records known gates
+GateOp tape_op(const std::string &name) {
+  GateOp op;
+  if (!gate_op_from_name(name, op)) {
+    xacc::error("[qrt] Unknown gate " + name);
   }
+  return op;
 }
 
 void one_qubit_inst(const std::string &name, const qubit &qidx,
                     std::vector<double> parameters) {
+  if (streamer && xacc::internal_compiler::__controlledIdx.empty()) {
+    tape.add(tape_op(name), qidx, parameters);
+    return check_chunk();
+  }
   auto inst =
       provider->createInstruction(name, std::vector<std::size_t>{qidx.second});
   inst->setBufferNames({qidx.first});
@@ -88,6 +320,10 @@ void one_qubit_inst(const std::string &name, const qubit &qidx,
   if (xacc::internal_compiler::__controlledIdx.empty()) {
     // Add the instruction
     program->addInstruction(inst);
+    GateOp op;
+    if (record_op(name, op)) {
+      tape.add(op, qidx, parameters);
+    }
   } else {
     // In a controlled block:
     add_controlled_inst(inst, __controlledIdx[0]);
@@ -96,6 +332,10 @@ void one_qubit_inst(const std::string &name, const qubit &qidx,
 
 void two_qubit_inst(const std::string &name, const qubit &qidx1,
                     const qubit &qidx2, std::vector<double> parameters) {
+  if (streamer && xacc::internal_compiler::__controlledIdx.empty()) {
+    tape.add(tape_op(name), qidx1, qidx2, parameters);
+    return check_chunk();
+  }
   auto inst = provider->createInstruction(
       name, std::vector<std::size_t>{qidx1.second, qidx2.second});
   inst->setBufferNames({qidx1.first, qidx2.first});
@@ -105,6 +345,10 @@ void two_qubit_inst(const std::string &name, const qubit &qidx1,
   // Not in a controlled-block
   if (xacc::internal_compiler::__controlledIdx.empty()) {
     program->addInstruction(inst);
+    GateOp op;
+    if (record_op(name, op)) {
+      tape.add(op, qidx1, qidx2, parameters);
+    }
   } else {
     // In a controlled block:
     add_controlled_inst(inst, __controlledIdx[0]);
@@ -272,22 +516,73 @@ void exp(qreg q, const double theta, std::shared_ptr<xacc::Observable> H) {
   auto tmp = xasm->compile(xasm_src)->getComposites()[0];
 
   for (auto inst : tmp->getInstructions()) {
-    program->addInstruction(inst);
+    if (!streamer) {
+      program->addInstruction(inst);
+    }
+    record(*inst, q.name());
   }
 }
 
 void submit(xacc::AcceleratorBuffer *buffer) {
-  xacc::internal_compiler::execute(buffer, program);
+  profiling::Scope scope("quantum::submit");
+  profiling::count("circuits executed");
+  if (pipeline) {
+    // Streamed, the backend already holds the state
+    finish_stream();
+  } else if (auto executor = tape_runner()) {
+    // In-process backend, hand it the gate tape directly
+    profiling::Scope execute("tape executor");
+    executor->execute(&buffer, 1, tape);
+  } else {
+    profiling::Scope execute("xacc::internal_compiler::execute");
+    xacc::internal_compiler::execute(buffer, program);
+  }
   clearProgram();
 }
 
 void submit(xacc::AcceleratorBuffer **buffers, const int nBuffers) {
-  xacc::internal_compiler::execute(buffers, nBuffers, program);
+  profiling::Scope scope("quantum::submit");
+  profiling::count("circuits executed");
+  if (pipeline) {
+    finish_stream();
+  } else if (auto executor = tape_runner()) {
+    profiling::Scope execute("tape executor");
+    executor->execute(buffers, nBuffers, tape);
+  } else {
+    profiling::Scope execute("xacc::internal_compiler::execute");
+    xacc::internal_compiler::execute(buffers, nBuffers, program);
+  }
+  streamer = nullptr;
+  stream_declined = false;
 }
 std::shared_ptr<xacc::CompositeInstruction> getProgram() { return program; }
 xacc::CompositeInstruction *program_raw_pointer() { return program.get(); }
+const GateTape *tryGetTape() {
+  if (!streamer && (!record_tape || tape_unusable)) {
+    // Not recorded while the kernel ran, convert the xacc IR
+    tape.clear();
+    record_tape = true;
+    tape_unusable = program && !tape.try_add(*program);
+    if (tape_unusable) {
+      tape.clear();
+    }
+  }
+  return tape_unusable ? nullptr : &tape;
+}
+const GateTape &getTape() {
+  if (!tryGetTape()) {
+    // Fails naming the gate without a GateOp
+    tape.add(program);
+  }
+  return tape;
+}
 void clearProgram() {
   if (program && provider)
     program = provider->createComposite(program->name());
+  tape.clear();
+  pipeline.reset();
+  streamer = nullptr;
+  stream_declined = false;
+  tape_unusable = false;
 }
 } // namespace quantum
\ No newline at end of file
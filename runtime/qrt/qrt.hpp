@@ -1,6 +1,7 @@
 #ifndef RUNTIME_QCOR_QRT_HPP_
 #define RUNTIME_QCOR_QRT_HPP_
 
+#include "gate_tape.hpp"
 #include "qalloc.hpp"
 #include <CompositeInstruction.hpp>
 #include <memory>
@@ -40,9 +41,25 @@ namespace quantum {
 
 extern std::shared_ptr<xacc::CompositeInstruction> program;
 extern std::shared_ptr<xacc::IRProvider> provider;
+// Compact record of the gates in program, see gate_tape.hpp. It is kept
+// as the kernel runs only for backends that execute or stream it, read it
+// through getTape().
+extern GateTape tape;
 
 void initialize(const std::string qpu_name, const std::string kernel_name);
 void set_shots(int shots);
+
+// Streamed execution of long programs. With chunk_size > 0 and a backend
+// that implements StreamingTapeExecutor (e.g. qcor-sv), every chunk_size
+// recorded gates are handed to the backend and applied on a worker thread
+// while the kernel keeps recording. No xacc IR is built for such kernels,
+// so memory stays bounded by a few chunks however long the program is,
+// and getProgram() is empty. The registers a kernel uses must be known
+// (stored xacc buffers) by the time its first chunk is full. 0, the
+// default, records and submits whole programs.
+void set_streaming(const std::size_t chunk_size);
+std::size_t get_streaming();
+
 void one_qubit_inst(const std::string &name, const qubit &qidx,
                     std::vector<double> parameters = {});
 void two_qubit_inst(const std::string &name, const qubit &qidx1,
@@ -92,8 +109,13 @@ void submit(xacc::AcceleratorBuffer **buffers, const int nBuffers);
 // Some getters for the qcor runtime library. 
 std::shared_ptr<xacc::CompositeInstruction> getProgram();
 xacc::CompositeInstruction *program_raw_pointer();
+// The gate tape of the current program, converted from the xacc IR if
+// it was not recorded. Fails if the program has a gate without a GateOp.
+const GateTape &getTape();
+// As getTape(), but null instead of failing
+const GateTape *tryGetTape();
 
-// Clear the current program
+// Clear the current program, dropping an unfinished stream
 void clearProgram();
 
 } // namespace quantum
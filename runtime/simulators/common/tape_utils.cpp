@@ -0,0 +1,91 @@
+#include "tape_utils.hpp"
+
+#include "AcceleratorBuffer.hpp"
+#include "xacc.hpp"
+
+#include <algorithm>
+
+namespace qcor {
+namespace simulators {
+
+std::size_t flat_size(const quantum::GateTape &tape,
+                      xacc::AcceleratorBuffer **buffers, const int nBuffers) {
+  std::size_t n_qubits = 0;
+  for (int b = 0; b < nBuffers; b++) {
+    n_qubits += buffers[b]->size();
+  }
+  if (nBuffers == 1) {
+    // Allow composites that address more qubits than the buffer declares
+    for (auto extent : tape.register_extents()) {
+      n_qubits = std::max(n_qubits, extent);
+    }
+  }
+  return n_qubits;
+}
+
+std::array<std::size_t, 2>
+logical_qubits(const quantum::GateTape &tape, const quantum::TapeGate &gate,
+               const std::vector<std::size_t> &offsets,
+               const std::size_t n_qubits, const std::string &backend) {
+  std::array<std::size_t, 2> l{0, 0};
+  for (int i = 0; i < quantum::gate_n_qubits(gate.op); i++) {
+    l[i] = offsets[gate.reg[i]] + gate.bit[i];
+    if (l[i] >= n_qubits) {
+      xacc::error("[" + backend + "] Qubit " + std::to_string(gate.bit[i]) +
+                  " of register " + tape.registers()[gate.reg[i]] +
+                  " is out of range.");
+    }
+  }
+  if (quantum::gate_n_qubits(gate.op) == 2 && l[0] == l[1]) {
+    xacc::error("[" + backend + "] " + quantum::gate_name(gate.op) +
+                " acts twice on qubit " + std::to_string(gate.bit[0]) +
+                " of register " + tape.registers()[gate.reg[0]]);
+  }
+  return l;
+}
+
+ShotCounter::ShotCounter(const std::vector<std::size_t> &measured,
+                         xacc::AcceleratorBuffer **buffers,
+                         const int nBuffers)
+    : m_owner(measured.size(), 0), m_slot(measured.size(), 0) {
+  std::vector<std::size_t> offsets(nBuffers, 0), n_bits(nBuffers, 0);
+  for (int b = 1; b < nBuffers; b++) {
+    offsets[b] = offsets[b - 1] + buffers[b - 1]->size();
+  }
+  for (std::size_t m = 0; m < measured.size(); m++) {
+    for (int b = 0; b < nBuffers; b++) {
+      if (measured[m] >= offsets[b] &&
+          measured[m] < offsets[b] + buffers[b]->size()) {
+        m_owner[m] = b;
+      }
+    }
+    m_slot[m] = n_bits[m_owner[m]]++;
+  }
+  for (int b = 0; b < nBuffers; b++) {
+    m_histograms.emplace_back(n_bits[b]);
+    m_keys.emplace_back(m_histograms.back().n_words(), 0);
+  }
+}
+
+void ShotCounter::record(xacc::AcceleratorBuffer **buffers,
+                         const int nBuffers, const bool packed) const {
+  for (int b = 0; b < nBuffers; b++) {
+    const auto &histogram = m_histograms[b];
+    if (histogram.empty()) {
+      continue;
+    }
+    if (packed) {
+      histogram.append_to(buffers[b]);
+      buffers[b]->addExtraInfo("exp-val-z", histogram.expectation_z());
+      continue;
+    }
+    // Bitstrings are only built per distinct outcome
+    for (std::size_t i = 0; i < histogram.size(); i++) {
+      buffers[b]->appendMeasurement(histogram.bitstring(i),
+                                    histogram.count(i));
+    }
+  }
+}
+
+} // namespace simulators
+} // namespace qcor
@@ -0,0 +1,78 @@
+#ifndef RUNTIME_SIMULATORS_TAPE_UTILS_HPP_
+#define RUNTIME_SIMULATORS_TAPE_UTILS_HPP_
+
+#include "gate_tape.hpp"
+#include "qcor_histogram.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace xacc {
+class AcceleratorBuffer;
+}
+
+// Helpers shared by the in-process simulators for running a QRT gate tape
+// on a set of buffers. Qubits are flattened to logical indices, register
+// offset + index, with registers laid out in buffer order.
+namespace qcor {
+namespace simulators {
+
+// Number of qubits the tape needs when run on the given buffers
+std::size_t flat_size(const quantum::GateTape &tape,
+                      xacc::AcceleratorBuffer **buffers, const int nBuffers);
+
+// Flat logical qubit indices of a gate. Errors, prefixed with the
+// backend name, if a qubit is out of range or a two qubit gate acts twice
+// on the same qubit.
+std::array<std::size_t, 2>
+logical_qubits(const quantum::GateTape &tape, const quantum::TapeGate &gate,
+               const std::vector<std::size_t> &offsets,
+               const std::size_t n_qubits, const std::string &backend);
+
+// Per-buffer histograms of sampled outcomes. Bit j of a key for buffer b
+// is the j-th measured qubit (in order of first measurement) that belongs
+// to b, the j-th character of its bitstring.
+class ShotCounter {
+public:
+  ShotCounter(const std::vector<std::size_t> &measured,
+              xacc::AcceleratorBuffer **buffers, const int nBuffers);
+
+  // Count an outcome, bit(m) being the result of measured qubit m
+  template <typename Bit>
+  void add(const Bit &bit, const std::size_t count = 1) {
+    for (auto &key : m_keys) {
+      std::fill(key.begin(), key.end(), 0);
+    }
+    for (std::size_t m = 0; m < m_owner.size(); m++) {
+      if (bit(m)) {
+        m_keys[m_owner[m]][m_slot[m] / Histogram::bits_per_word] |=
+            Histogram::word_t(1) << (m_slot[m] % Histogram::bits_per_word);
+      }
+    }
+    for (std::size_t b = 0; b < m_histograms.size(); b++) {
+      if (m_histograms[b].n_bits() > 0) {
+        m_histograms[b].add(m_keys[b].data(), count);
+      }
+    }
+  }
+
+  // Append the counts to the buffers. If packed, as Histograms (see
+  // Histogram::append_to) along with their exp-val-z, otherwise as
+  // bitstring measurements.
+  void record(xacc::AcceleratorBuffer **buffers, const int nBuffers,
+              const bool packed) const;
+
+private:
+  // Buffer of each measured qubit and its bit within the buffer's key
+  std::vector<int> m_owner;
+  std::vector<std::size_t> m_slot;
+  std::vector<Histogram> m_histograms;
+  std::vector<std::vector<Histogram::word_t>> m_keys;
+};
+
+} // namespace simulators
+} // namespace qcor
+
+#endif
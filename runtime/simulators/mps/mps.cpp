@@ -0,0 +1,282 @@
+#include "mps.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace qcor {
+namespace mps {
+namespace {
+using RowVector = Eigen::RowVectorXcd;
+
+// Row major 4x4 SWAP in the basis |s_k s_{k+1}>
+const amplitude_t swap_matrix[16] = {1, 0, 0, 0, 0, 0, 1, 0,
+                                     0, 1, 0, 0, 0, 0, 0, 1};
+} // namespace
+
+MatrixProductState::MatrixProductState(const std::size_t n_qubits,
+                                       const std::size_t max_bond,
+                                       const double cutoff)
+    : m_sites(n_qubits), m_site_of(n_qubits), m_qubit_at(n_qubits),
+      m_max_bond(std::max<std::size_t>(max_bond, 1)), m_cutoff(cutoff) {
+  for (std::size_t k = 0; k < n_qubits; k++) {
+    m_sites[k].a[0] = Matrix::Ones(1, 1);
+    m_sites[k].a[1] = Matrix::Zero(1, 1);
+    m_site_of[k] = m_qubit_at[k] = k;
+  }
+}
+
+void MatrixProductState::move_center(const std::size_t k) {
+  while (m_center < k) {
+    // Left isometry from the QR of [A[0]; A[1]], R moves right
+    auto &site = m_sites[m_center], &next = m_sites[m_center + 1];
+    const auto chi_l = site.a[0].rows(), chi_r = site.a[0].cols();
+    Matrix stacked(2 * chi_l, chi_r);
+    stacked << site.a[0], site.a[1];
+    Eigen::HouseholderQR<Matrix> qr(stacked);
+    const auto r = std::min(stacked.rows(), stacked.cols());
+    const Matrix q = qr.householderQ() * Matrix::Identity(2 * chi_l, r);
+    const Matrix upper =
+        qr.matrixQR().topRows(r).triangularView<Eigen::Upper>();
+    site.a[0] = q.topRows(chi_l);
+    site.a[1] = q.bottomRows(chi_l);
+    for (auto &a : next.a) {
+      a = upper * a;
+    }
+    m_center++;
+  }
+  while (m_center > k) {
+    // Right isometry from the LQ of [A[0] A[1]], L moves left
+    auto &site = m_sites[m_center], &prev = m_sites[m_center - 1];
+    const auto chi_l = site.a[0].rows(), chi_r = site.a[0].cols();
+    Matrix side(chi_l, 2 * chi_r);
+    side << site.a[0], site.a[1];
+    Eigen::HouseholderQR<Matrix> qr(side.adjoint());
+    const auto r = std::min(side.rows(), side.cols());
+    const Matrix q = qr.householderQ() * Matrix::Identity(2 * chi_r, r);
+    const Matrix lower =
+        qr.matrixQR().topRows(r).triangularView<Eigen::Upper>().adjoint();
+    site.a[0] = q.topRows(chi_r).adjoint();
+    site.a[1] = q.bottomRows(chi_r).adjoint();
+    for (auto &a : prev.a) {
+      a = a * lower;
+    }
+    m_center--;
+  }
+}
+
+void MatrixProductState::apply_two_site(const std::size_t k,
+                                        const amplitude_t *u) {
+  move_center(k);
+  auto &left = m_sites[k], &right = m_sites[k + 1];
+  const auto chi_l = left.a[0].rows(), chi_r = right.a[0].cols();
+
+  // theta[s1][s2] = A_k[s1] A_{k+1}[s2], with the gate applied, as one
+  // (2 chi_l) x (2 chi_r) matrix
+  Matrix theta[2][2];
+  for (int t1 = 0; t1 < 2; t1++) {
+    for (int t2 = 0; t2 < 2; t2++) {
+      theta[t1][t2] = left.a[t1] * right.a[t2];
+    }
+  }
+  Matrix m = Matrix::Zero(2 * chi_l, 2 * chi_r);
+  for (int s = 0; s < 4; s++) {
+    auto block = m.block((s / 2) * chi_l, (s % 2) * chi_r, chi_l, chi_r);
+    for (int t = 0; t < 4; t++) {
+      if (u[4 * s + t] != 0.0) {
+        block += u[4 * s + t] * theta[t / 2][t % 2];
+      }
+    }
+  }
+
+  Eigen::BDCSVD<Matrix> svd(m, Eigen::ComputeThinU | Eigen::ComputeThinV);
+  const auto &values = svd.singularValues();
+  const double total = values.squaredNorm();
+  std::size_t keep = 1;
+  while (keep < (std::size_t)values.size() && keep < m_max_bond &&
+         values(keep) * values(keep) > m_cutoff * total) {
+    keep++;
+  }
+  const double kept = values.head(keep).squaredNorm();
+  m_truncation_error += (total - kept) / total;
+  m_max_bond_used = std::max(m_max_bond_used, keep);
+
+  // Left isometry on site k, the renormalized S V^dagger on k + 1
+  const Matrix &uk = svd.matrixU();
+  const Matrix sv = (values.head(keep) / std::sqrt(kept))
+                        .cast<amplitude_t>()
+                        .asDiagonal() *
+                    svd.matrixV().leftCols(keep).adjoint();
+  for (int s = 0; s < 2; s++) {
+    left.a[s] = uk.block(s * chi_l, 0, chi_l, keep);
+    right.a[s] = sv.block(0, s * chi_r, keep, chi_r);
+  }
+  m_center = k + 1;
+}
+
+void MatrixProductState::swap_sites(const std::size_t k) {
+  apply_two_site(k, swap_matrix);
+  std::swap(m_qubit_at[k], m_qubit_at[k + 1]);
+  m_site_of[m_qubit_at[k]] = k;
+  m_site_of[m_qubit_at[k + 1]] = k + 1;
+}
+
+void MatrixProductState::apply(const quantum::GateOp op,
+                               const std::size_t *qubits,
+                               const double *params) {
+  using quantum::GateOp;
+  if (op == GateOp::I || op == GateOp::Measure) {
+    return;
+  }
+  if (op == GateOp::Swap) {
+    // Relabel only, the qubits trade sites
+    std::swap(m_site_of[qubits[0]], m_site_of[qubits[1]]);
+    m_qubit_at[m_site_of[qubits[0]]] = qubits[0];
+    m_qubit_at[m_site_of[qubits[1]]] = qubits[1];
+    return;
+  }
+
+  amplitude_t m[4];
+  quantum::gate_matrix(op, params, m);
+  if (quantum::gate_n_qubits(op) == 1) {
+    auto &site = m_sites[m_site_of[qubits[0]]];
+    const Matrix a0 = site.a[0];
+    site.a[0] = m[0] * a0 + m[1] * site.a[1];
+    site.a[1] = m[2] * a0 + m[3] * site.a[1];
+    return;
+  }
+
+  // Swap the control along the chain until it neighbours the target
+  auto control = m_site_of[qubits[0]];
+  const auto target = m_site_of[qubits[1]];
+  while (control + 1 < target) {
+    swap_sites(control++);
+  }
+  while (control > target + 1) {
+    swap_sites(--control);
+  }
+
+  // m on the target where the control is 1, basis |s_k s_{k+1}>
+  amplitude_t u[16] = {};
+  for (int s = 0; s < 4; s++) {
+    const int c = control < target ? s / 2 : s % 2;
+    const int t = control < target ? s % 2 : s / 2;
+    for (int r = 0; r < 4; r++) {
+      const int rc = control < target ? r / 2 : r % 2;
+      const int rt = control < target ? r % 2 : r / 2;
+      if (c != rc) {
+        continue;
+      }
+      u[4 * s + r] = c ? m[2 * t + rt] : amplitude_t(t == rt);
+    }
+  }
+  apply_two_site(std::min(control, target), u);
+}
+
+int MatrixProductState::measure(const std::size_t q, const double r) {
+  const auto k = m_site_of[q];
+  move_center(k);
+  auto &site = m_sites[k];
+  const double n0 = site.a[0].squaredNorm(), n1 = site.a[1].squaredNorm();
+  const int outcome = r < n1 / (n0 + n1) ? 1 : 0;
+  site.a[1 - outcome].setZero();
+  site.a[outcome] /= std::sqrt(outcome ? n1 : n0);
+  return outcome;
+}
+
+double
+MatrixProductState::expectation(const std::vector<PauliFactor> &factors)
+    const {
+  // Pauli on each site in the contracted range, 0 for the identity
+  std::vector<std::pair<std::size_t, const PauliFactor *>> by_site;
+  for (auto &f : factors) {
+    if (f.x || f.z) {
+      by_site.push_back({m_site_of[f.qubit], &f});
+    }
+  }
+  if (by_site.empty()) {
+    return 1.0;
+  }
+  std::sort(by_site.begin(), by_site.end());
+  const auto lo = std::min(by_site.front().first, m_center);
+  const auto hi = std::max(by_site.back().first, m_center);
+
+  // Left of lo and right of hi the isometries contract to the identity
+  Matrix env = Matrix::Identity(m_sites[lo].a[0].rows(),
+                                m_sites[lo].a[0].rows());
+  auto next = by_site.begin();
+  for (auto k = lo; k <= hi; k++) {
+    const auto &a = m_sites[k].a;
+    const Matrix e0 = env * a[0], e1 = env * a[1];
+    if (next == by_site.end() || next->first != k) {
+      env = a[0].adjoint() * e0 + a[1].adjoint() * e1;
+      continue;
+    }
+    const auto &f = *(next++)->second;
+    if (!f.x) {
+      env = a[0].adjoint() * e0 - a[1].adjoint() * e1;
+    } else if (!f.z) {
+      env = a[0].adjoint() * e1 + a[1].adjoint() * e0;
+    } else {
+      const amplitude_t i_unit(0.0, 1.0);
+      env = i_unit * (a[1].adjoint() * e0 - a[0].adjoint() * e1);
+    }
+  }
+  return env.trace().real();
+}
+
+amplitude_t MatrixProductState::amplitude(const std::uint64_t index) const {
+  RowVector v = RowVector::Ones(1);
+  for (std::size_t k = 0; k < m_sites.size(); k++) {
+    v = v * m_sites[k].a[index >> m_qubit_at[k] & 1];
+  }
+  return v(0);
+}
+
+std::vector<std::uint8_t>
+MatrixProductState::sample(const std::vector<std::size_t> &qubits,
+                           const std::size_t shots, std::mt19937_64 &rng) {
+  std::vector<std::uint8_t> outcomes(shots * qubits.size());
+  if (qubits.empty()) {
+    return outcomes;
+  }
+  // With every site right of 0 a right isometry, the marginal of each
+  // site given the ones left of it only needs the sites up to it
+  move_center(0);
+  std::size_t last = 0;
+  for (auto q : qubits) {
+    last = std::max(last, m_site_of[q]);
+  }
+
+  // Blocks of shots draw from their own generator, seeded from rng, so
+  // the outcomes do not depend on thread order and the uniforms are
+  // drawn as they are used
+  const std::size_t block = 64;
+  const std::int64_t n_blocks = (shots + block - 1) / block;
+  std::vector<std::uint64_t> seeds(n_blocks);
+  for (auto &seed : seeds) {
+    seed = rng();
+  }
+#pragma omp parallel for schedule(dynamic)
+  for (std::int64_t b = 0; b < n_blocks; b++) {
+    std::mt19937_64 block_rng(seeds[b]);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<std::uint8_t> bits(last + 1);
+    const auto end = std::min(shots, (b + 1) * block);
+    for (std::size_t shot = b * block; shot < end; shot++) {
+      RowVector v = RowVector::Ones(1);
+      for (std::size_t k = 0; k <= last; k++) {
+        const RowVector w0 = v * m_sites[k].a[0], w1 = v * m_sites[k].a[1];
+        const double n0 = w0.squaredNorm(), n1 = w1.squaredNorm();
+        bits[k] = uniform(block_rng) < n1 / (n0 + n1);
+        v = bits[k] ? w1 / std::sqrt(n1) : w0 / std::sqrt(n0);
+      }
+      for (std::size_t m = 0; m < qubits.size(); m++) {
+        outcomes[shot * qubits.size() + m] = bits[m_site_of[qubits[m]]];
+      }
+    }
+  }
+  return outcomes;
+}
+
+} // namespace mps
+} // namespace qcor
@@ -0,0 +1,94 @@
+#ifndef RUNTIME_SIMULATORS_MPS_HPP_
+#define RUNTIME_SIMULATORS_MPS_HPP_
+
+#include "gate_tape.hpp"
+
+#include <Eigen/Dense>
+#include <complex>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace qcor {
+namespace mps {
+
+using amplitude_t = std::complex<double>;
+using Matrix = Eigen::MatrixXcd;
+
+// One factor of a Pauli string: X, Y (both set) or Z on a qubit
+struct PauliFactor {
+  std::size_t qubit;
+  bool x, z;
+};
+
+// Matrix product state of n qubits, initialized to |0...0>. Site k holds
+// two matrices A_k[s] (left bond x right bond), one per value s of its
+// qubit, and an amplitude is the product A_0[s_0] ... A_{n-1}[s_{n-1}].
+//
+// The state is kept in mixed canonical form around a center site: sites
+// left of it are left isometries, sites right of it right isometries.
+// Two qubit gates are applied to neighbouring sites by contracting them,
+// applying the 4x4 gate and splitting them again with an SVD that keeps
+// at most max_bond singular values and drops those carrying less than
+// cutoff of the weight. Because the split happens at the center, this
+// truncation is optimal in the 2-norm.
+//
+// Qubits are not pinned to sites. A gate on qubits at distant sites
+// first swaps one of them along the chain until they are neighbours, and
+// the qubit stays at its new site, so gates repeated on the same pairs
+// (as in QAOA layers) do not pay for the route back.
+class MatrixProductState {
+public:
+  MatrixProductState(const std::size_t n_qubits, const std::size_t max_bond,
+                     const double cutoff);
+
+  std::size_t n_qubits() const { return m_sites.size(); }
+  // Largest bond dimension the state has had
+  std::size_t max_bond_used() const { return m_max_bond_used; }
+  // Sum of the discarded weights of all truncations, an upper bound on
+  // 1 - |<exact|this>|^2 to first order
+  double truncation_error() const { return m_truncation_error; }
+
+  // Apply a gate other than Measure. For two qubit gates qubits[0] is the
+  // control.
+  void apply(const quantum::GateOp op, const std::size_t *qubits,
+             const double *params);
+  // Measure qubit q, collapsing the state. r is uniform in [0, 1).
+  int measure(const std::size_t q, const double r);
+
+  // <P> for the Pauli string with the given factors, on distinct qubits.
+  // Only the sites between the factors and the center are contracted.
+  double expectation(const std::vector<PauliFactor> &factors) const;
+  // Amplitude of the basis state with qubit q set to bit q of index
+  amplitude_t amplitude(const std::uint64_t index) const;
+
+  // Draw shots samples of the given qubits from the current state, without
+  // collapsing it. Entry shot * qubits.size() + m is the outcome of
+  // qubits[m] in that shot.
+  std::vector<std::uint8_t> sample(const std::vector<std::size_t> &qubits,
+                                   const std::size_t shots,
+                                   std::mt19937_64 &rng);
+
+protected:
+  struct Site {
+    Matrix a[2];
+  };
+  std::vector<Site> m_sites;
+  // Site of each qubit, and the qubit at each site
+  std::vector<std::size_t> m_site_of, m_qubit_at;
+  std::size_t m_center = 0;
+  std::size_t m_max_bond, m_max_bond_used = 1;
+  double m_cutoff, m_truncation_error = 0.0;
+
+  // Move the center to site k with QR sweeps
+  void move_center(const std::size_t k);
+  // Apply the 4x4 gate u (row major, basis |s_k s_{k+1}>) to sites k, k+1
+  void apply_two_site(const std::size_t k, const amplitude_t *u);
+  // Exchange the qubits at sites k and k + 1
+  void swap_sites(const std::size_t k);
+};
+
+} // namespace mps
+} // namespace qcor
+
+#endif
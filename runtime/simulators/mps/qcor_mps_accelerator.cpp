@@ -0,0 +1,231 @@
+#include "qcor_mps_accelerator.hpp"
+#include "tape_utils.hpp"
+
+#include "AcceleratorBuffer.hpp"
+#include "CompositeInstruction.hpp"
+#include "xacc.hpp"
+
+#include "cppmicroservices/BundleActivator.h"
+#include "cppmicroservices/BundleContext.h"
+#include "cppmicroservices/ServiceProperties.h"
+
+using namespace cppmicroservices;
+using namespace qcor::simulators;
+
+namespace qcor {
+namespace {
+// Z on every measured qubit
+std::vector<mps::PauliFactor>
+z_string(const std::vector<std::size_t> &qubits) {
+  std::vector<mps::PauliFactor> factors;
+  for (auto q : qubits) {
+    factors.push_back({q, false, true});
+  }
+  return factors;
+}
+
+void record_bond(xacc::AcceleratorBuffer *buffer,
+                 const mps::MatrixProductState &state) {
+  buffer->addExtraInfo("mps-max-bond", (int)state.max_bond_used());
+  buffer->addExtraInfo("mps-truncation-error", state.truncation_error());
+}
+} // namespace
+
+void MPSAccelerator::initialize(const xacc::HeterogeneousMap &params) {
+  updateConfiguration(params);
+}
+
+void MPSAccelerator::updateConfiguration(
+    const xacc::HeterogeneousMap &config) {
+  if (config.keyExists<int>("shots")) {
+    m_shots = config.get<int>("shots");
+  }
+  if (config.keyExists<int>("seed")) {
+    m_rng.seed(config.get<int>("seed"));
+  }
+  if (config.keyExists<int>("max-bond")) {
+    m_max_bond = config.get<int>("max-bond");
+    if (m_max_bond < 1) {
+      xacc::error("[qcor-mps] max-bond must be at least 1.");
+    }
+  }
+  if (config.keyExists<double>("svd-cutoff")) {
+    m_cutoff = config.get<double>("svd-cutoff");
+  }
+  if (config.keyExists<bool>("packed-counts")) {
+    m_packed_counts = config.get<bool>("packed-counts");
+  }
+}
+
+xacc::HeterogeneousMap MPSAccelerator::getProperties() {
+  xacc::HeterogeneousMap props;
+  props.insert("shots", m_shots);
+  props.insert("max-bond", m_max_bond);
+  props.insert("svd-cutoff", m_cutoff);
+  props.insert("packed-counts", m_packed_counts);
+  return props;
+}
+
+MPSProgram MPSAccelerator::lower(const quantum::GateTape &tape,
+                                 xacc::AcceleratorBuffer **buffers,
+                                 const int nBuffers) {
+  MPSProgram p;
+  const auto offsets = tape.register_offsets(buffers, nBuffers);
+  p.n_qubits = flat_size(tape, buffers, nBuffers);
+  p.gates.reserve(tape.size());
+  std::vector<bool> seen_measure(p.n_qubits, false);
+  for (auto &gate : tape.gates()) {
+    const auto l =
+        logical_qubits(tape, gate, offsets, p.n_qubits, "qcor-mps");
+    for (int i = 0; i < quantum::gate_n_qubits(gate.op); i++) {
+      if (gate.op != quantum::GateOp::Measure && seen_measure[l[i]]) {
+        p.terminal = false;
+      }
+    }
+    if (gate.op == quantum::GateOp::Measure && !seen_measure[l[0]]) {
+      seen_measure[l[0]] = true;
+      p.measured.push_back(l[0]);
+    }
+    p.gates.push_back({gate.op, l, gate.params});
+  }
+  return p;
+}
+
+void MPSAccelerator::run(mps::MatrixProductState &state,
+                         const MPSProgram &program, std::vector<int> *bits) {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  for (auto &gate : program.gates) {
+    if (gate.op != quantum::GateOp::Measure) {
+      state.apply(gate.op, gate.qubits.data(), gate.params);
+    } else if (bits) {
+      (*bits)[gate.qubits[0]] = state.measure(gate.qubits[0], uniform(m_rng));
+    }
+  }
+}
+
+void MPSAccelerator::execute(xacc::AcceleratorBuffer **buffers,
+                             const int nBuffers,
+                             const quantum::GateTape &tape) {
+  auto p = lower(tape, buffers, nBuffers);
+  auto fresh_state = [&]() {
+    return mps::MatrixProductState(p.n_qubits, m_max_bond, m_cutoff);
+  };
+
+  if (m_shots <= 0 || p.measured.empty()) {
+    auto state = fresh_state();
+    run(state, p, nullptr);
+    if (!p.measured.empty()) {
+      buffers[0]->addExtraInfo("exp-val-z",
+                               state.expectation(z_string(p.measured)));
+    }
+    record_bond(buffers[0], state);
+    return;
+  }
+
+  ShotCounter counter(p.measured, buffers, nBuffers);
+  if (p.terminal) {
+    // Simulate once, then sample every shot from the final state
+    auto state = fresh_state();
+    run(state, p, nullptr);
+    const auto n = p.measured.size();
+    const auto samples = state.sample(p.measured, m_shots, m_rng);
+    for (int shot = 0; shot < m_shots; shot++) {
+      counter.add([&](std::size_t m) { return samples[shot * n + m]; });
+    }
+    record_bond(buffers[0], state);
+  } else {
+    // Mid-circuit measurements, re-simulate each shot
+    std::vector<int> bits(p.n_qubits, 0);
+    for (int shot = 0; shot < m_shots; shot++) {
+      auto state = fresh_state();
+      run(state, p, &bits);
+      counter.add([&](std::size_t m) { return bits[p.measured[m]]; });
+      if (shot == m_shots - 1) {
+        record_bond(buffers[0], state);
+      }
+    }
+  }
+  counter.record(buffers, nBuffers, m_packed_counts);
+}
+
+std::vector<double> MPSAccelerator::pauli_expectations(
+    xacc::AcceleratorBuffer *buffer,
+    std::shared_ptr<xacc::CompositeInstruction> program, const PauliSum &obs) {
+  quantum::GateTape tape;
+  tape.add(program, buffer->name());
+  auto p = lower(tape, &buffer, 1);
+  mps::MatrixProductState state(p.n_qubits, m_max_bond, m_cutoff);
+  run(state, p, nullptr);
+  record_bond(buffer, state);
+
+  // Qubits beyond the state are in |0>, so Z on them is +1 and X or Y
+  // gives <P> = 0
+  std::vector<double> exp_vals(obs.n_terms(), 0.0);
+  for (std::size_t t = 0; t < obs.n_terms(); t++) {
+    const auto x_words = obs.x_mask(t), z_words = obs.z_mask(t);
+    std::vector<mps::PauliFactor> factors;
+    bool vanishes = false;
+    for (std::size_t w = 0; w < obs.n_words(); w++) {
+      for (auto bits = x_words[w] | z_words[w]; bits; bits &= bits - 1) {
+        const auto b = __builtin_ctzll(bits);
+        const std::size_t q = w * PauliSum::bits_per_word + b;
+        const bool has_x = x_words[w] >> b & 1, has_z = z_words[w] >> b & 1;
+        if (q >= p.n_qubits) {
+          vanishes = vanishes || has_x;
+          continue;
+        }
+        factors.push_back({q, has_x, has_z});
+      }
+    }
+    exp_vals[t] = vanishes ? 0.0 : state.expectation(factors);
+  }
+  return exp_vals;
+}
+
+void MPSAccelerator::execute(
+    std::shared_ptr<xacc::AcceleratorBuffer> buffer,
+    const std::shared_ptr<xacc::CompositeInstruction> compositeInstruction) {
+  quantum::GateTape tape;
+  tape.add(compositeInstruction, buffer->name());
+  auto raw = buffer.get();
+  execute(&raw, 1, tape);
+}
+
+void MPSAccelerator::execute(
+    std::shared_ptr<xacc::AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<xacc::CompositeInstruction>>
+        compositeInstructions) {
+  for (auto &program : compositeInstructions) {
+    auto child = std::make_shared<xacc::AcceleratorBuffer>(program->name(),
+                                                           buffer->size());
+    execute(child, program);
+    buffer->appendChild(program->name(), child);
+  }
+}
+
+} // namespace qcor
+
+namespace {
+
+/**
+ */
+class US_ABI_LOCAL MPSAcceleratorActivator : public BundleActivator {
+
+public:
+  MPSAcceleratorActivator() {}
+
+  /**
+   */
+  void Start(BundleContext context) {
+    auto acc = std::make_shared<qcor::MPSAccelerator>();
+    context.RegisterService<xacc::Accelerator>(acc);
+  }
+
+  /**
+   */
+  void Stop(BundleContext /*context*/) {}
+};
+
+} // namespace
+
+CPPMICROSERVICES_EXPORT_BUNDLE_ACTIVATOR(MPSAcceleratorActivator)
@@ -0,0 +1,103 @@
+#ifndef RUNTIME_SIMULATORS_QCOR_MPS_ACCELERATOR_HPP_
+#define RUNTIME_SIMULATORS_QCOR_MPS_ACCELERATOR_HPP_
+
+#include "Accelerator.hpp"
+#include "gate_tape.hpp"
+#include "mps.hpp"
+#include "qcor_expectation.hpp"
+
+#include <array>
+#include <random>
+
+namespace qcor {
+
+// The tape with qubits flattened to logical indices (register offset +
+// index), see simulators::logical_qubits
+struct MPSProgram {
+  struct Gate {
+    quantum::GateOp op;
+    std::array<std::size_t, 2> qubits;
+    const double *params;
+  };
+  std::size_t n_qubits = 0;
+  std::vector<Gate> gates;
+  // Logical qubits measured, in order of first measurement
+  std::vector<std::size_t> measured;
+  // True if no gate acts on a qubit after it has been measured
+  bool terminal = true;
+};
+
+// qcor-mps is an in-process matrix product state simulator (see
+// mps::MatrixProductState) for programs too wide for a state vector but
+// with modest entanglement, e.g. low depth QAOA on sparse graphs. Like
+// qcor-sv it executes the QRT gate tape directly.
+//
+// "max-bond" caps the bond dimension (default 64) and "svd-cutoff" drops
+// singular values below that fraction of the weight (default 1e-12).
+// After each execution the buffer records the largest bond reached as
+// mps-max-bond and the accumulated discarded weight as
+// mps-truncation-error; when the latter is not small, results are
+// approximate and max-bond should be raised.
+//
+// With shots <= 0 (the default) <Z...Z> over the measured qubits is
+// stored as exp-val-z, and qcor::observe() evaluates Pauli observables by
+// contracting the state (see ExactExpectation). With shots > 0, programs
+// whose measurements are all terminal are simulated once and every shot
+// is sampled from the final state, otherwise each shot is simulated with
+// collapse. As for qcor-sv, "packed-counts" stores the counts as packed
+// qcor::Histograms instead of bitstrings.
+class MPSAccelerator : public xacc::Accelerator,
+                       public quantum::TapeExecutor,
+                       public ExactExpectation {
+public:
+  void initialize(const xacc::HeterogeneousMap &params = {}) override;
+  void updateConfiguration(const xacc::HeterogeneousMap &config) override;
+  const std::vector<std::string> configurationKeys() override {
+    return {"shots", "seed", "max-bond", "svd-cutoff", "packed-counts"};
+  }
+  xacc::HeterogeneousMap getProperties() override;
+  const std::string getSignature() override { return name() + ":"; }
+  std::vector<std::pair<int, int>> getConnectivity() override { return {}; }
+
+  void execute(std::shared_ptr<xacc::AcceleratorBuffer> buffer,
+               const std::shared_ptr<xacc::CompositeInstruction>
+                   compositeInstruction) override;
+  void execute(std::shared_ptr<xacc::AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<xacc::CompositeInstruction>>
+                   compositeInstructions) override;
+
+  // quantum::TapeExecutor
+  void execute(xacc::AcceleratorBuffer **buffers, const int nBuffers,
+               const quantum::GateTape &tape) override;
+
+  // ExactExpectation
+  bool exact_expectations() override { return m_shots <= 0; }
+  std::vector<double>
+  pauli_expectations(xacc::AcceleratorBuffer *buffer,
+                     std::shared_ptr<xacc::CompositeInstruction> program,
+                     const PauliSum &obs) override;
+
+  const std::string name() const override { return "qcor-mps"; }
+  const std::string description() const override {
+    return "In-process matrix product state simulator executing the qcor "
+           "runtime gate tape.";
+  }
+
+protected:
+  int m_shots = -1;
+  int m_max_bond = 64;
+  double m_cutoff = 1e-12;
+  bool m_packed_counts = false;
+  std::mt19937_64 m_rng{std::random_device{}()};
+
+  MPSProgram lower(const quantum::GateTape &tape,
+                   xacc::AcceleratorBuffer **buffers, const int nBuffers);
+  // Apply the program to state. If bits is given, Measure collapses the
+  // state and records the outcome at bits[logical qubit].
+  void run(mps::MatrixProductState &state, const MPSProgram &program,
+           std::vector<int> *bits);
+};
+
+} // namespace qcor
+
+#endif
@@ -0,0 +1,198 @@
+#include "qcor_mps_accelerator.hpp"
+#include "xacc.hpp"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+
+using namespace quantum;
+using qcor::mps::MatrixProductState;
+using qcor::mps::PauliFactor;
+
+namespace {
+using amplitude_t = std::complex<double>;
+
+// Reference: apply the 2x2 matrix m to target, optionally controlled
+void reference_apply(std::vector<amplitude_t> &state, const unsigned target,
+                     const int control, const amplitude_t m[4]) {
+  for (std::size_t i = 0; i < state.size(); i++) {
+    if ((i >> target & 1) || (control >= 0 && !(i >> control & 1))) {
+      continue;
+    }
+    const auto j = i | (std::size_t(1) << target);
+    const auto a = state[i], b = state[j];
+    state[i] = m[0] * a + m[1] * b;
+    state[j] = m[2] * a + m[3] * b;
+  }
+}
+
+void reference_swap(std::vector<amplitude_t> &state, const unsigned a,
+                    const unsigned b) {
+  for (std::size_t i = 0; i < state.size(); i++) {
+    if ((i >> a & 1) && !(i >> b & 1)) {
+      std::swap(state[i], state[i ^ (std::size_t(1) << a) ^
+                                (std::size_t(1) << b)]);
+    }
+  }
+}
+
+// Random gates on distant qubits, applied to both mps and the reference
+void random_circuit(MatrixProductState &mps,
+                    std::vector<amplitude_t> *reference, const int n_gates,
+                    std::mt19937 &rng) {
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  const std::vector<GateOp> ops{GateOp::H,  GateOp::Y,    GateOp::T,
+                                GateOp::Rx, GateOp::U,    GateOp::CNOT,
+                                GateOp::CY, GateOp::CRZ,  GateOp::CPhase,
+                                GateOp::CH, GateOp::Swap, GateOp::Ry};
+  const auto n = mps.n_qubits();
+  for (int g = 0; g < n_gates; g++) {
+    const auto op = ops[rng() % ops.size()];
+    std::size_t qubits[2] = {rng() % n, 0};
+    qubits[1] = (qubits[0] + 1 + rng() % (n - 1)) % n;
+    const double params[3] = {angle(rng), angle(rng), angle(rng)};
+    mps.apply(op, qubits, params);
+    if (!reference) {
+      continue;
+    }
+    amplitude_t m[4];
+    if (!gate_matrix(op, params, m)) {
+      reference_swap(*reference, qubits[0], qubits[1]);
+    } else if (gate_n_qubits(op) == 1) {
+      reference_apply(*reference, qubits[0], -1, m);
+    } else {
+      reference_apply(*reference, qubits[1], qubits[0], m);
+    }
+  }
+}
+} // namespace
+
+TEST(MPSTester, checkAgainstDense) {
+  std::mt19937 rng(7);
+  const std::size_t n = 7;
+  MatrixProductState mps(n, 64, 1e-14);
+  std::vector<amplitude_t> expected(std::size_t(1) << n, 0.0);
+  expected[0] = 1.0;
+  random_circuit(mps, &expected, 200, rng);
+  EXPECT_NEAR(0.0, mps.truncation_error(), 1e-12);
+
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    EXPECT_NEAR(0.0, std::abs(expected[i] - mps.amplitude(i)), 1e-9);
+  }
+
+  // Random Pauli strings against <psi|P|psi> on the dense state
+  for (int t = 0; t < 30; t++) {
+    std::vector<PauliFactor> factors;
+    std::uint64_t x = 0, z = 0;
+    for (std::size_t q = 0; q < n; q++) {
+      const int kind = rng() % 4;
+      if (kind) {
+        factors.push_back({q, kind != 3, kind != 1});
+        x |= std::uint64_t(kind != 3) << q;
+        z |= std::uint64_t(kind != 1) << q;
+      }
+    }
+    amplitude_t exp_val = 0.0;
+    for (std::size_t i = 0; i < expected.size(); i++) {
+      // P|i> = i^|x&z| (-1)^|i&z| |i^x>
+      amplitude_t phase = __builtin_parityll(i & z) ? -1.0 : 1.0;
+      for (int k = 0; k < __builtin_popcountll(x & z); k++) {
+        phase *= amplitude_t(0.0, 1.0);
+      }
+      exp_val += std::conj(expected[i ^ x]) * phase * expected[i];
+    }
+    EXPECT_NEAR(exp_val.real(), mps.expectation(factors), 1e-9);
+  }
+}
+
+TEST(MPSTester, checkTruncation) {
+  std::mt19937 rng(3);
+  MatrixProductState mps(8, 2, 0.0);
+  random_circuit(mps, nullptr, 100, rng);
+  EXPECT_EQ(2, mps.max_bond_used());
+  EXPECT_GT(mps.truncation_error(), 0.0);
+
+  // Truncated, but still normalized
+  double norm = 0.0;
+  for (std::uint64_t i = 0; i < 256; i++) {
+    norm += std::norm(mps.amplitude(i));
+  }
+  EXPECT_NEAR(1.0, norm, 1e-9);
+}
+
+TEST(MPSTester, checkMeasure) {
+  // Bell pair on distant qubits 0 and 5, measuring one fixes the other
+  for (double r : {0.25, 0.75}) {
+    MatrixProductState mps(6, 8, 1e-12);
+    std::size_t q[2] = {0, 5};
+    mps.apply(GateOp::H, q, nullptr);
+    mps.apply(GateOp::CNOT, q, nullptr);
+    const int outcome = mps.measure(0, r);
+    EXPECT_EQ(r < 0.5 ? 1 : 0, outcome);
+    EXPECT_NEAR(outcome ? -1.0 : 1.0, mps.expectation({{5, false, true}}),
+                1e-12);
+  }
+}
+
+TEST(MPSTester, checkSample) {
+  // Bell pair on qubits 0 and 5, and qubit 2 with P(1) = sin^2(0.3)
+  MatrixProductState mps(6, 8, 1e-12);
+  std::size_t q[2] = {0, 5};
+  const double theta = 0.6;
+  mps.apply(GateOp::H, q, nullptr);
+  mps.apply(GateOp::CNOT, q, nullptr);
+  q[0] = 2;
+  mps.apply(GateOp::Ry, q, &theta);
+
+  const std::size_t shots = 10000;
+  std::mt19937_64 rng(11);
+  const auto samples = mps.sample({0, 2, 5}, shots, rng);
+  std::size_t ones = 0;
+  for (std::size_t shot = 0; shot < shots; shot++) {
+    EXPECT_EQ(samples[3 * shot], samples[3 * shot + 2]);
+    ones += samples[3 * shot + 1];
+  }
+  EXPECT_NEAR(std::pow(std::sin(0.3), 2), double(ones) / shots, 0.02);
+
+  // The same generator state gives the same shots
+  rng.seed(11);
+  EXPECT_EQ(samples, mps.sample({0, 2, 5}, shots, rng));
+}
+
+TEST(MPSTester, checkWideGHZ) {
+  // Well beyond a state vector, bond dimension 2 throughout
+  const std::size_t n = 80;
+  GateTape tape;
+  tape.add(GateOp::H, {"q", 0});
+  for (std::size_t i = 1; i < n; i++) {
+    tape.add(GateOp::CNOT, {"q", 0}, {"q", i});
+  }
+  for (std::size_t i = 0; i < n; i++) {
+    tape.add(GateOp::Measure, {"q", i});
+  }
+
+  qcor::MPSAccelerator acc;
+  acc.initialize({{"shots", 200}, {"seed", 5}});
+  auto buffer = xacc::qalloc(n);
+  auto raw = buffer.get();
+  acc.execute(&raw, 1, tape);
+  for (auto &[bitstring, count] : buffer->getMeasurementCounts()) {
+    EXPECT_TRUE(bitstring == std::string(n, '0') ||
+                bitstring == std::string(n, '1'));
+  }
+  EXPECT_EQ(2, buffer->getInformation("mps-max-bond").as<int>());
+
+  // Even parity, so <Z...Z> = 1
+  acc.updateConfiguration({{"shots", 0}});
+  auto exact = xacc::qalloc(n);
+  raw = exact.get();
+  acc.execute(&raw, 1, tape);
+  EXPECT_NEAR(1.0, exact->getExpectationValueZ(), 1e-9);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
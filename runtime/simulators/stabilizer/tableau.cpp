@@ -0,0 +1,272 @@
+#include "tableau.hpp"
+
+#include "xacc.hpp"
+
+#include <algorithm>
+
+namespace qcor {
+namespace stabilizer {
+namespace {
+inline std::size_t n_words(const std::size_t n_bits) {
+  return (n_bits + 63) / 64;
+}
+inline word_t bit(const std::size_t q) { return word_t(1) << (q % 64); }
+} // namespace
+
+Tableau::Tableau(const std::size_t n_qubits,
+                 const std::size_t max_measurements)
+    : m_n(n_qubits), m_max_measurements(max_measurements),
+      m_words(n_words(n_qubits)),
+      m_sign_words(n_words(max_measurements + 1)),
+      m_x((2 * n_qubits + 1) * m_words, 0),
+      m_z((2 * n_qubits + 1) * m_words, 0),
+      m_sign((2 * n_qubits + 1) * m_sign_words, 0) {
+  // |0...0>: destabilizers X_q, stabilizers Z_q
+  for (std::size_t q = 0; q < m_n; q++) {
+    x(q)[q / 64] |= bit(q);
+    z(m_n + q)[q / 64] |= bit(q);
+  }
+  m_outcomes.reserve(max_measurements);
+}
+
+void Tableau::clear_row(const std::size_t row) {
+  std::fill_n(x(row), m_words, 0);
+  std::fill_n(z(row), m_words, 0);
+  std::fill_n(sign(row), m_sign_words, 0);
+}
+
+void Tableau::copy_row(const std::size_t to, const std::size_t from) {
+  std::copy_n(x(from), m_words, x(to));
+  std::copy_n(z(from), m_words, z(to));
+  std::copy_n(sign(from), m_sign_words, sign(to));
+}
+
+void Tableau::row_multiply(const std::size_t h, const std::size_t i) {
+  auto xh = x(h), zh = z(h);
+  const auto xi = x(i), zi = z(i);
+  // Phase exponent (mod 4) of the product of the single-qubit Paulis,
+  // counted word-wise as (#factors giving +i) - (#factors giving -i)
+  int exponent = 0;
+  for (std::size_t w = 0; w < m_words; w++) {
+    const word_t y = xi[w] & zi[w], xo = xi[w] & ~zi[w],
+                 zo = ~xi[w] & zi[w];
+    const word_t plus = (y & zh[w] & ~xh[w]) | (xo & zh[w] & xh[w]) |
+                        (zo & xh[w] & ~zh[w]);
+    const word_t minus = (y & xh[w] & ~zh[w]) | (xo & zh[w] & ~xh[w]) |
+                         (zo & xh[w] & zh[w]);
+    exponent += __builtin_popcountll(plus) - __builtin_popcountll(minus);
+    xh[w] ^= xi[w];
+    zh[w] ^= zi[w];
+  }
+
+  // Destabilizer signs are never read
+  if (h < m_n) {
+    return;
+  }
+  auto sh = sign(h);
+  const auto si = sign(i);
+  for (std::size_t w = 0; w < m_sign_words; w++) {
+    sh[w] ^= si[w];
+  }
+  // Rows multiplied here commute, so the exponent is 0 or 2
+  if (((exponent % 4) + 4) % 4 == 2) {
+    sh[0] ^= 1;
+  }
+}
+
+void Tableau::h(const std::size_t q) {
+  const auto w = q / 64, b = bit(q);
+  for (std::size_t row = 0; row <= 2 * m_n; row++) {
+    auto &xw = x(row)[w], &zw = z(row)[w];
+    if (row >= m_n && (xw & b) && (zw & b)) {
+      sign(row)[0] ^= 1;
+    }
+    const auto xb = xw & b;
+    xw = (xw & ~b) | (zw & b);
+    zw = (zw & ~b) | xb;
+  }
+}
+
+void Tableau::s(const std::size_t q) {
+  const auto w = q / 64, b = bit(q);
+  for (std::size_t row = 0; row <= 2 * m_n; row++) {
+    auto &xw = x(row)[w], &zw = z(row)[w];
+    if (row >= m_n && (xw & b) && (zw & b)) {
+      sign(row)[0] ^= 1;
+    }
+    zw ^= xw & b;
+  }
+}
+
+void Tableau::sdg(const std::size_t q) {
+  const auto w = q / 64, b = bit(q);
+  for (std::size_t row = 0; row <= 2 * m_n; row++) {
+    auto &xw = x(row)[w], &zw = z(row)[w];
+    if (row >= m_n && (xw & b) && !(zw & b)) {
+      sign(row)[0] ^= 1;
+    }
+    zw ^= xw & b;
+  }
+}
+
+void Tableau::cnot(const std::size_t c, const std::size_t t) {
+  const auto cw = c / 64, cb = bit(c), tw = t / 64, tb = bit(t);
+  for (std::size_t row = 0; row <= 2 * m_n; row++) {
+    auto xr = x(row), zr = z(row);
+    const bool xc = xr[cw] & cb, zc = zr[cw] & cb;
+    const bool xt = xr[tw] & tb, zt = zr[tw] & tb;
+    if (row >= m_n && xc && zt && (xt == zc)) {
+      sign(row)[0] ^= 1;
+    }
+    if (xc) {
+      xr[tw] ^= tb;
+    }
+    if (zt) {
+      zr[cw] ^= cb;
+    }
+  }
+}
+
+void Tableau::pauli(const std::size_t q, const bool has_x, const bool has_z) {
+  const auto w = q / 64, b = bit(q);
+  for (std::size_t row = m_n; row <= 2 * m_n; row++) {
+    // Anticommutes with the row if exactly one of the factors does
+    const bool x_flips = has_x && (z(row)[w] & b);
+    const bool z_flips = has_z && (x(row)[w] & b);
+    if (x_flips != z_flips) {
+      sign(row)[0] ^= 1;
+    }
+  }
+}
+
+void Tableau::swap(const std::size_t a, const std::size_t b) {
+  const auto aw = a / 64, ab = bit(a), bw = b / 64, bb = bit(b);
+  for (std::size_t row = 0; row <= 2 * m_n; row++) {
+    for (auto m : {x(row), z(row)}) {
+      const bool va = m[aw] & ab, vb = m[bw] & bb;
+      if (va != vb) {
+        m[aw] ^= ab;
+        m[bw] ^= bb;
+      }
+    }
+  }
+}
+
+void Tableau::apply(const quantum::GateOp op, const std::size_t *qubits) {
+  using quantum::GateOp;
+  const auto q = qubits[0], t = qubits[1];
+  switch (op) {
+  case GateOp::I:
+    return;
+  case GateOp::H:
+    return h(q);
+  case GateOp::S:
+    return s(q);
+  case GateOp::Sdg:
+    return sdg(q);
+  case GateOp::X:
+    return pauli(q, true, false);
+  case GateOp::Y:
+    return pauli(q, true, true);
+  case GateOp::Z:
+    return pauli(q, false, true);
+  case GateOp::CNOT:
+    return cnot(q, t);
+  case GateOp::CZ:
+    h(t);
+    cnot(q, t);
+    return h(t);
+  case GateOp::CY:
+    sdg(t);
+    cnot(q, t);
+    return s(t);
+  case GateOp::Swap:
+    return swap(q, t);
+  default:
+    xacc::error("[stabilizer] " + quantum::gate_name(op) +
+                " is not a Clifford gate.");
+  }
+}
+
+std::size_t Tableau::measure(const std::size_t q) {
+  if (m_outcomes.size() == m_max_measurements) {
+    xacc::error("[stabilizer] More measurements than the tableau was "
+                "created for.");
+  }
+  std::vector<word_t> outcome(m_sign_words, 0);
+
+  // A stabilizer anticommuting with Z_q makes the outcome random
+  std::size_t p = m_n;
+  while (p < 2 * m_n && !x_bit(p, q)) {
+    p++;
+  }
+  if (p < 2 * m_n) {
+    for (std::size_t row = 0; row < 2 * m_n; row++) {
+      if (row != p && x_bit(row, q)) {
+        row_multiply(row, p);
+      }
+    }
+    copy_row(p - m_n, p);
+    clear_row(p);
+    z(p)[q / 64] |= bit(q);
+    // The new stabilizer is (-1)^v Z_q for a fresh variable v
+    const auto v = ++m_n_random;
+    sign(p)[v / 64] |= bit(v);
+    outcome[v / 64] |= bit(v);
+  } else {
+    // Deterministic, the outcome is the sign of the product of the
+    // stabilizers paired with destabilizers containing X_q
+    const auto scratch = 2 * m_n;
+    clear_row(scratch);
+    for (std::size_t row = 0; row < m_n; row++) {
+      if (x_bit(row, q)) {
+        row_multiply(scratch, row + m_n);
+      }
+    }
+    std::copy_n(sign(scratch), m_sign_words, outcome.begin());
+  }
+  m_outcomes.push_back(std::move(outcome));
+  return m_outcomes.size() - 1;
+}
+
+bool Tableau::parity(const std::vector<std::size_t> &outcomes,
+                     int &value) const {
+  std::vector<word_t> sum(m_sign_words, 0);
+  for (auto m : outcomes) {
+    for (std::size_t w = 0; w < m_sign_words; w++) {
+      sum[w] ^= m_outcomes[m][w];
+    }
+  }
+  value = sum[0] & 1;
+  sum[0] &= ~word_t(1);
+  return std::all_of(sum.begin(), sum.end(),
+                     [](const word_t w) { return w == 0; });
+}
+
+std::vector<std::vector<word_t>>
+Tableau::sample(const std::size_t shots, std::mt19937_64 &rng) const {
+  const auto shot_words = n_words(shots);
+  std::vector<std::vector<word_t>> samples(m_outcomes.size(),
+                                           std::vector<word_t>(shot_words));
+  // One random word per variable covers 64 shots
+  std::vector<word_t> variables(m_n_random + 1);
+  for (std::size_t sw = 0; sw < shot_words; sw++) {
+    variables[0] = ~word_t(0);
+    for (std::size_t v = 1; v <= m_n_random; v++) {
+      variables[v] = rng();
+    }
+    for (std::size_t m = 0; m < m_outcomes.size(); m++) {
+      word_t value = 0;
+      for (std::size_t w = 0; w < m_sign_words; w++) {
+        for (auto bits = m_outcomes[m][w]; bits; bits &= bits - 1) {
+          value ^= variables[w * 64 + __builtin_ctzll(bits)];
+        }
+      }
+      samples[m][sw] = value;
+    }
+  }
+  return samples;
+}
+
+} // namespace stabilizer
+} // namespace qcor
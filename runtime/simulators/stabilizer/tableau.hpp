@@ -0,0 +1,92 @@
+#ifndef RUNTIME_SIMULATORS_TABLEAU_HPP_
+#define RUNTIME_SIMULATORS_TABLEAU_HPP_
+
+#include "gate_tape.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace qcor {
+namespace stabilizer {
+
+using word_t = std::uint64_t;
+
+// Stabilizer tableau (Aaronson and Gottesman, "Improved simulation of
+// stabilizer circuits") for Clifford-only programs, polynomial in the
+// number of qubits.
+//
+// Rows 0..n-1 are destabilizers, n..2n-1 stabilizers and 2n a scratch
+// row. Each row is a Pauli string stored as bit-packed X and Z masks.
+//
+// Measurements are not sampled while the program is simulated. Instead
+// every random outcome becomes a fresh variable, and stabilizer signs are
+// kept as affine functions (bit 0 the constant, bit k + 1 variable k)
+// of those variables. Every outcome is then such a function too, so once
+// the program has been simulated any number of shots is drawn by
+// sampling the variables, 64 shots per word.
+class Tableau {
+public:
+  // max_measurements bounds the number of measure() calls
+  Tableau(const std::size_t n_qubits, const std::size_t max_measurements);
+
+  std::size_t n_qubits() const { return m_n; }
+
+  // Apply a Clifford gate (see quantum::gate_is_clifford) other than
+  // Measure. For two qubit gates qubits[0] is the control.
+  void apply(const quantum::GateOp op, const std::size_t *qubits);
+  // Measure qubit q in the Z basis and return the index of its outcome
+  std::size_t measure(const std::size_t q);
+
+  std::size_t n_measurements() const { return m_outcomes.size(); }
+  // Number of independent random outcome variables so far
+  std::size_t n_random() const { return m_n_random; }
+  // The affine function giving outcome m
+  const word_t *outcome(const std::size_t m) const {
+    return m_outcomes[m].data();
+  }
+  // True if the XOR of the given outcomes is deterministic, in which case
+  // value is set to it
+  bool parity(const std::vector<std::size_t> &outcomes, int &value) const;
+
+  // Draw shots samples of all outcomes. Returns one row per outcome
+  // holding the shots bit-packed, shot s in bit s % 64 of word s / 64.
+  std::vector<std::vector<word_t>> sample(const std::size_t shots,
+                                          std::mt19937_64 &rng) const;
+
+protected:
+  std::size_t m_n, m_max_measurements;
+  // Words per Pauli mask and per sign function
+  std::size_t m_words, m_sign_words;
+  std::size_t m_n_random = 0;
+  // (2n + 1) rows each
+  std::vector<word_t> m_x, m_z, m_sign;
+  std::vector<std::vector<word_t>> m_outcomes;
+
+  word_t *x(const std::size_t row) { return m_x.data() + row * m_words; }
+  word_t *z(const std::size_t row) { return m_z.data() + row * m_words; }
+  word_t *sign(const std::size_t row) {
+    return m_sign.data() + row * m_sign_words;
+  }
+  bool x_bit(const std::size_t row, const std::size_t q) const {
+    return m_x[row * m_words + q / 64] >> (q % 64) & 1;
+  }
+  void clear_row(const std::size_t row);
+  void copy_row(const std::size_t to, const std::size_t from);
+  // Row h <- row i * row h, tracking the sign only for stabilizer rows
+  void row_multiply(const std::size_t h, const std::size_t i);
+
+  // Single gates, as column operations over all rows
+  void h(const std::size_t q);
+  void s(const std::size_t q);
+  void sdg(const std::size_t q);
+  void cnot(const std::size_t c, const std::size_t t);
+  // Conjugate by X^has_x Z^has_z on q
+  void pauli(const std::size_t q, const bool has_x, const bool has_z);
+  void swap(const std::size_t a, const std::size_t b);
+};
+
+} // namespace stabilizer
+} // namespace qcor
+
+#endif
@@ -0,0 +1,120 @@
+#include "tableau.hpp"
+#include <gtest/gtest.h>
+
+using namespace quantum;
+using qcor::stabilizer::Tableau;
+
+namespace {
+bool sampled_bit(const std::vector<std::uint64_t> &sample,
+                 const std::size_t shot) {
+  return sample[shot / 64] >> (shot % 64) & 1;
+}
+} // namespace
+
+TEST(TableauTester, checkDeterministic) {
+  Tableau tableau(3, 3);
+  std::size_t q[2] = {0, 0};
+  tableau.apply(GateOp::X, q);
+  q[0] = 1;
+  tableau.apply(GateOp::H, q);
+  tableau.apply(GateOp::S, q);
+  tableau.apply(GateOp::S, q);
+  tableau.apply(GateOp::H, q);
+  // X on 2 via H Z H
+  q[0] = 2;
+  tableau.apply(GateOp::H, q);
+  tableau.apply(GateOp::Z, q);
+  tableau.apply(GateOp::H, q);
+
+  for (std::size_t i = 0; i < 3; i++) {
+    tableau.measure(i);
+  }
+  EXPECT_EQ(0, tableau.n_random());
+  for (std::size_t i = 0; i < 3; i++) {
+    int value = 0;
+    EXPECT_TRUE(tableau.parity({i}, value));
+    EXPECT_EQ(1, value);
+  }
+}
+
+TEST(TableauTester, checkGHZ) {
+  const std::size_t n = 1000, shots = 1000;
+  Tableau tableau(n, n);
+  std::size_t q[2] = {0, 0};
+  tableau.apply(GateOp::H, q);
+  for (std::size_t i = 1; i < n; i++) {
+    q[0] = i - 1;
+    q[1] = i;
+    tableau.apply(GateOp::CNOT, q);
+  }
+  for (std::size_t i = 0; i < n; i++) {
+    tableau.measure(i);
+  }
+  EXPECT_EQ(1, tableau.n_random());
+
+  std::mt19937_64 rng(42);
+  auto samples = tableau.sample(shots, rng);
+  int ones = 0;
+  for (std::size_t shot = 0; shot < shots; shot++) {
+    const bool first = sampled_bit(samples[0], shot);
+    for (std::size_t i = 1; i < n; i++) {
+      EXPECT_EQ(first, sampled_bit(samples[i], shot));
+    }
+    ones += first;
+  }
+  EXPECT_NEAR(0.5, (double)ones / shots, 0.1);
+}
+
+TEST(TableauTester, checkBellPhases) {
+  // (|01> - |10>) / sqrt(2): Z0 Z1 = -1, X0 X1 = -1
+  Tableau tableau(2, 2);
+  std::size_t q[2] = {0, 1};
+  tableau.apply(GateOp::H, q);
+  tableau.apply(GateOp::CNOT, q);
+  q[0] = 1;
+  tableau.apply(GateOp::X, q);
+  tableau.apply(GateOp::Z, q);
+
+  Tableau xx = tableau;
+  auto m0 = tableau.measure(0), m1 = tableau.measure(1);
+  int value = 0;
+  EXPECT_FALSE(tableau.parity({m0}, value));
+  EXPECT_TRUE(tableau.parity({m0, m1}, value));
+  EXPECT_EQ(1, value);
+
+  // Rotate to the X basis
+  for (std::size_t i = 0; i < 2; i++) {
+    q[0] = i;
+    xx.apply(GateOp::H, q);
+  }
+  m0 = xx.measure(0);
+  m1 = xx.measure(1);
+  EXPECT_TRUE(xx.parity({m0, m1}, value));
+  EXPECT_EQ(1, value);
+}
+
+TEST(TableauTester, checkMidCircuitMeasurement) {
+  // Measure a |+> qubit, then copy the outcome to a second qubit
+  Tableau tableau(2, 2);
+  std::size_t q[2] = {0, 1};
+  tableau.apply(GateOp::H, q);
+  auto m0 = tableau.measure(0);
+  tableau.apply(GateOp::CNOT, q);
+  auto m1 = tableau.measure(1);
+
+  int value = 0;
+  EXPECT_TRUE(tableau.parity({m0, m1}, value));
+  EXPECT_EQ(0, value);
+
+  std::mt19937_64 rng(7);
+  auto samples = tableau.sample(256, rng);
+  for (std::size_t shot = 0; shot < 256; shot++) {
+    EXPECT_EQ(sampled_bit(samples[m0], shot), sampled_bit(samples[m1], shot));
+  }
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  return ret;
+}
@@ -0,0 +1,161 @@
+#include "gate_fusion.hpp"
+
+#include <algorithm>
+
+namespace qcor {
+namespace sv {
+namespace {
+// Least work, in passes of a general single qubit gate, a block on k
+// qubits must replace to beat applying its gates one by one. A dense pass
+// on k qubits costs about 1, 2, 2, 2.5 and 4 of those for k = 1..5
+// (AVX-512, state beyond the last level cache).
+constexpr double min_fused_work[max_dense_qubits + 1] = {1.0, 2.0, 3.0,
+                                                         3.0, 4.0, 6.0};
+
+// The X and diagonal kernels move or touch half the data of a general one
+double gate_work(const GateBlock::Gate &gate) {
+  amplitude_t m[4];
+  if (gate.op == quantum::GateOp::X || gate.op == quantum::GateOp::CNOT ||
+      !quantum::gate_matrix(gate.op, gate.params, m)) {
+    return 0.5;
+  }
+  return m[1] == 0.0 && m[2] == 0.0 ? 0.5 : 1.0;
+}
+} // namespace
+
+bool GateBlock::worthwhile() const {
+  double work = 0.0;
+  for (auto &gate : gates) {
+    work += gate_work(gate);
+  }
+  return gates.size() > 1 && work >= min_fused_work[qubits.size()];
+}
+
+FusedGate GateBlock::fuse() const {
+  FusedGate fused{qubits, {}};
+  const std::size_t dim = std::size_t(1) << qubits.size();
+  fused.matrix.resize(dim * dim);
+
+  // Gates on the block's own qubit numbering
+  auto local = gates;
+  for (auto &gate : local) {
+    for (int i = 0; i < quantum::gate_n_qubits(gate.op); i++) {
+      gate.qubits[i] =
+          std::lower_bound(qubits.begin(), qubits.end(), gate.qubits[i]) -
+          qubits.begin();
+    }
+  }
+  // Column c is the block applied to the basis state |c>
+  std::vector<amplitude_t> column(dim);
+  for (std::size_t c = 0; c < dim; c++) {
+    std::fill(column.begin(), column.end(), 0.0);
+    column[c] = 1.0;
+    for (auto &gate : local) {
+      apply_gate(column.data(), dim, gate.op, gate.qubits, gate.params, false);
+    }
+    for (std::size_t r = 0; r < dim; r++) {
+      fused.matrix[r * dim + c] = column[r];
+    }
+  }
+  return fused;
+}
+
+GateFuser::GateFuser(const unsigned max_qubits)
+    : m_max_qubits(std::min(max_qubits, max_dense_qubits)) {}
+
+void GateFuser::add(const std::size_t index, const quantum::GateOp op,
+                    const unsigned *qubits, const double *params) {
+  const int n = quantum::gate_n_qubits(op);
+  for (int i = 0; i < n; i++) {
+    if (qubits[i] >= m_block_of.size()) {
+      m_block_of.resize(qubits[i] + 1, -1);
+    }
+  }
+
+  // Open blocks the gate touches, and the qubits they would have merged
+  std::vector<int> touched;
+  std::vector<unsigned> merged(qubits, qubits + n);
+  for (int i = 0; i < n; i++) {
+    const int b = m_block_of[qubits[i]];
+    if (b >= 0 && std::find(touched.begin(), touched.end(), b) ==
+                      touched.end()) {
+      touched.push_back(b);
+      merged.insert(merged.end(), m_open[b].qubits.begin(),
+                    m_open[b].qubits.end());
+    }
+  }
+  std::sort(merged.begin(), merged.end());
+  merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+
+  GateBlock block;
+  if (merged.size() > m_max_qubits) {
+    // Too wide together, the gate starts a block of its own
+    close(qubits, n);
+    block.qubits.assign(qubits, qubits + n);
+    std::sort(block.qubits.begin(), block.qubits.end());
+  } else {
+    // Touched blocks act on disjoint qubits, so they commute and can be
+    // concatenated in any order
+    std::sort(touched.begin(), touched.end());
+    for (auto b : touched) {
+      auto &open = m_open[b];
+      block.gates.insert(block.gates.end(), open.gates.begin(),
+                         open.gates.end());
+      block.indices.insert(block.indices.end(), open.indices.begin(),
+                           open.indices.end());
+    }
+    block.qubits = merged;
+    for (auto it = touched.rbegin(); it != touched.rend(); ++it) {
+      m_open.erase(m_open.begin() + *it);
+    }
+  }
+
+  GateBlock::Gate gate{op, {qubits[0], n == 2 ? qubits[1] : 0}, {}};
+  std::copy_n(params, quantum::gate_n_params(op), gate.params);
+  block.gates.push_back(gate);
+  block.indices.push_back(index);
+  m_open.push_back(std::move(block));
+
+  // Blocks after erased ones have moved down
+  std::fill(m_block_of.begin(), m_block_of.end(), -1);
+  for (std::size_t b = 0; b < m_open.size(); b++) {
+    for (auto q : m_open[b].qubits) {
+      m_block_of[q] = b;
+    }
+  }
+}
+
+void GateFuser::close(const unsigned *qubits, const int n_qubits) {
+  for (int i = 0; i < n_qubits; i++) {
+    if (qubits[i] < m_block_of.size() && m_block_of[qubits[i]] >= 0) {
+      close_block(m_block_of[qubits[i]]);
+    }
+  }
+}
+
+void GateFuser::close_all() {
+  while (!m_open.empty()) {
+    close_block(0);
+  }
+}
+
+void GateFuser::close_block(const int b) {
+  m_closed.push_back(std::move(m_open[b]));
+  m_open.erase(m_open.begin() + b);
+  for (auto &block_of : m_block_of) {
+    if (block_of == b) {
+      block_of = -1;
+    } else if (block_of > b) {
+      block_of--;
+    }
+  }
+}
+
+std::vector<GateBlock> GateFuser::take_closed() {
+  std::vector<GateBlock> closed;
+  std::swap(closed, m_closed);
+  return closed;
+}
+
+} // namespace sv
+} // namespace qcor
@@ -0,0 +1,69 @@
+#ifndef RUNTIME_SIMULATORS_GATE_FUSION_HPP_
+#define RUNTIME_SIMULATORS_GATE_FUSION_HPP_
+
+#include "state_vector.hpp"
+
+namespace qcor {
+namespace sv {
+
+// A run of gates multiplied into one dense unitary, applied with
+// apply_dense. Bit j of a row or column index of matrix is qubits[j].
+struct FusedGate {
+  std::vector<unsigned> qubits;
+  std::vector<amplitude_t> matrix;
+};
+
+// Gates collected by GateFuser, to be applied together
+struct GateBlock {
+  struct Gate {
+    quantum::GateOp op;
+    unsigned qubits[2];
+    double params[3];
+  };
+  // Qubits acted on, ascending
+  std::vector<unsigned> qubits;
+  std::vector<Gate> gates;
+  // Position of each gate in the program
+  std::vector<std::size_t> indices;
+
+  // True if the block replaces enough gates to pay for its dense pass,
+  // which costs several single gate passes for larger blocks
+  bool worthwhile() const;
+  // Product of the gates
+  FusedGate fuse() const;
+};
+
+// Groups the gates of a program into blocks on at most max_qubits qubits.
+// Several blocks are open at once on disjoint qubits, so gates on other
+// qubits in between do not end a block. A gate joins the open blocks it
+// touches if their qubits together fit, otherwise those blocks are
+// closed and it starts a new one. Closed blocks commute with every block
+// still open, so applying them in order of closing, then the remaining
+// ones, is the program up to the order of commuting gates.
+class GateFuser {
+public:
+  explicit GateFuser(const unsigned max_qubits);
+
+  // Add gate index of the program, qubits as in apply_gate
+  void add(const std::size_t index, const quantum::GateOp op,
+           const unsigned *qubits, const double *params);
+  // Close the open blocks acting on any of the qubits, e.g. before a
+  // measurement
+  void close(const unsigned *qubits, const int n_qubits);
+  void close_all();
+  // Blocks closed since the last call, in order of closing
+  std::vector<GateBlock> take_closed();
+
+protected:
+  unsigned m_max_qubits;
+  std::vector<GateBlock> m_open, m_closed;
+  // Index into m_open of the block on each qubit, -1 if none
+  std::vector<int> m_block_of;
+
+  void close_block(const int b);
+};
+
+} // namespace sv
+} // namespace qcor
+
+#endif
@@ -0,0 +1,701 @@
+#include "qcor_sv_accelerator.hpp"
+#include "tape_utils.hpp"
+
+#include "AcceleratorBuffer.hpp"
+#include "CompositeInstruction.hpp"
+#include "xacc.hpp"
+
+#include "cppmicroservices/BundleActivator.h"
+#include "cppmicroservices/BundleContext.h"
+#include "cppmicroservices/ServiceProperties.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+using namespace cppmicroservices;
+using namespace qcor::simulators;
+
+namespace qcor {
+namespace {
+// 2^34 amplitudes is 256 GB in double precision, the same memory holds
+// one more qubit in single precision
+constexpr std::size_t max_qubits = 34;
+// Amplitudes over all lanes of a batched simulation. Batching pays off
+// while the lanes fit in cache together; beyond that each gate is memory
+// bound either way and single states keep the cache blocked layout.
+constexpr std::size_t max_batch_amplitudes = std::size_t(1) << 17;
+
+// Translate the term masks of obs to state vector positions. Qubits beyond
+// the state are in |0>, so Z on them is +1 and X or Y gives <P> = 0, which
+// is flagged in vanishes.
+void pauli_masks(const PauliSum &obs, const SimulationPlan &p,
+                 std::vector<std::uint64_t> &x, std::vector<std::uint64_t> &z,
+                 std::vector<bool> &vanishes) {
+  x.assign(obs.n_terms(), 0);
+  z.assign(obs.n_terms(), 0);
+  vanishes.assign(obs.n_terms(), false);
+  for (std::size_t t = 0; t < obs.n_terms(); t++) {
+    const auto x_words = obs.x_mask(t), z_words = obs.z_mask(t);
+    for (std::size_t w = 0; w < obs.n_words(); w++) {
+      for (auto bits = x_words[w] | z_words[w]; bits; bits &= bits - 1) {
+        const auto b = __builtin_ctzll(bits);
+        const std::size_t q = w * PauliSum::bits_per_word + b;
+        const bool has_x = x_words[w] >> b & 1, has_z = z_words[w] >> b & 1;
+        if (q >= p.n_qubits) {
+          vanishes[t] = vanishes[t] || has_x;
+          continue;
+        }
+        x[t] |= std::uint64_t(has_x) << p.layout[q];
+        z[t] |= std::uint64_t(has_z) << p.layout[q];
+      }
+    }
+  }
+}
+
+void record_passes(xacc::AcceleratorBuffer *buffer, const std::size_t passes) {
+  buffer->addExtraInfo("sv-state-passes", (int)passes);
+}
+
+// True if b applies the same gates to the same qubits as a, up to angles
+bool same_structure(const quantum::GateTape &a, const quantum::GateTape &b) {
+  if (a.size() != b.size() || a.registers() != b.registers()) {
+    return false;
+  }
+  for (std::size_t g = 0; g < a.size(); g++) {
+    const auto &ga = a.gates()[g], &gb = b.gates()[g];
+    if (ga.op != gb.op) {
+      return false;
+    }
+    for (int i = 0; i < quantum::gate_n_qubits(ga.op); i++) {
+      if (ga.reg[i] != gb.reg[i] || ga.bit[i] != gb.bit[i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+void StateVectorAccelerator::initialize(const xacc::HeterogeneousMap &params) {
+  updateConfiguration(params);
+}
+
+void StateVectorAccelerator::updateConfiguration(
+    const xacc::HeterogeneousMap &config) {
+  if (config.keyExists<int>("shots")) {
+    m_shots = config.get<int>("shots");
+  }
+  if (config.keyExists<int>("seed")) {
+    m_rng.seed(config.get<int>("seed"));
+  }
+  if (config.keyExists<int>("block-qubits")) {
+    // Blocks are 2^block-qubits amplitudes, a count that must fit in an
+    // index. Beyond the state size blocking is simply off.
+    m_block_qubits =
+        std::max(1, std::min(config.get<int>("block-qubits"), 62));
+  }
+  if (config.keyExists<bool>("stabilizer")) {
+    m_stabilizer = config.get<bool>("stabilizer");
+  }
+  if (config.keyExists<int>("batch-size")) {
+    m_batch_size = std::max(1, config.get<int>("batch-size"));
+  }
+  if (config.keyExists<bool>("packed-counts")) {
+    m_packed_counts = config.get<bool>("packed-counts");
+  }
+  if (config.keyExists<int>("fusion-qubits")) {
+    m_fusion_qubits = config.get<int>("fusion-qubits");
+    if (m_fusion_qubits > (int)sv::max_dense_qubits) {
+      xacc::error("[qcor-sv] fusion-qubits must be at most " +
+                  std::to_string(sv::max_dense_qubits) + ".");
+    }
+  }
+  // "backend" carries the suffix of -qpu qcor-sv:single
+  for (auto key : {"backend", "precision"}) {
+    if (!config.stringExists(key)) {
+      continue;
+    }
+    const auto precision = config.getString(key);
+    if (precision != "single" && precision != "double") {
+      xacc::error("[qcor-sv] Unknown precision '" + precision +
+                  "', expected single or double.");
+    }
+    m_single = precision == "single";
+  }
+}
+
+xacc::HeterogeneousMap StateVectorAccelerator::getProperties() {
+  xacc::HeterogeneousMap props;
+  props.insert("shots", m_shots);
+  props.insert("block-qubits", m_block_qubits);
+  props.insert("stabilizer", m_stabilizer);
+  props.insert("batch-size", m_batch_size);
+  props.insert("precision", std::string(m_single ? "single" : "double"));
+  props.insert("fusion-qubits", m_fusion_qubits);
+  props.insert("packed-counts", m_packed_counts);
+  return props;
+}
+
+SimulationPlan StateVectorAccelerator::plan(const quantum::GateTape &tape,
+                                            xacc::AcceleratorBuffer **buffers,
+                                            const int nBuffers,
+                                            const bool reorder) {
+  SimulationPlan p;
+  const auto offsets = tape.register_offsets(buffers, nBuffers);
+  p.n_qubits = flat_size(tape, buffers, nBuffers);
+  const auto limit = max_qubits + (m_single ? 1 : 0);
+  if (p.n_qubits > limit) {
+    xacc::error("[qcor-sv] " + std::to_string(p.n_qubits) +
+                " qubits exceed the state vector limit of " +
+                std::to_string(limit));
+  }
+
+  // Flatten to logical qubit indices and count how often each is used
+  std::vector<std::size_t> usage(p.n_qubits, 0);
+  std::vector<std::array<std::size_t, 2>> logical;
+  logical.reserve(tape.size());
+  p.gates.reserve(tape.size());
+  std::vector<bool> seen_measure(p.n_qubits, false);
+  for (auto &gate : tape.gates()) {
+    const auto l =
+        logical_qubits(tape, gate, offsets, p.n_qubits, "qcor-sv");
+    for (int i = 0; i < quantum::gate_n_qubits(gate.op); i++) {
+      usage[l[i]]++;
+      if (gate.op != quantum::GateOp::Measure && seen_measure[l[i]]) {
+        p.terminal = false;
+      }
+    }
+    if (gate.op == quantum::GateOp::Measure && !seen_measure[l[0]]) {
+      seen_measure[l[0]] = true;
+      p.measured.push_back(l[0]);
+    }
+    logical.push_back(l);
+    p.gates.push_back({gate.op,
+                       {0, 0},
+                       {gate.params[0], gate.params[1], gate.params[2]}});
+  }
+
+  // Qubit ordering. The initial |0...0> is invariant under relabeling, so
+  // any layout is free; put the busiest qubits at the low positions where
+  // the blocked runs in run() can keep them in cache.
+  p.layout.resize(p.n_qubits);
+  std::iota(p.layout.begin(), p.layout.end(), 0);
+  if (reorder && p.n_qubits > (std::size_t)m_block_qubits) {
+    std::vector<unsigned> order(p.n_qubits);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](unsigned a, unsigned b) {
+                       return usage[a] > usage[b];
+                     });
+    for (unsigned pos = 0; pos < p.n_qubits; pos++) {
+      p.layout[order[pos]] = pos;
+    }
+  }
+
+  for (std::size_t g = 0; g < p.gates.size(); g++) {
+    for (int i = 0; i < quantum::gate_n_qubits(p.gates[g].op); i++) {
+      p.gates[g].qubits[i] = p.layout[logical[g][i]];
+    }
+  }
+  return p;
+}
+
+void StateVectorAccelerator::fuse(SimulationPlan &p) {
+  if (m_fusion_qubits < 2) {
+    return;
+  }
+  std::vector<PhysicalGate> gates;
+  gates.reserve(p.gates.size());
+  sv::GateFuser fuser(m_fusion_qubits);
+  auto emit_closed = [&]() {
+    for (auto &block : fuser.take_closed()) {
+      if (!block.worthwhile()) {
+        // Keep the specialized kernels of the gates
+        for (auto g : block.indices) {
+          gates.push_back(p.gates[g]);
+        }
+        continue;
+      }
+      PhysicalGate fused{quantum::GateOp::I, {0, 0}, {0.0, 0.0, 0.0}};
+      fused.fused = p.fused.size();
+      p.n_fused_gates += block.gates.size();
+      p.fused.push_back(block.fuse());
+      gates.push_back(fused);
+    }
+  };
+
+  for (std::size_t g = 0; g < p.gates.size(); g++) {
+    const auto &gate = p.gates[g];
+    if (gate.op == quantum::GateOp::Measure) {
+      fuser.close(gate.qubits, 1);
+      emit_closed();
+      gates.push_back(gate);
+    } else {
+      fuser.add(g, gate.op, gate.qubits, gate.params);
+      emit_closed();
+    }
+  }
+  fuser.close_all();
+  emit_closed();
+  p.gates = std::move(gates);
+}
+
+template <typename State>
+std::size_t StateVectorAccelerator::run(State &state,
+                                        const SimulationPlan &plan,
+                                        std::vector<int> *bits) {
+  std::vector<std::size_t> inverse(plan.n_qubits);
+  for (std::size_t l = 0; l < plan.n_qubits; l++) {
+    inverse[plan.layout[l]] = l;
+  }
+
+  const bool blocking = state.n_qubits() > (std::size_t)m_block_qubits;
+  const std::size_t block_size = std::size_t(1) << m_block_qubits;
+  auto in_block = [&](const PhysicalGate &gate) {
+    if (gate.op == quantum::GateOp::Measure) {
+      return false;
+    }
+    if (gate.fused >= 0) {
+      return plan.fused[gate.fused].qubits.back() < (unsigned)m_block_qubits;
+    }
+    for (int i = 0; i < quantum::gate_n_qubits(gate.op); i++) {
+      if (gate.qubits[i] >= (unsigned)m_block_qubits) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  auto apply = [&](auto *data, const std::size_t size,
+                   const PhysicalGate &gate, const bool parallel) {
+    if (gate.fused >= 0) {
+      const auto &block = plan.fused[gate.fused];
+      sv::apply_dense(data, size, block.qubits.data(), block.qubits.size(),
+                      block.matrix.data(), parallel);
+    } else {
+      sv::apply_gate(data, size, gate.op, gate.qubits, gate.params,
+                     parallel);
+    }
+  };
+
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  const auto &gates = plan.gates;
+  std::size_t g = 0, passes = 0;
+  while (g < gates.size()) {
+    if (blocking) {
+      auto end = g;
+      while (end < gates.size() && in_block(gates[end])) {
+        end++;
+      }
+      if (end - g > 1) {
+        // One pass over memory for the whole run: each block of
+        // 2^block_qubits amplitudes is an independent state for them
+        const std::int64_t n_blocks = state.size() / block_size;
+        auto data = state.data();
+#pragma omp parallel for schedule(static)
+        for (std::int64_t b = 0; b < n_blocks; b++) {
+          for (auto k = g; k < end; k++) {
+            apply(data + b * block_size, block_size, gates[k], false);
+          }
+        }
+        g = end;
+        passes++;
+        continue;
+      }
+    }
+
+    auto &gate = gates[g];
+    if (gate.op == quantum::GateOp::Measure) {
+      if (bits) {
+        (*bits)[inverse[gate.qubits[0]]] =
+            state.measure(gate.qubits[0], uniform(m_rng));
+        passes++;
+      }
+    } else {
+      apply(state.data(), state.size(), gate, state.parallel());
+      passes++;
+    }
+    g++;
+  }
+  return passes;
+}
+
+void StateVectorAccelerator::execute(xacc::AcceleratorBuffer **buffers,
+                                     const int nBuffers,
+                                     const quantum::GateTape &tape) {
+  if (m_stabilizer && tape.is_clifford()) {
+    return execute_clifford(buffers, nBuffers, tape);
+  }
+
+  auto p = plan(tape, buffers, nBuffers);
+  fuse(p);
+  buffers[0]->addExtraInfo("sv-fused-blocks", (int)p.fused.size());
+  buffers[0]->addExtraInfo("sv-fused-gates", (int)p.n_fused_gates);
+  if (m_single) {
+    return simulate<sv::StateVectorF>(p, buffers, nBuffers);
+  }
+  simulate<sv::StateVector>(p, buffers, nBuffers);
+}
+
+template <typename State>
+void StateVectorAccelerator::simulate(const SimulationPlan &p,
+                                      xacc::AcceleratorBuffer **buffers,
+                                      const int nBuffers) {
+  if (m_shots <= 0 && !p.terminal) {
+    xacc::error("[qcor-sv] Qubits that are measured and then acted on need "
+                "shots > 0, so that the measurement collapses the state.");
+  }
+  State state(p.n_qubits);
+  if (m_shots <= 0 || p.measured.empty() || p.terminal) {
+    // Simulate once. With shots, every shot is drawn from the final
+    // distribution.
+    record_passes(buffers[0], run(state, p, nullptr));
+    return record_results(state, p, buffers, nBuffers);
+  }
+
+  // Mid-circuit measurements, re-simulate each shot
+  ShotCounter counter(p.measured, buffers, nBuffers);
+  std::vector<int> bits(p.n_qubits, 0);
+  std::size_t passes = 0;
+  for (int shot = 0; shot < m_shots; shot++) {
+    if (shot > 0) {
+      state.reset();
+    }
+    passes += run(state, p, &bits);
+    counter.add([&](std::size_t m) { return bits[p.measured[m]]; });
+  }
+  record_passes(buffers[0], passes);
+  counter.record(buffers, nBuffers, m_packed_counts);
+}
+
+template <typename State>
+void StateVectorAccelerator::record_results(const State &state,
+                                            const SimulationPlan &p,
+                                            xacc::AcceleratorBuffer **buffers,
+                                            const int nBuffers) {
+  if (p.measured.empty()) {
+    return;
+  }
+  if (m_shots > 0) {
+    return sample_terminal(state, p, buffers, nBuffers);
+  }
+  std::uint64_t mask = 0;
+  for (auto l : p.measured) {
+    mask |= std::uint64_t(1) << p.layout[l];
+  }
+  buffers[0]->addExtraInfo("exp-val-z", state.expectation_z(mask));
+}
+
+template <typename State>
+void StateVectorAccelerator::sample_terminal(const State &state,
+                                             const SimulationPlan &p,
+                                             xacc::AcceleratorBuffer **buffers,
+                                             const int nBuffers) {
+  // Bit j of an outcome is the qubit at the j-th smallest position
+  std::vector<unsigned> positions;
+  for (auto l : p.measured) {
+    positions.push_back(p.layout[l]);
+  }
+  std::sort(positions.begin(), positions.end());
+  auto cdf = state.probabilities(positions);
+  std::partial_sum(cdf.begin(), cdf.end(), cdf.begin());
+
+  // Draw all uniforms up front so the table lookups are independent
+  std::uniform_real_distribution<double> uniform(0.0, cdf.back());
+  std::vector<double> draws(m_shots);
+  for (auto &r : draws) {
+    r = uniform(m_rng);
+  }
+  std::vector<std::uint64_t> outcomes(m_shots);
+  const std::int64_t n_shots = m_shots;
+#pragma omp parallel for schedule(static) if (n_shots >= 4096)
+  for (std::int64_t s = 0; s < n_shots; s++) {
+    const std::size_t k =
+        std::upper_bound(cdf.begin(), cdf.end(), draws[s]) - cdf.begin();
+    outcomes[s] = std::min(k, cdf.size() - 1);
+  }
+
+  // Count the outcomes, then each distinct one per buffer
+  Histogram histogram(positions.size());
+  for (auto k : outcomes) {
+    histogram.add(k);
+  }
+  std::vector<unsigned> bit_of(p.measured.size());
+  for (std::size_t m = 0; m < p.measured.size(); m++) {
+    bit_of[m] = std::lower_bound(positions.begin(), positions.end(),
+                                 p.layout[p.measured[m]]) -
+                positions.begin();
+  }
+  ShotCounter counter(p.measured, buffers, nBuffers);
+  for (std::size_t i = 0; i < histogram.size(); i++) {
+    const auto k = histogram.key(i)[0];
+    counter.add([&](std::size_t m) { return k >> bit_of[m] & 1; },
+                histogram.count(i));
+  }
+  counter.record(buffers, nBuffers, m_packed_counts);
+}
+
+void StateVectorAccelerator::begin_stream(xacc::AcceleratorBuffer **buffers,
+                                          const int nBuffers) {
+  m_stream = StateVectorStream();
+  m_stream.buffers.assign(buffers, buffers + nBuffers);
+  auto &p = m_stream.plan;
+  p.n_qubits = flat_size(quantum::GateTape(), buffers, nBuffers);
+  const auto limit = max_qubits + (m_single ? 1 : 0);
+  if (p.n_qubits > limit) {
+    xacc::error("[qcor-sv] " + std::to_string(p.n_qubits) +
+                " qubits exceed the state vector limit of " +
+                std::to_string(limit));
+  }
+  p.layout.resize(p.n_qubits);
+  std::iota(p.layout.begin(), p.layout.end(), 0);
+  m_stream.seen_measure.assign(p.n_qubits, false);
+  if (m_single) {
+    m_stream.state_f = std::make_unique<sv::StateVectorF>(p.n_qubits);
+  } else {
+    m_stream.state = std::make_unique<sv::StateVector>(p.n_qubits);
+  }
+}
+
+void StateVectorAccelerator::execute_chunk(const quantum::GateTape &chunk) {
+  auto &stream = m_stream;
+  auto p = plan(chunk, stream.buffers.data(), stream.buffers.size(), false);
+  if (p.n_qubits > stream.plan.n_qubits) {
+    xacc::error("[qcor-sv] Streamed gates address " +
+                std::to_string(p.n_qubits) + " qubits, the buffers hold " +
+                std::to_string(stream.plan.n_qubits));
+  }
+  // With the identity layout, positions are logical qubits
+  for (auto &gate : p.gates) {
+    if (gate.op == quantum::GateOp::Measure) {
+      if (!stream.seen_measure[gate.qubits[0]]) {
+        stream.seen_measure[gate.qubits[0]] = true;
+        stream.plan.measured.push_back(gate.qubits[0]);
+      }
+      continue;
+    }
+    for (int i = 0; i < quantum::gate_n_qubits(gate.op); i++) {
+      if (stream.seen_measure[gate.qubits[i]]) {
+        stream.plan.terminal = false;
+      }
+    }
+  }
+  if (!stream.plan.terminal) {
+    xacc::error("[qcor-sv] Streamed programs must only measure at the end.");
+  }
+
+  p.n_qubits = stream.plan.n_qubits;
+  p.layout = stream.plan.layout;
+  fuse(p);
+  stream.fused_blocks += p.fused.size();
+  stream.fused_gates += p.n_fused_gates;
+  stream.passes += stream.state ? run(*stream.state, p, nullptr)
+                                : run(*stream.state_f, p, nullptr);
+}
+
+void StateVectorAccelerator::end_stream() {
+  auto &stream = m_stream;
+  auto buffers = stream.buffers.data();
+  const int nBuffers = stream.buffers.size();
+  buffers[0]->addExtraInfo("sv-fused-blocks", (int)stream.fused_blocks);
+  buffers[0]->addExtraInfo("sv-fused-gates", (int)stream.fused_gates);
+  record_passes(buffers[0], stream.passes);
+  if (stream.state) {
+    record_results(*stream.state, stream.plan, buffers, nBuffers);
+  } else {
+    record_results(*stream.state_f, stream.plan, buffers, nBuffers);
+  }
+  m_stream = StateVectorStream();
+}
+
+void StateVectorAccelerator::execute_clifford(
+    xacc::AcceleratorBuffer **buffers, const int nBuffers,
+    const quantum::GateTape &tape) {
+  const auto offsets = tape.register_offsets(buffers, nBuffers);
+  const auto n_qubits = flat_size(tape, buffers, nBuffers);
+  const auto n_measure =
+      std::count_if(tape.gates().begin(), tape.gates().end(),
+                    [](const quantum::TapeGate &gate) {
+                      return gate.op == quantum::GateOp::Measure;
+                    });
+
+  stabilizer::Tableau tableau(n_qubits, n_measure);
+  // Measured qubits in order of first measurement, and the index of the
+  // latest outcome of each qubit
+  std::vector<std::size_t> measured, last_outcome(n_qubits, 0);
+  std::vector<bool> seen_measure(n_qubits, false);
+  for (auto &gate : tape.gates()) {
+    const auto l = logical_qubits(tape, gate, offsets, n_qubits, "qcor-sv");
+    if (gate.op != quantum::GateOp::Measure) {
+      tableau.apply(gate.op, l.data());
+      continue;
+    }
+    last_outcome[l[0]] = tableau.measure(l[0]);
+    if (!seen_measure[l[0]]) {
+      seen_measure[l[0]] = true;
+      measured.push_back(l[0]);
+    }
+  }
+  if (measured.empty()) {
+    return;
+  }
+
+  if (m_shots <= 0) {
+    // <Z...Z> is +-1 if the parity of the outcomes is fixed, else 0
+    std::vector<std::size_t> outcomes;
+    for (auto l : measured) {
+      outcomes.push_back(last_outcome[l]);
+    }
+    int value = 0;
+    const bool fixed = tableau.parity(outcomes, value);
+    buffers[0]->addExtraInfo("exp-val-z", fixed ? 1.0 - 2.0 * value : 0.0);
+    return;
+  }
+
+  const auto samples = tableau.sample(m_shots, m_rng);
+  ShotCounter counter(measured, buffers, nBuffers);
+  for (int shot = 0; shot < m_shots; shot++) {
+    counter.add([&](std::size_t m) {
+      const auto &sample = samples[last_outcome[measured[m]]];
+      return sample[shot / 64] >> (shot % 64) & 1;
+    });
+  }
+  counter.record(buffers, nBuffers, m_packed_counts);
+}
+
+std::vector<double> StateVectorAccelerator::pauli_expectations(
+    xacc::AcceleratorBuffer *buffer,
+    std::shared_ptr<xacc::CompositeInstruction> program, const PauliSum &obs) {
+  quantum::GateTape tape;
+  tape.add(program, buffer->name());
+  auto p = plan(tape, &buffer, 1);
+  fuse(p);
+  if (m_single) {
+    return expectations<sv::StateVectorF>(p, obs);
+  }
+  return expectations<sv::StateVector>(p, obs);
+}
+
+template <typename State>
+std::vector<double>
+StateVectorAccelerator::expectations(const SimulationPlan &p,
+                                     const PauliSum &obs) {
+  State state(p.n_qubits);
+  run(state, p, nullptr);
+
+  std::vector<std::uint64_t> x, z;
+  std::vector<bool> vanishes;
+  pauli_masks(obs, p, x, z, vanishes);
+  auto exp_vals = state.expectation_paulis(x, z);
+  for (std::size_t t = 0; t < obs.n_terms(); t++) {
+    if (vanishes[t]) {
+      exp_vals[t] = 0.0;
+    }
+  }
+  return exp_vals;
+}
+
+std::vector<std::vector<double>> StateVectorAccelerator::pauli_expectations(
+    xacc::AcceleratorBuffer *buffer,
+    const std::vector<std::shared_ptr<xacc::CompositeInstruction>> &programs,
+    const PauliSum &obs) {
+  std::vector<quantum::GateTape> tapes(programs.size());
+  for (std::size_t k = 0; k < programs.size(); k++) {
+    tapes[k].add(programs[k], buffer->name());
+  }
+  if (programs.size() < 2 ||
+      !std::all_of(tapes.begin() + 1, tapes.end(),
+                   [&](const quantum::GateTape &tape) {
+                     return same_structure(tapes[0], tape);
+                   })) {
+    return ExactExpectation::pauli_expectations(buffer, programs, obs);
+  }
+
+  // Gates, layout and masks are shared, only the angles differ per lane
+  auto p = plan(tapes[0], &buffer, 1);
+  const std::size_t batch = std::min<std::size_t>(
+      m_batch_size, max_batch_amplitudes >> p.n_qubits);
+  if (batch < 2) {
+    return ExactExpectation::pauli_expectations(buffer, programs, obs);
+  }
+  std::vector<std::uint64_t> x, z;
+  std::vector<bool> vanishes;
+  pauli_masks(obs, p, x, z, vanishes);
+
+  std::vector<std::vector<double>> exp_vals(programs.size());
+  for (std::size_t first = 0; first < programs.size(); first += batch) {
+    const auto lanes = std::min(batch, programs.size() - first);
+    sv::BatchedStateVector state(p.n_qubits, lanes);
+    std::vector<double> params(3 * lanes);
+    for (std::size_t g = 0; g < p.gates.size(); g++) {
+      const auto &gate = p.gates[g];
+      if (gate.op == quantum::GateOp::Measure) {
+        continue;
+      }
+      for (std::size_t l = 0; l < lanes; l++) {
+        std::copy_n(tapes[first + l].gates()[g].params, 3, &params[3 * l]);
+      }
+      state.apply(gate.op, gate.qubits, params.data());
+    }
+
+    const auto lane_vals = state.expectation_paulis(x, z);
+    for (std::size_t l = 0; l < lanes; l++) {
+      auto &vals = exp_vals[first + l];
+      vals.resize(obs.n_terms());
+      for (std::size_t t = 0; t < obs.n_terms(); t++) {
+        vals[t] = vanishes[t] ? 0.0 : lane_vals[t * lanes + l];
+      }
+    }
+  }
+  return exp_vals;
+}
+
+void StateVectorAccelerator::execute(
+    std::shared_ptr<xacc::AcceleratorBuffer> buffer,
+    const std::shared_ptr<xacc::CompositeInstruction> compositeInstruction) {
+  quantum::GateTape tape;
+  tape.add(compositeInstruction, buffer->name());
+  auto raw = buffer.get();
+  execute(&raw, 1, tape);
+}
+
+void StateVectorAccelerator::execute(
+    std::shared_ptr<xacc::AcceleratorBuffer> buffer,
+    const std::vector<std::shared_ptr<xacc::CompositeInstruction>>
+        compositeInstructions) {
+  for (auto &program : compositeInstructions) {
+    auto child = std::make_shared<xacc::AcceleratorBuffer>(program->name(),
+                                                           buffer->size());
+    execute(child, program);
+    buffer->appendChild(program->name(), child);
+  }
+}
+
+} // namespace qcor
+
+namespace {
+
+/**
+ */
+class US_ABI_LOCAL StateVectorAcceleratorActivator : public BundleActivator {
+
+public:
+  StateVectorAcceleratorActivator() {}
+
+  /**
+   */
+  void Start(BundleContext context) {
+    auto acc = std::make_shared<qcor::StateVectorAccelerator>();
+    context.RegisterService<xacc::Accelerator>(acc);
+  }
+
+  /**
+   */
+  void Stop(BundleContext /*context*/) {}
+};
+
+} // namespace
+
+CPPMICROSERVICES_EXPORT_BUNDLE_ACTIVATOR(StateVectorAcceleratorActivator)
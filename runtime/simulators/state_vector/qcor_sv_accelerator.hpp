@@ -0,0 +1,214 @@
+#ifndef RUNTIME_SIMULATORS_QCOR_SV_ACCELERATOR_HPP_
+#define RUNTIME_SIMULATORS_QCOR_SV_ACCELERATOR_HPP_
+
+#include "Accelerator.hpp"
+#include "gate_fusion.hpp"
+#include "gate_tape.hpp"
+#include "qcor_expectation.hpp"
+#include "state_vector.hpp"
+#include "tableau.hpp"
+
+#include <memory>
+#include <random>
+
+namespace qcor {
+
+// A gate with its qubits resolved to state vector positions. After
+// fusion, fused >= 0 marks a block of gates, SimulationPlan::fused[fused],
+// in place of op.
+struct PhysicalGate {
+  quantum::GateOp op;
+  unsigned qubits[2];
+  double params[3];
+  int fused = -1;
+};
+
+// The tape lowered onto one state vector. layout maps the flat logical
+// qubit index (register offset + index) to its bit position in the
+// amplitude index.
+struct SimulationPlan {
+  std::size_t n_qubits = 0;
+  std::vector<PhysicalGate> gates;
+  std::vector<unsigned> layout;
+  // Logical qubits measured, in order of first measurement
+  std::vector<std::size_t> measured;
+  // True if no gate acts on a qubit after it has been measured, so all
+  // shots can be drawn from one final state
+  bool terminal = true;
+  std::vector<sv::FusedGate> fused;
+  // Gates absorbed into the fused blocks
+  std::size_t n_fused_gates = 0;
+};
+
+// A simulation fed chunk by chunk, see quantum::StreamingTapeExecutor.
+// Only one of state / state_f is set, depending on the precision.
+struct StateVectorStream {
+  std::vector<xacc::AcceleratorBuffer *> buffers;
+  // Identity layout, and the measurements over all chunks so far
+  SimulationPlan plan;
+  std::vector<bool> seen_measure;
+  std::unique_ptr<sv::StateVector> state;
+  std::unique_ptr<sv::StateVectorF> state_f;
+  std::size_t passes = 0, fused_blocks = 0, fused_gates = 0;
+};
+
+// qcor-sv is an in-process state-vector simulator. It executes the QRT
+// gate tape directly (see quantum::TapeExecutor), and xacc
+// CompositeInstructions by first lowering them to a tape.
+//
+// Gate kernels are vectorized with AVX2 / AVX-512 when the plugin is built
+// for a host that supports them, and split over OpenMP threads for large
+// states. When the state does not fit in cache, qubits are laid out so the
+// most frequently used ones sit at the low (cache-local) bit positions,
+// and runs of gates acting only on those qubits are applied block by
+// block, one pass over memory per run.
+//
+// Clifford-only tapes (see quantum::gate_is_clifford) are dispatched to
+// a stabilizer tableau instead, which scales to thousands of qubits and
+// samples all shots in bulk. Set "stabilizer" to false to disable this.
+//
+// With shots <= 0 (the default) measured qubits are not collapsed and the
+// exact <Z...Z> over them is stored as exp-val-z, and qcor::observe()
+// evaluates Pauli observables exactly from one simulation (see
+// ExactExpectation). With shots > 0 the program is sampled and counts are
+// appended to the buffer, bitstrings listing measured qubits in order of
+// measurement. If all measurements are terminal the state is computed
+// once and every shot is drawn from its cumulative distribution,
+// otherwise each shot is simulated with collapse. Programs that act on a
+// qubit after measuring it are rejected with shots <= 0, and when
+// streamed.
+//
+// "precision" selects double (the default) or single precision
+// amplitudes, also available as -qpu qcor-sv:single. Single precision
+// halves the memory and doubles the SIMD width of every gate, so it fits
+// one more qubit and runs memory bound states faster, at the cost of
+// amplitudes accurate to ~1e-6 rather than ~1e-15.
+//
+// Before simulation, groups of gates acting on at most "fusion-qubits"
+// qubits (default 4, at most 5, below 2 disables fusion) are multiplied
+// into one dense unitary (see sv::GateFuser), so each group costs a
+// single pass over the state instead of one per gate. Groups too small to
+// pay for the dense kernel are left as they are. Each execution records
+// sv-fused-blocks, sv-fused-gates (gates absorbed into them) and
+// sv-state-passes (passes over the full state vector, a cache blocked run
+// counting as one) in the buffer.
+//
+// With "packed-counts" set, sampled counts are attached to the buffers as
+// packed qcor::Histograms (read them with qcor::counts()) along with
+// their exp-val-z, and no bitstrings are stored.
+//
+// Programs handed to the batched pauli_expectations() that share one gate
+// structure and differ only in their angles are simulated batch-size at a
+// time in one sv::BatchedStateVector, so every gate is a single pass over
+// memory for all of them. Batches are capped so the lanes stay cache
+// resident; larger states are simulated one program at a time. Batched
+// states are small by construction and always use double precision.
+//
+// Streamed kernels (see quantum::set_streaming) are applied chunk by
+// chunk to one state as they are recorded. Qubits keep their logical
+// positions and Clifford tapes are not dispatched to the tableau, since
+// neither can be decided before the whole program is seen. Streams with
+// shots > 0 must only measure at the end.
+class StateVectorAccelerator : public xacc::Accelerator,
+                               public quantum::TapeExecutor,
+                               public quantum::StreamingTapeExecutor,
+                               public ExactExpectation {
+public:
+  void initialize(const xacc::HeterogeneousMap &params = {}) override;
+  void updateConfiguration(const xacc::HeterogeneousMap &config) override;
+  const std::vector<std::string> configurationKeys() override {
+    return {"shots", "seed", "block-qubits", "stabilizer", "batch-size",
+            "precision", "fusion-qubits", "packed-counts"};
+  }
+  xacc::HeterogeneousMap getProperties() override;
+  const std::string getSignature() override { return name() + ":"; }
+  std::vector<std::pair<int, int>> getConnectivity() override { return {}; }
+
+  void execute(std::shared_ptr<xacc::AcceleratorBuffer> buffer,
+               const std::shared_ptr<xacc::CompositeInstruction>
+                   compositeInstruction) override;
+  void execute(std::shared_ptr<xacc::AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<xacc::CompositeInstruction>>
+                   compositeInstructions) override;
+
+  // quantum::TapeExecutor
+  void execute(xacc::AcceleratorBuffer **buffers, const int nBuffers,
+               const quantum::GateTape &tape) override;
+
+  // quantum::StreamingTapeExecutor
+  void begin_stream(xacc::AcceleratorBuffer **buffers,
+                    const int nBuffers) override;
+  void execute_chunk(const quantum::GateTape &chunk) override;
+  void end_stream() override;
+
+  // ExactExpectation
+  bool exact_expectations() override { return m_shots <= 0; }
+  std::vector<double>
+  pauli_expectations(xacc::AcceleratorBuffer *buffer,
+                     std::shared_ptr<xacc::CompositeInstruction> program,
+                     const PauliSum &obs) override;
+  std::vector<std::vector<double>> pauli_expectations(
+      xacc::AcceleratorBuffer *buffer,
+      const std::vector<std::shared_ptr<xacc::CompositeInstruction>> &programs,
+      const PauliSum &obs) override;
+
+  const std::string name() const override { return "qcor-sv"; }
+  const std::string description() const override {
+    return "In-process state-vector simulator executing the qcor runtime "
+           "gate tape.";
+  }
+
+protected:
+  int m_shots = -1;
+  // Runs of gates on qubits below this position are cache blocked
+  int m_block_qubits = 15;
+  bool m_stabilizer = true;
+  // Parameter sets simulated together by the batched pauli_expectations()
+  int m_batch_size = 32;
+  // Simulate with std::complex<float> amplitudes
+  bool m_single = false;
+  int m_fusion_qubits = 4;
+  // Record counts as qcor::Histogram rather than bitstrings
+  bool m_packed_counts = false;
+  std::mt19937_64 m_rng{std::random_device{}()};
+  StateVectorStream m_stream;
+
+  // Lower the tape onto a state. Unless reorder is false, the busiest
+  // qubits are laid out at the low bit positions.
+  SimulationPlan plan(const quantum::GateTape &tape,
+                      xacc::AcceleratorBuffer **buffers, const int nBuffers,
+                      const bool reorder = true);
+  // Replace runs of gates in the plan with fused blocks
+  void fuse(SimulationPlan &p);
+  // Apply the plan to state. If bits is given, Measure collapses the
+  // state and records the outcome at bits[logical qubit].
+  // State is sv::StateVector or sv::StateVectorF, see m_single. Returns
+  // the number of passes over the full state.
+  template <typename State>
+  std::size_t run(State &state, const SimulationPlan &plan,
+                  std::vector<int> *bits);
+  // Execute the plan from |0...0>, recording exp-val-z or counts
+  template <typename State>
+  void simulate(const SimulationPlan &p, xacc::AcceleratorBuffer **buffers,
+                const int nBuffers);
+  // Record exp-val-z (shots <= 0) or counts drawn from the final state of
+  // a plan without mid-circuit measurements
+  template <typename State>
+  void record_results(const State &state, const SimulationPlan &p,
+                      xacc::AcceleratorBuffer **buffers, const int nBuffers);
+  // Draw m_shots outcomes of the measured qubits from the final state
+  template <typename State>
+  void sample_terminal(const State &state, const SimulationPlan &p,
+                       xacc::AcceleratorBuffer **buffers, const int nBuffers);
+  // <P> for each term of obs on the final state of the plan
+  template <typename State>
+  std::vector<double> expectations(const SimulationPlan &p,
+                                   const PauliSum &obs);
+  // Stabilizer simulation of a Clifford-only tape
+  void execute_clifford(xacc::AcceleratorBuffer **buffers, const int nBuffers,
+                        const quantum::GateTape &tape);
+};
+
+} // namespace qcor
+
+#endif
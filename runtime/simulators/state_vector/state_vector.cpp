@@ -0,0 +1,482 @@
+#include "state_vector.hpp"
+#include "state_vector_kernels.hpp"
+
+#include <cmath>
+#include <map>
+
+namespace qcor {
+namespace sv {
+namespace {
+
+enum class Isa { Generic, Avx2, Avx512 };
+
+// The widest kernel build the CPU can run
+Isa cpu_isa() {
+  static const Isa isa = []() {
+#if defined(QCOR_SV_AVX512)
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") &&
+        __builtin_cpu_supports("fma") && __builtin_cpu_supports("bmi2")) {
+      return Isa::Avx512;
+    }
+#endif
+#if defined(QCOR_SV_AVX2)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+        __builtin_cpu_supports("bmi2")) {
+      return Isa::Avx2;
+    }
+#endif
+    return Isa::Generic;
+  }();
+  return isa;
+}
+
+template <typename Real> const KernelTable<Real> &kernels() {
+  static const KernelTable<Real> table = []() {
+    switch (cpu_isa()) {
+#if defined(QCOR_SV_AVX512)
+    case Isa::Avx512:
+      return avx512::kernel_table<Real>();
+#endif
+#if defined(QCOR_SV_AVX2)
+    case Isa::Avx2:
+      return avx2::kernel_table<Real>();
+#endif
+    default:
+      return generic::kernel_table<Real>();
+    }
+  }();
+  return table;
+}
+
+} // namespace
+
+const char *kernel_isa() {
+  switch (cpu_isa()) {
+  case Isa::Avx512:
+    return "avx512";
+  case Isa::Avx2:
+    return "avx2";
+  default:
+    return "generic";
+  }
+}
+
+template <typename Real>
+void apply_matrix(std::complex<Real> *data, const std::size_t size,
+                  const unsigned target, const int control,
+                  const std::complex<Real> *m, const bool parallel) {
+  kernels<Real>().apply_matrix(data, size, target, control, m, parallel);
+}
+
+template <typename Real>
+void apply_diagonal(std::complex<Real> *data, const std::size_t size,
+                    const unsigned target, const int control,
+                    const std::complex<Real> d0, const std::complex<Real> d1,
+                    const bool parallel) {
+  kernels<Real>().apply_diagonal(data, size, target, control, d0, d1,
+                                 parallel);
+}
+
+template <typename Real>
+void apply_x(std::complex<Real> *data, const std::size_t size,
+             const unsigned target, const int control, const bool parallel) {
+  kernels<Real>().apply_x(data, size, target, control, parallel);
+}
+
+template <typename Real>
+void apply_swap(std::complex<Real> *data, const std::size_t size,
+                const unsigned a, const unsigned b, const bool parallel) {
+  kernels<Real>().apply_swap(data, size, a, b, parallel);
+}
+
+template <typename Real>
+void apply_gate(std::complex<Real> *data, const std::size_t size,
+                const quantum::GateOp op, const unsigned *qubits,
+                const double *params, const bool parallel) {
+  kernels<Real>().apply_gate(data, size, op, qubits, params, parallel);
+}
+
+template <typename Real>
+void apply_dense(std::complex<Real> *data, const std::size_t size,
+                 const unsigned *qubits, const unsigned k,
+                 const amplitude_t *m, const bool parallel) {
+  kernels<Real>().apply_dense(data, size, qubits, k, m, parallel);
+}
+
+template <typename Real>
+BasicStateVector<Real>::BasicStateVector(const std::size_t n_qubits)
+    : m_n_qubits(n_qubits), m_amplitudes(std::size_t(1) << n_qubits) {
+  reset();
+}
+
+template <typename Real> void BasicStateVector<Real>::reset() {
+  auto p = data();
+  const index_t n = size();
+  // First touch from the threads that will later work on each block
+#pragma omp parallel for schedule(static) if (parallel())
+  for (index_t i = 0; i < n; i++) {
+    p[i] = 0.0;
+  }
+  p[0] = 1.0;
+}
+
+template <typename Real>
+double BasicStateVector<Real>::probability_one(const unsigned q) const {
+  const PairIndexer index(q, -1);
+  const index_t n_groups = index.n_groups(size());
+  auto p = data();
+  double prob = 0.0;
+#pragma omp parallel for schedule(static) reduction(+ : prob) if (parallel())
+  for (index_t k = 0; k < n_groups; k++) {
+    prob += std::norm(p[index(k) | index.tbit]);
+  }
+  return prob;
+}
+
+template <typename Real>
+int BasicStateVector<Real>::measure(const unsigned q, const double r) {
+  const double p1 = probability_one(q);
+  const int outcome = r < p1 ? 1 : 0;
+  const Real scale = 1.0 / std::sqrt(outcome ? p1 : 1.0 - p1);
+
+  const PairIndexer index(q, -1);
+  const index_t n_groups = index.n_groups(size());
+  auto p = data();
+#pragma omp parallel for schedule(static) if (parallel())
+  for (index_t k = 0; k < n_groups; k++) {
+    const auto i0 = index(k);
+    const auto i1 = i0 | index.tbit;
+    p[outcome ? i0 : i1] = 0.0;
+    p[outcome ? i1 : i0] *= scale;
+  }
+  return outcome;
+}
+
+template <typename Real>
+double BasicStateVector<Real>::expectation_z(const std::uint64_t mask) const {
+  auto p = data();
+  const index_t n = size();
+  double exp_val = 0.0;
+#pragma omp parallel for schedule(static) reduction(+ : exp_val) if (parallel())
+  for (index_t i = 0; i < n; i++) {
+    const double parity = __builtin_parityll(i & mask) ? -1.0 : 1.0;
+    exp_val += parity * std::norm(p[i]);
+  }
+  return exp_val;
+}
+
+template <typename Real>
+std::vector<double> BasicStateVector<Real>::probabilities(
+    const std::vector<unsigned> &positions) const {
+  std::uint64_t mask = 0;
+  for (auto q : positions) {
+    mask |= std::uint64_t(1) << q;
+  }
+  const std::uint64_t rest = (size() - 1) & ~mask;
+  const index_t n_outcomes = index_t(1) << positions.size();
+  const index_t n_rest = size() >> positions.size();
+  std::vector<double> probs(n_outcomes, 0.0);
+  auto p = data();
+  auto probs_ptr = probs.data();
+
+  if (n_outcomes <= few_outcomes) {
+    // Stream the amplitudes once, the histogram is reduced per thread
+    const index_t n = size();
+#pragma omp parallel for schedule(static)                                      \
+    reduction(+ : probs_ptr[:n_outcomes]) if (parallel())
+    for (index_t i = 0; i < n; i++) {
+      probs_ptr[extract(i, mask)] += std::norm(p[i]);
+    }
+    return probs;
+  }
+
+#pragma omp parallel for schedule(static) if (parallel())
+  for (index_t k = 0; k < n_outcomes; k++) {
+    const auto base = deposit(k, mask);
+    double prob = 0.0;
+    for (index_t u = 0; u < n_rest; u++) {
+      prob += std::norm(p[base | deposit(u, rest)]);
+    }
+    probs_ptr[k] = prob;
+  }
+  return probs;
+}
+
+template <typename Real>
+std::vector<double>
+BasicStateVector<Real>::expectation_paulis(
+    const std::vector<std::uint64_t> &x,
+    const std::vector<std::uint64_t> &z) const {
+  std::vector<double> exp_vals(x.size(), 0.0);
+  std::map<std::uint64_t, std::vector<std::size_t>> groups;
+  for (std::size_t t = 0; t < x.size(); t++) {
+    groups[x[t]].push_back(t);
+  }
+
+  // With P = i^|x&z| X^x Z^z, <P> = i^|x&z| sum_i (-1)^|i&z| psi*[i^x] psi[i].
+  // Visiting only i with the top bit of x clear, the partner i^x adds the
+  // conjugate term with sign (-1)^|x&z|, so each pair contributes
+  // 2 Re(c_i) (|x&z| even) or 2i Im(c_i) (odd), c_i = psi*[i^x] psi[i].
+  // Every term then needs a single real accumulator.
+  auto p = data();
+  auto accumulate = [&](const std::uint64_t x_mask,
+                        const std::vector<std::uint64_t> &z_masks,
+                        const std::vector<double> &factors,
+                        const std::vector<char> &use_imag,
+                        std::vector<double> &sums, const bool threads) {
+    const std::size_t n = z_masks.size();
+    const unsigned top = x_mask ? 63 - __builtin_clzll(x_mask) : 0;
+    const index_t n_visits = x_mask ? size() / 2 : size();
+#pragma omp parallel if (threads)
+    {
+      std::vector<double> local(n, 0.0);
+#pragma omp for schedule(static)
+      for (index_t k = 0; k < n_visits; k++) {
+        const std::size_t i = x_mask ? insert_zero(k, top) : k;
+        const auto c = std::conj(p[i ^ x_mask]) * p[i];
+        for (std::size_t t = 0; t < n; t++) {
+          const double sign = 1.0 - 2.0 * __builtin_parityll(i & z_masks[t]);
+          local[t] += sign * (use_imag[t] ? c.imag() : c.real());
+        }
+      }
+#pragma omp critical
+      for (std::size_t t = 0; t < n; t++) {
+        sums[t] += factors[t] * local[t];
+      }
+    }
+  };
+
+  std::vector<std::pair<std::uint64_t, std::vector<std::size_t>>> work(
+      groups.begin(), groups.end());
+  // Small states: spread the groups over threads instead of amplitudes
+  const bool by_group = !parallel();
+#pragma omp parallel for schedule(dynamic) if (by_group)
+  for (index_t g = 0; g < (index_t)work.size(); g++) {
+    const auto x_mask = work[g].first;
+    const auto &terms = work[g].second;
+    std::vector<std::uint64_t> z_masks;
+    std::vector<double> factors, sums(terms.size(), 0.0);
+    std::vector<char> use_imag;
+    for (auto t : terms) {
+      const int n_y = __builtin_popcountll(x_mask & z[t]) % 4;
+      z_masks.push_back(z[t]);
+      use_imag.push_back(n_y % 2);
+      if (!x_mask) {
+        factors.push_back(1.0);
+      } else {
+        // i^n_y times 2 (even) or 2i (odd)
+        factors.push_back(n_y == 0 || n_y == 3 ? 2.0 : -2.0);
+      }
+    }
+    accumulate(x_mask, z_masks, factors, use_imag, sums, !by_group);
+    for (std::size_t j = 0; j < terms.size(); j++) {
+      exp_vals[terms[j]] = sums[j];
+    }
+  }
+  return exp_vals;
+}
+
+#define QCOR_SV_INSTANTIATE(Real)                                            \
+  template void apply_matrix(std::complex<Real> *, const std::size_t,          \
+                             const unsigned, const int,                        \
+                             const std::complex<Real> *, const bool);          \
+  template void apply_diagonal(std::complex<Real> *, const std::size_t,        \
+                               const unsigned, const int,                      \
+                               const std::complex<Real>,                       \
+                               const std::complex<Real>, const bool);          \
+  template void apply_x(std::complex<Real> *, const std::size_t,               \
+                        const unsigned, const int, const bool);                \
+  template void apply_swap(std::complex<Real> *, const std::size_t,            \
+                           const unsigned, const unsigned, const bool);        \
+  template void apply_gate(std::complex<Real> *, const std::size_t,            \
+                           const quantum::GateOp, const unsigned *,            \
+                           const double *, const bool);                        \
+  template void apply_dense(std::complex<Real> *, const std::size_t,           \
+                            const unsigned *, const unsigned,                  \
+                            const amplitude_t *, const bool);                  \
+  template class BasicStateVector<Real>;
+
+QCOR_SV_INSTANTIATE(double)
+QCOR_SV_INSTANTIATE(float)
+#undef QCOR_SV_INSTANTIATE
+
+BatchedStateVector::BatchedStateVector(const std::size_t n_qubits,
+                                       const std::size_t batch)
+    : m_n_qubits(n_qubits), m_batch(batch),
+      m_re((std::size_t(1) << n_qubits) * batch),
+      m_im((std::size_t(1) << n_qubits) * batch) {
+  reset();
+}
+
+void BatchedStateVector::reset() {
+  auto re = m_re.data(), im = m_im.data();
+  const index_t n = m_re.size();
+#pragma omp parallel for schedule(static) if (parallel())
+  for (index_t i = 0; i < n; i++) {
+    re[i] = 0.0;
+    im[i] = 0.0;
+  }
+  std::fill_n(re, m_batch, 1.0);
+}
+
+void BatchedStateVector::apply(const quantum::GateOp op,
+                               const unsigned *qubits, const double *params) {
+  using quantum::GateOp;
+  if (op == GateOp::I || op == GateOp::Measure) {
+    return;
+  }
+  const std::size_t K = m_batch;
+  auto re = m_re.data(), im = m_im.data();
+
+  if (op == GateOp::Swap) {
+    const unsigned lo = std::min(qubits[0], qubits[1]);
+    const unsigned hi = std::max(qubits[0], qubits[1]);
+    const std::size_t a = std::size_t(1) << qubits[0];
+    const std::size_t b = std::size_t(1) << qubits[1];
+    const index_t n_groups = size() >> 2;
+#pragma omp parallel for schedule(static) if (parallel())
+    for (index_t k = 0; k < n_groups; k++) {
+      const auto i = insert_zero(insert_zero(k, lo), hi);
+      const auto ia = (i | a) * K, ib = (i | b) * K;
+      std::swap_ranges(re + ia, re + ia + K, re + ib);
+      std::swap_ranges(im + ia, im + ia + K, im + ib);
+    }
+    return;
+  }
+
+  const bool controlled = quantum::gate_n_qubits(op) == 2;
+  const PairIndexer index(controlled ? qubits[1] : qubits[0],
+                          controlled ? int(qubits[0]) : -1);
+  const index_t n_groups = index.n_groups(size());
+
+  if (op == GateOp::X || op == GateOp::CNOT) {
+#pragma omp parallel for schedule(static) if (parallel())
+    for (index_t k = 0; k < n_groups; k++) {
+      const auto i0 = index(k) * K, i1 = (index(k) | index.tbit) * K;
+      std::swap_ranges(re + i0, re + i0 + K, re + i1);
+      std::swap_ranges(im + i0, im + i0 + K, im + i1);
+    }
+    return;
+  }
+
+  // Per lane matrices, split into real and imaginary parts per entry
+  std::vector<double, AlignedAllocator<double>> m(8 * K);
+  bool diagonal = true;
+  for (std::size_t l = 0; l < K; l++) {
+    amplitude_t lane_m[4];
+    quantum::gate_matrix(op, params + 3 * l, lane_m);
+    for (int e = 0; e < 4; e++) {
+      m[2 * e * K + l] = lane_m[e].real();
+      m[(2 * e + 1) * K + l] = lane_m[e].imag();
+    }
+    diagonal = diagonal && lane_m[1] == 0.0 && lane_m[2] == 0.0;
+  }
+  const double *m00r = &m[0], *m00i = &m[K], *m01r = &m[2 * K],
+               *m01i = &m[3 * K], *m10r = &m[4 * K], *m10i = &m[5 * K],
+               *m11r = &m[6 * K], *m11i = &m[7 * K];
+
+  if (diagonal) {
+#pragma omp parallel for schedule(static) if (parallel())
+    for (index_t k = 0; k < n_groups; k++) {
+      const auto i0 = index(k);
+      double *r0 = re + i0 * K, *j0 = im + i0 * K;
+      double *r1 = re + (i0 | index.tbit) * K, *j1 = im + (i0 | index.tbit) * K;
+#pragma omp simd
+      for (std::size_t l = 0; l < K; l++) {
+        const double ar = r0[l], ai = j0[l], br = r1[l], bi = j1[l];
+        r0[l] = m00r[l] * ar - m00i[l] * ai;
+        j0[l] = m00r[l] * ai + m00i[l] * ar;
+        r1[l] = m11r[l] * br - m11i[l] * bi;
+        j1[l] = m11r[l] * bi + m11i[l] * br;
+      }
+    }
+    return;
+  }
+
+#pragma omp parallel for schedule(static) if (parallel())
+  for (index_t k = 0; k < n_groups; k++) {
+    const auto i0 = index(k);
+    double *r0 = re + i0 * K, *j0 = im + i0 * K;
+    double *r1 = re + (i0 | index.tbit) * K, *j1 = im + (i0 | index.tbit) * K;
+#pragma omp simd
+    for (std::size_t l = 0; l < K; l++) {
+      const double ar = r0[l], ai = j0[l], br = r1[l], bi = j1[l];
+      r0[l] = m00r[l] * ar - m00i[l] * ai + m01r[l] * br - m01i[l] * bi;
+      j0[l] = m00r[l] * ai + m00i[l] * ar + m01r[l] * bi + m01i[l] * br;
+      r1[l] = m10r[l] * ar - m10i[l] * ai + m11r[l] * br - m11i[l] * bi;
+      j1[l] = m10r[l] * ai + m10i[l] * ar + m11r[l] * bi + m11i[l] * br;
+    }
+  }
+}
+
+std::vector<double> BatchedStateVector::expectation_paulis(
+    const std::vector<std::uint64_t> &x,
+    const std::vector<std::uint64_t> &z) const {
+  const std::size_t K = m_batch;
+  std::vector<double> exp_vals(x.size() * K, 0.0);
+  std::map<std::uint64_t, std::vector<std::size_t>> groups;
+  for (std::size_t t = 0; t < x.size(); t++) {
+    groups[x[t]].push_back(t);
+  }
+  std::vector<std::pair<std::uint64_t, std::vector<std::size_t>>> work(
+      groups.begin(), groups.end());
+
+  // Same pairing as StateVector::expectation_paulis, with one accumulator
+  // per term and lane
+  auto re = m_re.data(), im = m_im.data();
+  const bool by_group = !parallel();
+#pragma omp parallel for schedule(dynamic) if (by_group)
+  for (index_t g = 0; g < (index_t)work.size(); g++) {
+    const auto x_mask = work[g].first;
+    const auto &terms = work[g].second;
+    const std::size_t n = terms.size();
+    const unsigned top = x_mask ? 63 - __builtin_clzll(x_mask) : 0;
+    const index_t n_visits = x_mask ? size() / 2 : size();
+    std::vector<double> sums(n * K, 0.0);
+
+#pragma omp parallel if (!by_group)
+    {
+      std::vector<double> local(n * K, 0.0), c_re(K), c_im(K);
+#pragma omp for schedule(static)
+      for (index_t k = 0; k < n_visits; k++) {
+        const std::size_t i = x_mask ? insert_zero(k, top) : k;
+        const double *ar = re + (i ^ x_mask) * K, *ai = im + (i ^ x_mask) * K;
+        const double *br = re + i * K, *bi = im + i * K;
+        double *cr = c_re.data(), *ci = c_im.data();
+#pragma omp simd
+        for (std::size_t l = 0; l < K; l++) {
+          cr[l] = ar[l] * br[l] + ai[l] * bi[l];
+          ci[l] = ar[l] * bi[l] - ai[l] * br[l];
+        }
+        for (std::size_t j = 0; j < n; j++) {
+          const auto t = terms[j];
+          const double sign = 1.0 - 2.0 * __builtin_parityll(i & z[t]);
+          const double *c =
+              __builtin_popcountll(x_mask & z[t]) % 2 ? ci : cr;
+          double *acc = &local[j * K];
+#pragma omp simd
+          for (std::size_t l = 0; l < K; l++) {
+            acc[l] += sign * c[l];
+          }
+        }
+      }
+#pragma omp critical
+      for (std::size_t e = 0; e < n * K; e++) {
+        sums[e] += local[e];
+      }
+    }
+
+    for (std::size_t j = 0; j < n; j++) {
+      const auto t = terms[j];
+      const int n_y = __builtin_popcountll(x_mask & z[t]) % 4;
+      const double factor = !x_mask ? 1.0 : n_y == 0 || n_y == 3 ? 2.0 : -2.0;
+      for (std::size_t l = 0; l < K; l++) {
+        exp_vals[t * K + l] = factor * sums[j * K + l];
+      }
+    }
+  }
+  return exp_vals;
+}
+
+} // namespace sv
+} // namespace qcor
@@ -0,0 +1,203 @@
+#ifndef RUNTIME_SIMULATORS_STATE_VECTOR_HPP_
+#define RUNTIME_SIMULATORS_STATE_VECTOR_HPP_
+
+#include "gate_tape.hpp"
+
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace qcor {
+namespace sv {
+
+using amplitude_t = std::complex<double>;
+
+// Amplitudes are 64 byte aligned so AVX-512 loads never split a cache line
+template <typename T, std::size_t Alignment = 64> class AlignedAllocator {
+public:
+  using value_type = T;
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+  T *allocate(const std::size_t n) {
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, Alignment, n * sizeof(T)) != 0) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(ptr);
+  }
+  void deallocate(T *ptr, const std::size_t) { std::free(ptr); }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const {
+    return false;
+  }
+};
+
+// Gate kernels, for double and single (float) precision amplitudes. Each
+// acts on the 2^n amplitudes starting at data, qubits are positions in the
+// amplitude index (qubit q is bit q). With parallel set the amplitude loop
+// is split across OpenMP threads.
+//
+// The kernels are built for several instruction sets and run with the
+// widest one the CPU supports.
+//
+// General 2x2 unitary m (row major) on target, optionally controlled
+// on control (control < 0 means uncontrolled).
+template <typename Real>
+void apply_matrix(std::complex<Real> *data, const std::size_t size,
+                  const unsigned target, const int control,
+                  const std::complex<Real> *m, const bool parallel);
+// diag(d0, d1) on target, optionally controlled
+template <typename Real>
+void apply_diagonal(std::complex<Real> *data, const std::size_t size,
+                    const unsigned target, const int control,
+                    const std::complex<Real> d0, const std::complex<Real> d1,
+                    const bool parallel);
+// Pauli X on target, optionally controlled
+template <typename Real>
+void apply_x(std::complex<Real> *data, const std::size_t size,
+             const unsigned target, const int control, const bool parallel);
+template <typename Real>
+void apply_swap(std::complex<Real> *data, const std::size_t size,
+                const unsigned a, const unsigned b, const bool parallel);
+
+// Apply a tape gate whose qubits have been resolved to amplitude index
+// positions. Measure and I are no-ops here.
+template <typename Real>
+void apply_gate(std::complex<Real> *data, const std::size_t size,
+                const quantum::GateOp op, const unsigned *qubits,
+                const double *params, const bool parallel);
+
+// Dense 2^k x 2^k unitary m (row major) on the k <= max_dense_qubits
+// qubits at the given ascending positions, bit j of a row or column index
+// being qubits[j]. Used for fused gate blocks, see GateFuser. Entries are
+// given in double and rounded once for Real = float.
+constexpr unsigned max_dense_qubits = 5;
+template <typename Real>
+void apply_dense(std::complex<Real> *data, const std::size_t size,
+                 const unsigned *qubits, const unsigned k,
+                 const amplitude_t *m, const bool parallel);
+
+// The instruction set the kernels run with: "avx512", "avx2" or "generic"
+const char *kernel_isa();
+
+// The full state of n qubits, initialized to |0...0>. Amplitudes are
+// std::complex<Real>; with Real = float the same memory holds twice as
+// many amplitudes and the SIMD kernels process twice as many per
+// instruction. Probabilities and expectations are accumulated in double
+// either way.
+template <typename Real> class BasicStateVector {
+public:
+  using amplitude_type = std::complex<Real>;
+
+  explicit BasicStateVector(const std::size_t n_qubits);
+
+  std::size_t n_qubits() const { return m_n_qubits; }
+  std::size_t size() const { return m_amplitudes.size(); }
+  amplitude_type *data() { return m_amplitudes.data(); }
+  const amplitude_type *data() const { return m_amplitudes.data(); }
+
+  // Return to |0...0>
+  void reset();
+  // True if kernels on the full state should run multi-threaded
+  bool parallel() const { return size() >= parallel_threshold; }
+
+  void apply(const quantum::GateOp op, const unsigned *qubits,
+             const double *params) {
+    apply_gate(data(), size(), op, qubits, params, parallel());
+  }
+
+  void apply_dense(const unsigned *qubits, const unsigned k,
+                   const amplitude_t *m) {
+    sv::apply_dense(data(), size(), qubits, k, m, parallel());
+  }
+
+  // Probability of measuring 1 on qubit q
+  double probability_one(const unsigned q) const;
+  // Measure qubit q, collapsing the state. r is uniform in [0, 1).
+  int measure(const unsigned q, const double r);
+  // Marginal distribution over the qubits at the given (ascending)
+  // positions: entry k is the probability of reading bit j of k on
+  // positions[j]
+  std::vector<double> probabilities(const std::vector<unsigned> &positions)
+      const;
+  // <Z...Z> on the qubits set in mask
+  double expectation_z(const std::uint64_t mask) const;
+  // <P> for each Pauli string P given by an X mask and a Z mask (Y where
+  // both bits are set). Terms are grouped by X mask so each group costs
+  // one pass over the amplitudes.
+  std::vector<double> expectation_paulis(const std::vector<std::uint64_t> &x,
+                                         const std::vector<std::uint64_t> &z)
+      const;
+
+  // States below this size are not worth spawning threads for
+  static constexpr std::size_t parallel_threshold = std::size_t(1) << 14;
+  // Marginals up to this many outcomes are histogrammed in one pass
+  static constexpr std::int64_t few_outcomes = 1024;
+
+protected:
+  std::size_t m_n_qubits;
+  std::vector<amplitude_type, AlignedAllocator<amplitude_type>> m_amplitudes;
+};
+
+extern template class BasicStateVector<double>;
+extern template class BasicStateVector<float>;
+using StateVector = BasicStateVector<double>;
+using StateVectorF = BasicStateVector<float>;
+
+// K independent states of the same n qubits, for running one circuit
+// structure with K different parameter sets. Amplitudes are stored batch
+// innermost (index i of lane l at i * K + l) with real and imaginary
+// parts split, so every gate is one sweep over the amplitude pairs with
+// the K lanes of a pair contiguous and vectorized, each lane using its
+// own matrix.
+class BatchedStateVector {
+public:
+  BatchedStateVector(const std::size_t n_qubits, const std::size_t batch);
+
+  std::size_t n_qubits() const { return m_n_qubits; }
+  std::size_t batch() const { return m_batch; }
+  // Amplitudes per lane
+  std::size_t size() const { return std::size_t(1) << m_n_qubits; }
+  amplitude_t amplitude(const std::size_t index, const std::size_t lane) const {
+    return {m_re[index * m_batch + lane], m_im[index * m_batch + lane]};
+  }
+
+  // Return every lane to |0...0>
+  void reset();
+  bool parallel() const {
+    return size() * m_batch >= StateVector::parallel_threshold;
+  }
+
+  // Apply a gate to all lanes. params holds batch() parameter triples,
+  // lane l using params[3 * l], ..., params[3 * l + 2].
+  void apply(const quantum::GateOp op, const unsigned *qubits,
+             const double *params);
+
+  // <P_t> of every lane for Pauli strings given by X and Z masks, as in
+  // StateVector::expectation_paulis. Entry t * batch() + l is term t on
+  // lane l.
+  std::vector<double> expectation_paulis(const std::vector<std::uint64_t> &x,
+                                         const std::vector<std::uint64_t> &z)
+      const;
+
+protected:
+  std::size_t m_n_qubits, m_batch;
+  std::vector<double, AlignedAllocator<double>> m_re, m_im;
+};
+
+} // namespace sv
+} // namespace qcor
+
+#endif
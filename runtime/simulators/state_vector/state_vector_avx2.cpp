@@ -0,0 +1,4 @@
+// The gate kernels for CPUs with AVX2, FMA and BMI2, compiled with those
+// enabled (see CMakeLists.txt)
+#define QCOR_SV_ISA avx2
+#include "state_vector_kernels.cpp"
@@ -0,0 +1,4 @@
+// The gate kernels for CPUs with AVX-512F, compiled with it enabled (see
+// CMakeLists.txt)
+#define QCOR_SV_ISA avx512
+#include "state_vector_kernels.cpp"
@@ -0,0 +1,275 @@
+// The gate kernels. Built as is for the baseline instruction set, and
+// included by state_vector_avx2.cpp and state_vector_avx512.cpp, see
+// state_vector_kernels.hpp.
+#include "state_vector_kernels.hpp"
+
+#ifndef QCOR_SV_ISA
+#define QCOR_SV_ISA generic
+#endif
+
+namespace qcor {
+namespace sv {
+namespace QCOR_SV_ISA {
+
+template <typename Real>
+void apply_matrix(std::complex<Real> *data, const std::size_t size,
+                  const unsigned target, const int control,
+                  const std::complex<Real> *m, const bool parallel) {
+  const PairIndexer index(target, control);
+  const index_t n_groups = index.n_groups(size);
+
+  using V = Simd<Real>;
+  if constexpr (V::width > 1) {
+    if (index.run() >= V::width) {
+      using simd_t = typename V::type;
+      const simd_t m00r = V::set1(m[0].real()), m00i = V::set1(m[0].imag());
+      const simd_t m01r = V::set1(m[1].real()), m01i = V::set1(m[1].imag());
+      const simd_t m10r = V::set1(m[2].real()), m10i = V::set1(m[2].imag());
+      const simd_t m11r = V::set1(m[3].real()), m11i = V::set1(m[3].imag());
+      const index_t n_vectors = n_groups / V::width;
+#pragma omp parallel for schedule(static) if (parallel)
+      for (index_t v = 0; v < n_vectors; v++) {
+        const auto i0 = index(v * V::width);
+        const auto i1 = i0 | index.tbit;
+        const auto a0 = V::load(data + i0), a1 = V::load(data + i1);
+        V::store(data + i0,
+                 V::add(V::cmul(m00r, m00i, a0), V::cmul(m01r, m01i, a1)));
+        V::store(data + i1,
+                 V::add(V::cmul(m10r, m10i, a0), V::cmul(m11r, m11i, a1)));
+      }
+      return;
+    }
+  }
+
+#pragma omp parallel for schedule(static) if (parallel)
+  for (index_t k = 0; k < n_groups; k++) {
+    const auto i0 = index(k);
+    const auto i1 = i0 | index.tbit;
+    const auto a0 = data[i0], a1 = data[i1];
+    data[i0] = m[0] * a0 + m[1] * a1;
+    data[i1] = m[2] * a0 + m[3] * a1;
+  }
+}
+
+template <typename Real>
+void apply_diagonal(std::complex<Real> *data, const std::size_t size,
+                    const unsigned target, const int control,
+                    const std::complex<Real> d0, const std::complex<Real> d1,
+                    const bool parallel) {
+  const PairIndexer index(target, control);
+  const index_t n_groups = index.n_groups(size);
+  // Phase gates leave the |0> half alone, skip it to halve memory traffic
+  const bool skip_d0 = d0 == std::complex<Real>(1, 0);
+
+  using V = Simd<Real>;
+  if constexpr (V::width > 1) {
+    if (index.run() >= V::width) {
+      using simd_t = typename V::type;
+      const simd_t d0r = V::set1(d0.real()), d0i = V::set1(d0.imag());
+      const simd_t d1r = V::set1(d1.real()), d1i = V::set1(d1.imag());
+      const index_t n_vectors = n_groups / V::width;
+#pragma omp parallel for schedule(static) if (parallel)
+      for (index_t v = 0; v < n_vectors; v++) {
+        const auto i0 = index(v * V::width);
+        const auto i1 = i0 | index.tbit;
+        if (!skip_d0) {
+          V::store(data + i0, V::cmul(d0r, d0i, V::load(data + i0)));
+        }
+        V::store(data + i1, V::cmul(d1r, d1i, V::load(data + i1)));
+      }
+      return;
+    }
+  }
+
+#pragma omp parallel for schedule(static) if (parallel)
+  for (index_t k = 0; k < n_groups; k++) {
+    const auto i0 = index(k);
+    if (!skip_d0) {
+      data[i0] *= d0;
+    }
+    data[i0 | index.tbit] *= d1;
+  }
+}
+
+template <typename Real>
+void apply_x(std::complex<Real> *data, const std::size_t size,
+             const unsigned target, const int control, const bool parallel) {
+  const PairIndexer index(target, control);
+  const index_t n_groups = index.n_groups(size);
+#pragma omp parallel for schedule(static) if (parallel)
+  for (index_t k = 0; k < n_groups; k++) {
+    const auto i0 = index(k);
+    std::swap(data[i0], data[i0 | index.tbit]);
+  }
+}
+
+template <typename Real>
+void apply_swap(std::complex<Real> *data, const std::size_t size,
+                const unsigned a, const unsigned b, const bool parallel) {
+  const auto lo = std::min(a, b), hi = std::max(a, b);
+  const auto abit = std::size_t(1) << a, bbit = std::size_t(1) << b;
+  const index_t n_groups = size >> 2;
+#pragma omp parallel for schedule(static) if (parallel)
+  for (index_t k = 0; k < n_groups; k++) {
+    const auto i = insert_zero(insert_zero(k, lo), hi);
+    std::swap(data[i | abit], data[i | bbit]);
+  }
+}
+
+template <typename Real>
+void apply_gate(std::complex<Real> *data, const std::size_t size,
+                const quantum::GateOp op, const unsigned *qubits,
+                const double *params, const bool parallel) {
+  using quantum::GateOp;
+  if (op == GateOp::I || op == GateOp::Measure) {
+    return;
+  }
+  // For two qubit gates qubits[0] is the control, qubits[1] the target
+  const bool controlled = quantum::gate_n_qubits(op) == 2;
+  const int control = controlled ? qubits[0] : -1;
+  const unsigned target = controlled ? qubits[1] : qubits[0];
+
+  amplitude_t md[4];
+  if (!quantum::gate_matrix(op, params, md)) {
+    return apply_swap(data, size, qubits[0], qubits[1], parallel);
+  }
+  if (op == GateOp::X || op == GateOp::CNOT) {
+    return apply_x(data, size, target, control, parallel);
+  }
+  // Matrix entries are computed in double and rounded once
+  const std::complex<Real> m[4] = {
+      std::complex<Real>(md[0]), std::complex<Real>(md[1]),
+      std::complex<Real>(md[2]), std::complex<Real>(md[3])};
+  if (md[1] == 0.0 && md[2] == 0.0) {
+    return apply_diagonal(data, size, target, control, m[0], m[3], parallel);
+  }
+  apply_matrix(data, size, target, control, m, parallel);
+}
+
+namespace {
+// apply_dense on K qubits, K fixed so the per-group product unrolls
+template <typename Real, unsigned K>
+void apply_dense_k(std::complex<Real> *data, const std::size_t size,
+                   const unsigned *qubits, const amplitude_t *m,
+                   const bool parallel) {
+  constexpr std::size_t dim = std::size_t(1) << K;
+  // offset[c] is column c placed on the qubit bits, groups g enumerate
+  // the remaining bits
+  std::size_t offset[dim];
+  std::uint64_t mask = 0;
+  for (unsigned j = 0; j < K; j++) {
+    mask |= std::uint64_t(1) << qubits[j];
+  }
+  for (std::size_t c = 0; c < dim; c++) {
+    offset[c] = deposit(c, mask);
+  }
+  auto base_of = [&](std::size_t g) {
+    for (unsigned j = 0; j < K; j++) {
+      g = insert_zero(g, qubits[j]);
+    }
+    return g;
+  };
+  const index_t n_groups = size >> K;
+
+  // Column major, so the product with one group's amplitudes is a sum of
+  // columns scaled by them. Rounded once to Real. swapped holds each
+  // entry with real and imaginary parts exchanged.
+  alignas(64) std::complex<Real> columns[dim * dim], swapped[dim * dim];
+  for (std::size_t r = 0; r < dim; r++) {
+    for (std::size_t c = 0; c < dim; c++) {
+      columns[c * dim + r] = std::complex<Real>(m[r * dim + c]);
+      swapped[c * dim + r] = {columns[c * dim + r].imag(),
+                              columns[c * dim + r].real()};
+    }
+  }
+
+  using V = Simd<Real>;
+  if constexpr (V::width > 1 && dim >= V::width) {
+    using simd_t = typename V::type;
+    constexpr std::size_t n_vectors = dim / V::width;
+#pragma omp parallel for schedule(static) if (parallel)
+    for (index_t g = 0; g < n_groups; g++) {
+      const auto base = base_of(g);
+      // a * column summed as re(a) column and im(a) swapped, combined
+      // with one addsub at the end. Unrolled over v so the accumulators
+      // stay in registers.
+      simd_t acc_re[n_vectors], acc_im[n_vectors];
+#pragma GCC unroll 8
+      for (std::size_t v = 0; v < n_vectors; v++) {
+        acc_re[v] = acc_im[v] = V::set1(0);
+      }
+      for (std::size_t c = 0; c < dim; c++) {
+        const auto a = data[base | offset[c]];
+        const simd_t re = V::set1(a.real()), im = V::set1(a.imag());
+#pragma GCC unroll 8
+        for (std::size_t v = 0; v < n_vectors; v++) {
+          const auto e = c * dim + v * V::width;
+          acc_re[v] = V::fmadd(re, V::load(columns + e), acc_re[v]);
+          acc_im[v] = V::fmadd(im, V::load(swapped + e), acc_im[v]);
+        }
+      }
+      alignas(64) std::complex<Real> out[dim];
+#pragma GCC unroll 8
+      for (std::size_t v = 0; v < n_vectors; v++) {
+        V::store(out + v * V::width, V::addsub(acc_re[v], acc_im[v]));
+      }
+      for (std::size_t r = 0; r < dim; r++) {
+        data[base | offset[r]] = out[r];
+      }
+    }
+  } else {
+#pragma omp parallel for schedule(static) if (parallel)
+    for (index_t g = 0; g < n_groups; g++) {
+      const auto base = base_of(g);
+      Real out_re[dim] = {}, out_im[dim] = {};
+      for (std::size_t c = 0; c < dim; c++) {
+        const Real a_re = data[base | offset[c]].real(),
+                   a_im = data[base | offset[c]].imag();
+        const auto column = columns + c * dim;
+        for (std::size_t r = 0; r < dim; r++) {
+          out_re[r] += a_re * column[r].real() - a_im * column[r].imag();
+          out_im[r] += a_re * column[r].imag() + a_im * column[r].real();
+        }
+      }
+      for (std::size_t r = 0; r < dim; r++) {
+        data[base | offset[r]] = {out_re[r], out_im[r]};
+      }
+    }
+  }
+}
+} // namespace
+
+template <typename Real>
+void apply_dense(std::complex<Real> *data, const std::size_t size,
+                 const unsigned *qubits, const unsigned k,
+                 const amplitude_t *m, const bool parallel) {
+  switch (k) {
+  case 1: {
+    const std::complex<Real> m1[4] = {
+        std::complex<Real>(m[0]), std::complex<Real>(m[1]),
+        std::complex<Real>(m[2]), std::complex<Real>(m[3])};
+    return apply_matrix(data, size, qubits[0], -1, m1, parallel);
+  }
+  case 2:
+    return apply_dense_k<Real, 2>(data, size, qubits, m, parallel);
+  case 3:
+    return apply_dense_k<Real, 3>(data, size, qubits, m, parallel);
+  case 4:
+    return apply_dense_k<Real, 4>(data, size, qubits, m, parallel);
+  case 5:
+    return apply_dense_k<Real, 5>(data, size, qubits, m, parallel);
+  }
+}
+
+
+template <typename Real> KernelTable<Real> kernel_table() {
+  return {apply_matrix<Real>, apply_diagonal<Real>, apply_x<Real>,
+          apply_swap<Real>,   apply_gate<Real>,     apply_dense<Real>};
+}
+
+template KernelTable<double> kernel_table();
+template KernelTable<float> kernel_table();
+
+} // namespace QCOR_SV_ISA
+} // namespace sv
+} // namespace qcor
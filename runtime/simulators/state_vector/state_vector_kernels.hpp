@@ -0,0 +1,229 @@
+#ifndef RUNTIME_SIMULATORS_STATE_VECTOR_KERNELS_HPP_
+#define RUNTIME_SIMULATORS_STATE_VECTOR_KERNELS_HPP_
+
+// Internal to qcor-sv. The gate kernels of state_vector.hpp are compiled
+// once per instruction set: state_vector_kernels.cpp for the baseline the
+// library is built for, and again by state_vector_avx2.cpp and
+// state_vector_avx512.cpp with the matching compiler flags, each into its
+// own namespace. The public apply_* functions call the KernelTable of the
+// widest set the CPU supports, see kernel_isa().
+//
+// The helpers below are in an anonymous namespace, so every translation
+// unit has its own copy, compiled for its own instruction set.
+
+#include "state_vector.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__AVX512F__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace qcor {
+namespace sv {
+
+template <typename Real> struct KernelTable {
+  decltype(&sv::apply_matrix<Real>) apply_matrix;
+  decltype(&sv::apply_diagonal<Real>) apply_diagonal;
+  decltype(&sv::apply_x<Real>) apply_x;
+  decltype(&sv::apply_swap<Real>) apply_swap;
+  decltype(&sv::apply_gate<Real>) apply_gate;
+  decltype(&sv::apply_dense<Real>) apply_dense;
+};
+
+namespace generic {
+template <typename Real> KernelTable<Real> kernel_table();
+}
+namespace avx2 {
+template <typename Real> KernelTable<Real> kernel_table();
+}
+namespace avx512 {
+template <typename Real> KernelTable<Real> kernel_table();
+}
+
+namespace {
+
+using index_t = std::int64_t;
+
+// Insert a 0 bit at position b of k
+inline std::size_t insert_zero(const std::size_t k, const unsigned b) {
+  const std::size_t low = k & ((std::size_t(1) << b) - 1);
+  return ((k >> b) << (b + 1)) | low;
+}
+
+// Scatter the low bits of value to the set bits of mask, and the inverse
+inline std::uint64_t deposit(const std::uint64_t value,
+                             const std::uint64_t mask) {
+#if defined(__BMI2__)
+  return _pdep_u64(value, mask);
+#else
+  std::uint64_t result = 0, m = mask;
+  for (std::uint64_t b = 1; m; b <<= 1, m &= m - 1) {
+    if (value & b) {
+      result |= m & -m;
+    }
+  }
+  return result;
+#endif
+}
+inline std::uint64_t extract(const std::uint64_t value,
+                             const std::uint64_t mask) {
+#if defined(__BMI2__)
+  return _pext_u64(value, mask);
+#else
+  std::uint64_t result = 0, m = mask;
+  for (std::uint64_t b = 1; m; b <<= 1, m &= m - 1) {
+    if (value & m & -m) {
+      result |= b;
+    }
+  }
+  return result;
+#endif
+}
+
+// Enumerates the index pairs (i0, i0 | target bit) a single-target gate
+// acts on, skipping pairs whose control bit is 0. Consecutive groups k map
+// to consecutive i0 in runs of 2^lo, which is what lets the SIMD loops
+// load neighbouring amplitudes together.
+struct PairIndexer {
+  std::size_t tbit, cbit;
+  unsigned lo, hi, n_inserted;
+
+  PairIndexer(const unsigned target, const int control)
+      : tbit(std::size_t(1) << target),
+        cbit(control >= 0 ? std::size_t(1) << control : 0) {
+    if (control >= 0) {
+      lo = std::min<unsigned>(target, control);
+      hi = std::max<unsigned>(target, control);
+      n_inserted = 2;
+    } else {
+      lo = hi = target;
+      n_inserted = 1;
+    }
+  }
+
+  index_t n_groups(const std::size_t size) const { return size >> n_inserted; }
+  std::size_t run() const { return std::size_t(1) << lo; }
+  std::size_t operator()(const std::size_t k) const {
+    auto i = insert_zero(k, lo);
+    if (n_inserted == 2) {
+      i = insert_zero(i, hi);
+    }
+    return i | cbit;
+  }
+};
+
+// Vector operations on interleaved complex amplitudes. width is the
+// number of complex values per register, 1 where no SIMD kernels exist.
+template <typename Real> struct Simd {
+  static constexpr std::size_t width = 1;
+};
+#if defined(__AVX512F__)
+template <> struct Simd<double> {
+  static constexpr std::size_t width = 4;
+  using type = __m512d;
+  static type load(const std::complex<double> *p) {
+    return _mm512_loadu_pd(reinterpret_cast<const double *>(p));
+  }
+  static void store(std::complex<double> *p, const type v) {
+    _mm512_storeu_pd(reinterpret_cast<double *>(p), v);
+  }
+  static type set1(const double x) { return _mm512_set1_pd(x); }
+  static type add(const type a, const type b) { return _mm512_add_pd(a, b); }
+  // (re + i im) * v for interleaved complex v
+  static type cmul(const type re, const type im, const type v) {
+    return _mm512_fmaddsub_pd(re, v,
+                              _mm512_mul_pd(im, _mm512_permute_pd(v, 0x55)));
+  }
+  // a * b + c
+  static type fmadd(const type a, const type b, const type c) {
+    return _mm512_fmadd_pd(a, b, c);
+  }
+  // a - b on the real parts, a + b on the imaginary parts
+  static type addsub(const type a, const type b) {
+    return _mm512_fmaddsub_pd(_mm512_set1_pd(1.0), a, b);
+  }
+};
+template <> struct Simd<float> {
+  static constexpr std::size_t width = 8;
+  using type = __m512;
+  static type load(const std::complex<float> *p) {
+    return _mm512_loadu_ps(reinterpret_cast<const float *>(p));
+  }
+  static void store(std::complex<float> *p, const type v) {
+    _mm512_storeu_ps(reinterpret_cast<float *>(p), v);
+  }
+  static type set1(const float x) { return _mm512_set1_ps(x); }
+  static type add(const type a, const type b) { return _mm512_add_ps(a, b); }
+  static type cmul(const type re, const type im, const type v) {
+    return _mm512_fmaddsub_ps(re, v,
+                              _mm512_mul_ps(im, _mm512_permute_ps(v, 0xB1)));
+  }
+  static type fmadd(const type a, const type b, const type c) {
+    return _mm512_fmadd_ps(a, b, c);
+  }
+  static type addsub(const type a, const type b) {
+    return _mm512_fmaddsub_ps(_mm512_set1_ps(1.0f), a, b);
+  }
+};
+#elif defined(__AVX2__)
+template <> struct Simd<double> {
+  static constexpr std::size_t width = 2;
+  using type = __m256d;
+  static type load(const std::complex<double> *p) {
+    return _mm256_loadu_pd(reinterpret_cast<const double *>(p));
+  }
+  static void store(std::complex<double> *p, const type v) {
+    _mm256_storeu_pd(reinterpret_cast<double *>(p), v);
+  }
+  static type set1(const double x) { return _mm256_set1_pd(x); }
+  static type add(const type a, const type b) { return _mm256_add_pd(a, b); }
+  static type cmul(const type re, const type im, const type v) {
+    return _mm256_addsub_pd(_mm256_mul_pd(re, v),
+                            _mm256_mul_pd(im, _mm256_permute_pd(v, 0x5)));
+  }
+  static type fmadd(const type a, const type b, const type c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+  }
+  static type addsub(const type a, const type b) {
+    return _mm256_addsub_pd(a, b);
+  }
+};
+template <> struct Simd<float> {
+  static constexpr std::size_t width = 4;
+  using type = __m256;
+  static type load(const std::complex<float> *p) {
+    return _mm256_loadu_ps(reinterpret_cast<const float *>(p));
+  }
+  static void store(std::complex<float> *p, const type v) {
+    _mm256_storeu_ps(reinterpret_cast<float *>(p), v);
+  }
+  static type set1(const float x) { return _mm256_set1_ps(x); }
+  static type add(const type a, const type b) { return _mm256_add_ps(a, b); }
+  static type cmul(const type re, const type im, const type v) {
+    return _mm256_addsub_ps(_mm256_mul_ps(re, v),
+                            _mm256_mul_ps(im, _mm256_permute_ps(v, 0xB1)));
+  }
+  static type fmadd(const type a, const type b, const type c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+  }
+  static type addsub(const type a, const type b) {
+    return _mm256_addsub_ps(a, b);
+  }
+};
+#endif
+
+
+} // namespace
+} // namespace sv
+} // namespace qcor
+
+#endif
@@ -0,0 +1,573 @@
+#include "qcor_sv_accelerator.hpp"
+#include "qcor_histogram.hpp"
+#include "state_vector_kernels.hpp"
+#include "xacc.hpp"
+#include "xacc_internal_compiler.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace quantum;
+
+namespace {
+// Reference: apply the 2x2 matrix m to target, optionally controlled
+void reference_apply(std::vector<std::complex<double>> &state,
+                     const unsigned target, const int control,
+                     const std::complex<double> m[4]) {
+  for (std::size_t i = 0; i < state.size(); i++) {
+    if ((i >> target & 1) || (control >= 0 && !(i >> control & 1))) {
+      continue;
+    }
+    const auto j = i | (std::size_t(1) << target);
+    const auto a = state[i], b = state[j];
+    state[i] = m[0] * a + m[1] * b;
+    state[j] = m[2] * a + m[3] * b;
+  }
+}
+
+GateTape random_tape(const int n_qubits, const int n_gates,
+                     std::mt19937 &rng) {
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  const std::vector<GateOp> ops{GateOp::H,    GateOp::X,      GateOp::Y,
+                                GateOp::Z,    GateOp::S,      GateOp::T,
+                                GateOp::Rx,   GateOp::Ry,     GateOp::Rz,
+                                GateOp::U,    GateOp::CNOT,   GateOp::CZ,
+                                GateOp::CY,   GateOp::Swap,   GateOp::CPhase,
+                                GateOp::CRZ};
+  GateTape tape;
+  for (int g = 0; g < n_gates; g++) {
+    const auto op = ops[rng() % ops.size()];
+    const std::size_t a = rng() % n_qubits;
+    const std::size_t b = (a + 1 + rng() % (n_qubits - 1)) % n_qubits;
+    std::vector<double> params{angle(rng), angle(rng), angle(rng)};
+    if (gate_n_qubits(op) == 1) {
+      tape.add(op, {"q", a}, params);
+    } else {
+      tape.add(op, {"q", a}, {"q", b}, params);
+    }
+  }
+  return tape;
+}
+
+std::shared_ptr<xacc::CompositeInstruction>
+tape_program(const GateTape &tape, const std::string &name) {
+  auto provider = xacc::getIRProvider("quantum");
+  auto program = provider->createComposite(name);
+  for (auto &gate : tape.gates()) {
+    std::vector<std::size_t> bits{gate.bit[0]};
+    if (gate_n_qubits(gate.op) == 2) {
+      bits.push_back(gate.bit[1]);
+    }
+    std::vector<xacc::InstructionParameter> params(
+        gate.params, gate.params + gate_n_params(gate.op));
+    program->addInstruction(
+        provider->createInstruction(gate_name(gate.op), bits, params));
+  }
+  return program;
+}
+} // namespace
+
+TEST(StateVectorTester, checkKernels) {
+  const std::complex<double> I(0.0, 1.0);
+  const double s = 1.0 / std::sqrt(2.0);
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+
+  // Large enough for the vectorized and threaded paths
+  for (int n : {1, 3, 6, 15}) {
+    qcor::sv::StateVector state(n);
+    std::vector<std::complex<double>> expected(state.size(), 0.0);
+    expected[0] = 1.0;
+    for (int g = 0; g < 100; g++) {
+      const bool two_qubit = n > 1 && rng() % 2;
+      unsigned qubits[2] = {unsigned(rng() % n), 0};
+      qubits[1] = two_qubit ? (qubits[0] + 1 + rng() % (n - 1)) % n : 0;
+      const double params[3] = {angle(rng), angle(rng), angle(rng)};
+      const double t = params[0];
+      const int control = two_qubit ? qubits[0] : -1;
+      const unsigned target = two_qubit ? qubits[1] : qubits[0];
+
+      GateOp op;
+      std::vector<std::complex<double>> m;
+      switch (rng() % 4) {
+      case 0:
+        op = two_qubit ? GateOp::CH : GateOp::H;
+        m = {s, s, s, -s};
+        break;
+      case 1:
+        op = two_qubit ? GateOp::CNOT : GateOp::X;
+        m = {0.0, 1.0, 1.0, 0.0};
+        break;
+      case 2:
+        op = two_qubit ? GateOp::CY : GateOp::Ry;
+        m = two_qubit ? std::vector<std::complex<double>>{0.0, -I, I, 0.0}
+                      : std::vector<std::complex<double>>{
+                            std::cos(t / 2), -std::sin(t / 2),
+                            std::sin(t / 2), std::cos(t / 2)};
+        break;
+      default:
+        op = two_qubit ? GateOp::CRZ : GateOp::Rz;
+        m = {std::exp(-I * t / 2.0), 0.0, 0.0, std::exp(I * t / 2.0)};
+        break;
+      }
+      state.apply(op, qubits, params);
+      reference_apply(expected, target, control, m.data());
+    }
+    for (std::size_t i = 0; i < state.size(); i++) {
+      EXPECT_NEAR(expected[i].real(), state.data()[i].real(), 1e-9);
+      EXPECT_NEAR(expected[i].imag(), state.data()[i].imag(), 1e-9);
+    }
+  }
+}
+
+TEST(StateVectorTester, checkKernelIsas) {
+  // The kernels picked for this CPU against the baseline build
+  std::mt19937 rng(13);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  const auto baseline = qcor::sv::generic::kernel_table<double>();
+  const int n = 12;
+  qcor::sv::StateVector state(n), expected(n);
+  for (int g = 0; g < 200; g++) {
+    const auto op = rng() % 2 ? GateOp::U : GateOp::CRZ;
+    unsigned qubits[2] = {unsigned(rng() % n), 0};
+    qubits[1] = (qubits[0] + 1 + rng() % (n - 1)) % n;
+    const double params[3] = {angle(rng), angle(rng), angle(rng)};
+    state.apply(op, qubits, params);
+    baseline.apply_gate(expected.data(), expected.size(), op, qubits, params,
+                        false);
+  }
+  std::vector<qcor::sv::amplitude_t> m(1 << 6);
+  for (auto &entry : m) {
+    entry = {angle(rng), angle(rng)};
+  }
+  const unsigned dense_qubits[3] = {0, 4, 9};
+  state.apply_dense(dense_qubits, 3, m.data());
+  baseline.apply_dense(expected.data(), expected.size(), dense_qubits, 3,
+                       m.data(), false);
+  for (std::size_t i = 0; i < state.size(); i++) {
+    EXPECT_NEAR(0.0, std::abs(state.data()[i] - expected.data()[i]), 1e-9)
+        << qcor::sv::kernel_isa();
+  }
+}
+
+TEST(StateVectorTester, checkBellShots) {
+  qcor::StateVectorAccelerator acc;
+  acc.initialize({{"shots", 1024}, {"seed", 7}});
+
+  GateTape tape;
+  tape.add(GateOp::H, {"q", 0});
+  tape.add(GateOp::CNOT, {"q", 0}, {"q", 1});
+  tape.add(GateOp::Measure, {"q", 0});
+  tape.add(GateOp::Measure, {"q", 1});
+
+  auto buffer = xacc::qalloc(2);
+  auto raw = buffer.get();
+  acc.execute(&raw, 1, tape);
+  auto counts = buffer->getMeasurementCounts();
+  EXPECT_EQ(2, counts.size());
+  EXPECT_EQ(1024, counts["00"] + counts["11"]);
+  EXPECT_NEAR(0.5, (double)counts["00"] / 1024, 0.1);
+}
+
+TEST(StateVectorTester, checkPackedCounts) {
+  GateTape tape;
+  tape.add(GateOp::H, {"q", 0});
+  tape.add(GateOp::CNOT, {"q", 0}, {"q", 2});
+  tape.add(GateOp::Measure, {"q", 0});
+  tape.add(GateOp::Measure, {"q", 2});
+
+  // Tableau and state vector paths
+  for (bool stabilizer : {true, false}) {
+    qcor::StateVectorAccelerator acc;
+    acc.initialize({{"shots", 1000},
+                    {"seed", 7},
+                    {"packed-counts", true},
+                    {"stabilizer", stabilizer}});
+    auto buffer = xacc::qalloc(3);
+    auto raw = buffer.get();
+    acc.execute(&raw, 1, tape);
+    EXPECT_TRUE(buffer->getMeasurementCounts().empty());
+    auto counts = qcor::Histogram::from_buffer(buffer.get());
+    EXPECT_EQ(2, counts.size());
+    EXPECT_EQ(1000, counts.count_of("00") + counts.count_of("11"));
+    EXPECT_NEAR(1.0, buffer->getExpectationValueZ(), 1e-12);
+  }
+}
+
+TEST(StateVectorTester, checkTerminalSampling) {
+  // q2 in cos(0.6)|0> + sin(0.6)|1>, copied to q0; q1 stays |0>
+  GateTape tape;
+  tape.add(GateOp::Ry, {"q", 2}, {1.2});
+  tape.add(GateOp::CNOT, {"q", 2}, {"q", 0});
+  tape.add(GateOp::T, {"q", 1});
+  tape.add(GateOp::Measure, {"q", 2});
+  tape.add(GateOp::Measure, {"q", 1});
+  tape.add(GateOp::Measure, {"q", 0});
+
+  const int shots = 100000;
+  qcor::StateVectorAccelerator acc;
+  acc.initialize({{"shots", shots}, {"seed", 3}});
+  auto buffer = xacc::qalloc(3);
+  auto raw = buffer.get();
+  acc.execute(&raw, 1, tape);
+  auto counts = buffer->getMeasurementCounts();
+  EXPECT_EQ(2, counts.size());
+  EXPECT_EQ(shots, counts["000"] + counts["101"]);
+  EXPECT_NEAR(std::sin(0.6) * std::sin(0.6), (double)counts["101"] / shots,
+              0.01);
+}
+
+TEST(StateVectorTester, checkCacheBlocking) {
+  // Same circuit with and without the blocked, reordered layout
+  std::mt19937 rng(3);
+  auto tape = random_tape(10, 500, rng);
+  for (std::size_t q = 0; q < 10; q += 3) {
+    tape.add(GateOp::Measure, {"q", q});
+  }
+
+  std::vector<double> results;
+  for (int block_qubits : {20, 4}) {
+    qcor::StateVectorAccelerator acc;
+    acc.initialize({{"block-qubits", block_qubits}});
+    auto buffer = xacc::qalloc(10);
+    auto raw = buffer.get();
+    acc.execute(&raw, 1, tape);
+    results.push_back(buffer->getExpectationValueZ());
+  }
+  EXPECT_NEAR(results[0], results[1], 1e-9);
+}
+
+TEST(StateVectorTester, checkAgainstQpp) {
+  std::mt19937 rng(5);
+  auto tape = random_tape(6, 200, rng);
+
+  auto provider = xacc::getIRProvider("quantum");
+  auto program = tape_program(tape, "random");
+  for (std::size_t q = 0; q < 6; q++) {
+    program->addInstruction(provider->createInstruction("Measure", {q}));
+  }
+
+  auto qpp_buffer = xacc::qalloc(6);
+  xacc::getAccelerator("qpp")->execute(qpp_buffer, program);
+  auto sv_buffer = xacc::qalloc(6);
+  xacc::getAccelerator("qcor-sv")->execute(sv_buffer, program);
+  EXPECT_NEAR(qpp_buffer->getExpectationValueZ(),
+              sv_buffer->getExpectationValueZ(), 1e-6);
+}
+
+TEST(StateVectorTester, checkCliffordDispatch) {
+  // Far beyond the state vector limit, only runs on the stabilizer path
+  const std::size_t n = 200;
+  GateTape tape;
+  tape.add(GateOp::H, {"q", 0});
+  for (std::size_t q = 1; q < n; q++) {
+    tape.add(GateOp::CNOT, {"q", q - 1}, {"q", q});
+  }
+  for (std::size_t q = 0; q < n; q++) {
+    tape.add(GateOp::Measure, {"q", q});
+  }
+  EXPECT_TRUE(tape.is_clifford());
+
+  qcor::StateVectorAccelerator acc;
+  acc.initialize({{"shots", 100}});
+  auto buffer = xacc::qalloc(n);
+  auto raw = buffer.get();
+  acc.execute(&raw, 1, tape);
+  for (auto &[bitstring, count] : buffer->getMeasurementCounts()) {
+    EXPECT_TRUE(bitstring == std::string(n, '0') ||
+                bitstring == std::string(n, '1'));
+  }
+}
+
+TEST(StateVectorTester, checkExactExpectation) {
+  auto provider = xacc::getIRProvider("quantum");
+  auto bell = provider->createComposite("bell");
+  bell->addInstruction(provider->createInstruction("H", {0}));
+  bell->addInstruction(provider->createInstruction("CNOT", {0, 1}));
+
+  qcor::PauliSum obs;
+  obs.add_term(0.5, {{0, "Z"}, {1, "Z"}});
+  obs.add_term(1.0, {{0, "X"}, {1, "X"}});
+  obs.add_term(1.0, {{0, "Y"}, {1, "Y"}});
+  obs.add_term(1.0, {{0, "Z"}});
+  // Beyond the register, which stays in |0>
+  obs.add_term(1.0, {{5, "X"}});
+  obs.add_term(1.0, {{5, "Z"}, {0, "Z"}, {1, "Z"}});
+
+  // Also through the reordered, cache blocked layout
+  for (int block_qubits : {20, 1}) {
+    qcor::StateVectorAccelerator acc;
+    acc.initialize({{"block-qubits", block_qubits}});
+    EXPECT_TRUE(acc.exact_expectations());
+    auto buffer = xacc::qalloc(2);
+    auto exp_vals = acc.pauli_expectations(buffer.get(), bell, obs);
+    const std::vector<double> expected{1.0, 1.0, -1.0, 0.0, 0.0, 1.0};
+    for (std::size_t t = 0; t < expected.size(); t++) {
+      EXPECT_NEAR(expected[t], exp_vals[t], 1e-12);
+    }
+  }
+}
+
+TEST(StateVectorTester, checkBatchedKernels) {
+  // Each lane against its own StateVector, same gates, different angles
+  std::mt19937 rng(13);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  for (int n : {2, 5, 13}) {
+    const std::size_t lanes = 5;
+    const auto structure = random_tape(n, 150, rng);
+    qcor::sv::BatchedStateVector batched(n, lanes);
+    std::vector<qcor::sv::StateVector> states(lanes, qcor::sv::StateVector(n));
+    std::vector<double> params(3 * lanes);
+    for (auto &gate : structure.gates()) {
+      const unsigned qubits[2] = {unsigned(gate.bit[0]),
+                                  unsigned(gate.bit[1])};
+      for (std::size_t l = 0; l < lanes; l++) {
+        for (int i = 0; i < 3; i++) {
+          params[3 * l + i] = angle(rng);
+        }
+        states[l].apply(gate.op, qubits, &params[3 * l]);
+      }
+      batched.apply(gate.op, qubits, params.data());
+    }
+
+    std::vector<std::uint64_t> x, z;
+    for (int t = 0; t < 20; t++) {
+      x.push_back(rng() % (std::uint64_t(1) << n));
+      z.push_back(rng() % (std::uint64_t(1) << n));
+    }
+    const auto batched_vals = batched.expectation_paulis(x, z);
+    for (std::size_t l = 0; l < lanes; l++) {
+      for (std::size_t i = 0; i < states[l].size(); i++) {
+        EXPECT_NEAR(std::abs(states[l].data()[i] - batched.amplitude(i, l)),
+                    0.0, 1e-9);
+      }
+      const auto vals = states[l].expectation_paulis(x, z);
+      for (std::size_t t = 0; t < x.size(); t++) {
+        EXPECT_NEAR(vals[t], batched_vals[t * lanes + l], 1e-9);
+      }
+    }
+  }
+}
+
+TEST(StateVectorTester, checkBatchedExpectation) {
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  const auto structure = random_tape(4, 60, rng);
+  std::vector<std::shared_ptr<xacc::CompositeInstruction>> programs;
+  for (int k = 0; k < 7; k++) {
+    GateTape tape;
+    for (auto &gate : structure.gates()) {
+      std::vector<double> params{angle(rng), angle(rng), angle(rng)};
+      if (gate_n_qubits(gate.op) == 1) {
+        tape.add(gate.op, {"q", gate.bit[0]}, params);
+      } else {
+        tape.add(gate.op, {"q", gate.bit[0]}, {"q", gate.bit[1]}, params);
+      }
+    }
+    programs.push_back(tape_program(tape, "ansatz"));
+  }
+
+  qcor::PauliSum obs;
+  obs.add_term(1.0, {{0, "Z"}, {1, "Z"}});
+  obs.add_term(1.0, {{0, "X"}, {2, "Y"}, {3, "Z"}});
+  obs.add_term(1.0, {{1, "Y"}});
+
+  // Batches of 3 leave a partial last batch
+  qcor::StateVectorAccelerator acc;
+  acc.initialize({{"batch-size", 3}});
+  auto buffer = xacc::qalloc(4);
+  const auto batched = acc.pauli_expectations(buffer.get(), programs, obs);
+  ASSERT_EQ(programs.size(), batched.size());
+  for (std::size_t k = 0; k < programs.size(); k++) {
+    const auto single = acc.pauli_expectations(buffer.get(), programs[k], obs);
+    for (std::size_t t = 0; t < obs.n_terms(); t++) {
+      EXPECT_NEAR(single[t], batched[k][t], 1e-9);
+    }
+  }
+}
+
+TEST(StateVectorTester, checkSinglePrecision) {
+  // Float amplitudes track the double ones to rounding, including
+  // through the vectorized and threaded paths
+  std::mt19937 rng(17);
+  for (int n : {3, 8, 15}) {
+    const auto tape = random_tape(n, 300, rng);
+    qcor::sv::StateVector exact(n);
+    qcor::sv::StateVectorF single(n);
+    for (auto &gate : tape.gates()) {
+      unsigned qubits[2] = {unsigned(gate.bit[0]), unsigned(gate.bit[1])};
+      exact.apply(gate.op, qubits, gate.params);
+      single.apply(gate.op, qubits, gate.params);
+    }
+    double error = 0.0, norm = 0.0;
+    for (std::size_t i = 0; i < exact.size(); i++) {
+      const std::complex<double> a(single.data()[i]);
+      error = std::max(error, std::abs(a - exact.data()[i]));
+      norm += std::norm(a);
+    }
+    EXPECT_NEAR(0.0, error, 1e-5);
+    EXPECT_NEAR(1.0, norm, 1e-4);
+    const std::uint64_t mask = (std::uint64_t(1) << n) - 1;
+    EXPECT_NEAR(exact.expectation_z(mask), single.expectation_z(mask), 1e-4);
+  }
+
+  // Through the accelerator, set as in -qpu qcor-sv:single
+  auto tape = random_tape(10, 400, rng);
+  for (std::size_t q = 0; q < 10; q++) {
+    tape.add(GateOp::Measure, {"q", q});
+  }
+  std::vector<double> results;
+  for (auto precision : {"double", "single"}) {
+    qcor::StateVectorAccelerator acc;
+    acc.initialize({{"backend", std::string(precision)}, {"block-qubits", 4}});
+    auto buffer = xacc::qalloc(10);
+    auto raw = buffer.get();
+    acc.execute(&raw, 1, tape);
+    results.push_back(buffer->getExpectationValueZ());
+  }
+  EXPECT_NEAR(results[0], results[1], 1e-4);
+}
+
+TEST(StateVectorTester, checkGateFusion) {
+  // Fused blocks against their gates applied one by one, on qubits spread
+  // out so both the vectorized and the scalar dense kernels run
+  std::mt19937 rng(19);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  const std::size_t n = 12;
+  for (unsigned max_qubits : {2, 3, 4, 5}) {
+    qcor::sv::StateVector state(n), expected(n);
+    for (unsigned q = 0; q < n; q++) {
+      const double params[3] = {angle(rng), angle(rng), angle(rng)};
+      state.apply(GateOp::U, &q, params);
+      expected.apply(GateOp::U, &q, params);
+    }
+    const auto tape = random_tape(n, 200, rng);
+    qcor::sv::GateFuser fuser(max_qubits);
+    std::vector<qcor::sv::GateBlock> blocks;
+    for (std::size_t g = 0; g < tape.size(); g++) {
+      const auto &gate = tape.gates()[g];
+      unsigned qubits[2] = {unsigned(gate.bit[0]), unsigned(gate.bit[1])};
+      expected.apply(gate.op, qubits, gate.params);
+      fuser.add(g, gate.op, qubits, gate.params);
+      for (auto &block : fuser.take_closed()) {
+        blocks.push_back(std::move(block));
+      }
+    }
+    fuser.close_all();
+    for (auto &block : fuser.take_closed()) {
+      blocks.push_back(std::move(block));
+    }
+
+    std::size_t n_gates = 0;
+    for (auto &block : blocks) {
+      EXPECT_TRUE(block.qubits.size() <= max_qubits);
+      n_gates += block.gates.size();
+      const auto fused = block.fuse();
+      state.apply_dense(fused.qubits.data(), fused.qubits.size(),
+                        fused.matrix.data());
+    }
+    EXPECT_EQ(tape.size(), n_gates);
+    EXPECT_TRUE(blocks.size() < tape.size() / 2);
+    for (std::size_t i = 0; i < state.size(); i++) {
+      EXPECT_NEAR(0.0, std::abs(state.data()[i] - expected.data()[i]),
+                  1e-12);
+    }
+  }
+
+  // Through the accelerator: same result, fewer passes over the state
+  auto tape = random_tape(12, 600, rng);
+  for (std::size_t q = 0; q < 12; q++) {
+    tape.add(GateOp::Measure, {"q", q});
+  }
+  std::vector<double> results;
+  std::vector<int> passes;
+  for (int fusion_qubits : {0, 2, 3, 4, 5}) {
+    qcor::StateVectorAccelerator acc;
+    acc.initialize({{"fusion-qubits", fusion_qubits}, {"block-qubits", 20}});
+    auto buffer = xacc::qalloc(12);
+    auto raw = buffer.get();
+    acc.execute(&raw, 1, tape);
+    results.push_back(buffer->getExpectationValueZ());
+    passes.push_back(buffer->getInformation("sv-state-passes").as<int>());
+    // Every fused block replaces its gates with one pass
+    const auto fused = buffer->getInformation("sv-fused-gates").as<int>();
+    const auto blocks = buffer->getInformation("sv-fused-blocks").as<int>();
+    EXPECT_EQ(600 - fused + blocks, passes.back());
+  }
+  for (std::size_t k = 1; k < results.size(); k++) {
+    EXPECT_NEAR(results[0], results[k], 1e-9);
+    EXPECT_TRUE(passes[k] < passes[0]);
+  }
+}
+
+TEST(StateVectorTester, checkStreaming) {
+  // Feed the tape in chunks of 64 gates, as the QRT does when streaming
+  std::mt19937 rng(23);
+  auto tape = random_tape(12, 600, rng);
+  for (std::size_t q = 0; q < 12; q += 2) {
+    tape.add(GateOp::Measure, {"q", q});
+  }
+  std::vector<GateTape> chunks;
+  for (std::size_t g = 0; g < tape.size(); g++) {
+    if (g % 64 == 0) {
+      chunks.emplace_back();
+    }
+    const auto &gate = tape.gates()[g];
+    const std::vector<double> params(gate.params,
+                                     gate.params + gate_n_params(gate.op));
+    if (gate_n_qubits(gate.op) == 1) {
+      chunks.back().add(gate.op, {"q", gate.bit[0]}, params);
+    } else {
+      chunks.back().add(gate.op, {"q", gate.bit[0]}, {"q", gate.bit[1]},
+                        params);
+    }
+  }
+
+  for (auto precision : {"double", "single"}) {
+    qcor::StateVectorAccelerator acc;
+    acc.initialize({{"precision", std::string(precision)}});
+    auto whole = xacc::qalloc(12), streamed = xacc::qalloc(12);
+    auto raw = whole.get();
+    acc.execute(&raw, 1, tape);
+    raw = streamed.get();
+    acc.begin_stream(&raw, 1);
+    for (auto &chunk : chunks) {
+      acc.execute_chunk(chunk);
+    }
+    acc.end_stream();
+    EXPECT_NEAR(whole->getExpectationValueZ(),
+                streamed->getExpectationValueZ(), 1e-5);
+    EXPECT_TRUE(streamed->getInformation("sv-fused-blocks").as<int>() > 0);
+  }
+
+  // Gate by gate over two registers, a Bell pair sampled at the end
+  qcor::StateVectorAccelerator acc;
+  acc.initialize({{"shots", 1000}, {"seed", 5}});
+  auto a = std::make_shared<xacc::AcceleratorBuffer>("a", 2);
+  auto b = std::make_shared<xacc::AcceleratorBuffer>("b", 2);
+  xacc::AcceleratorBuffer *buffers[2] = {b.get(), a.get()};
+  acc.begin_stream(buffers, 2);
+  GateTape chunk;
+  chunk.add(GateOp::H, {"a", 1});
+  acc.execute_chunk(chunk);
+  chunk.clear();
+  chunk.add(GateOp::CNOT, {"a", 1}, {"b", 0});
+  acc.execute_chunk(chunk);
+  chunk.clear();
+  chunk.add(GateOp::Measure, {"a", 1});
+  chunk.add(GateOp::Measure, {"b", 0});
+  acc.execute_chunk(chunk);
+  acc.end_stream();
+  auto counts_a = a->getMeasurementCounts();
+  auto counts_b = b->getMeasurementCounts();
+  EXPECT_EQ(1000, counts_a["0"] + counts_a["1"]);
+  EXPECT_EQ(counts_a["1"], counts_b["1"]);
+  EXPECT_NEAR(0.5, counts_a["1"] / 1000.0, 0.1);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
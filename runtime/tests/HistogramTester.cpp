@@ -0,0 +1,96 @@
+#include "qcor_histogram.hpp"
+#include "AcceleratorBuffer.hpp"
+#include "xacc.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace qcor;
+
+TEST(HistogramTester, checkCounts) {
+  Histogram h(3);
+  h.add("101");
+  h.add("011", 4);
+  h.add(std::uint64_t(5), 2); // bits 0 and 2, "101"
+  EXPECT_EQ(2, h.size());
+  EXPECT_EQ(7, h.total());
+  EXPECT_EQ(3, h.count_of("101"));
+  EXPECT_EQ(4, h.count_of("011"));
+  EXPECT_EQ(0, h.count_of("111"));
+  EXPECT_TRUE(h.bit(0, 0));
+  EXPECT_FALSE(h.bit(0, 1));
+
+  // Sorted by key, "101" = 5 before "011" = 6
+  EXPECT_EQ("101", h.bitstring(0));
+  EXPECT_EQ("011", h.bitstring(1));
+
+  // Both outcomes have even parity
+  EXPECT_NEAR(1.0, h.expectation_z(), 1e-12);
+  h.add("100");
+  EXPECT_NEAR(6.0 / 8.0, h.expectation_z(), 1e-12);
+
+  auto map = h.to_map();
+  EXPECT_EQ(3, map.size());
+  EXPECT_EQ(3, map["101"]);
+  auto back = Histogram::from_map(map);
+  EXPECT_EQ(h.size(), back.size());
+  EXPECT_EQ(1, back.count_of("100"));
+}
+
+TEST(HistogramTester, checkWideKeys) {
+  // Keys across word boundaries, merged from two histograms
+  std::string a(130, '0'), b(130, '0');
+  a[0] = a[64] = a[129] = '1';
+  b[63] = '1';
+  Histogram h(130), other(130);
+  EXPECT_EQ(3, h.n_words());
+  h.add(a, 2);
+  other.add(b);
+  other.add(a);
+  h.merge(other);
+  EXPECT_EQ(2, h.size());
+  EXPECT_EQ(3, h.count_of(a));
+  EXPECT_EQ(1, h.count_of(b));
+  EXPECT_EQ(b, h.bitstring(0));
+  EXPECT_EQ(a, h.bitstring(1));
+  EXPECT_TRUE(h.bit(1, 129));
+  EXPECT_NEAR((-3.0 - 1.0) / 4.0, h.expectation_z(), 1e-12);
+}
+
+TEST(HistogramTester, checkBuffer) {
+  auto buffer = xacc::qalloc(4);
+  Histogram h(4);
+  h.add("1100", 10);
+  h.add("0011", 5);
+  h.append_to(buffer.get());
+  // Appending again accumulates, like appendMeasurement
+  h.append_to(buffer.get());
+  buffer->appendMeasurement("1111", 1);
+
+  auto read = Histogram::from_buffer(buffer.get());
+  EXPECT_EQ(3, read.size());
+  EXPECT_EQ(20, read.count_of("1100"));
+  EXPECT_EQ(10, read.count_of("0011"));
+  EXPECT_EQ(1, read.count_of("1111"));
+}
+
+TEST(HistogramTester, checkMemory) {
+  // 10^6 shots of 25 random bits, nearly all outcomes distinct
+  std::mt19937_64 rng(11);
+  const std::size_t n_bits = 25, shots = 1000000;
+  Histogram h(n_bits);
+  for (std::size_t s = 0; s < shots; s++) {
+    h.add(rng() & ((std::uint64_t(1) << n_bits) - 1));
+  }
+  EXPECT_EQ(shots, h.total());
+  EXPECT_TRUE(h.size() > shots * 9 / 10);
+  // 16 bytes an entry, against ~128 for the std::map<std::string, int>
+  EXPECT_TRUE(h.memory_bytes() <= 16 * h.size());
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -0,0 +1,6 @@
+#include "qcor.hpp"
+
+// A second translation unit including qcor.hpp, linked into LinkTester
+std::string all_zs_from_helper(const int n) {
+  return qcor::allZs(n).toString();
+}
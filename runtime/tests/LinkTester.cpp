@@ -0,0 +1,19 @@
+#include "qcor.hpp"
+#include <gtest/gtest.h>
+
+std::string all_zs_from_helper(const int n);
+
+// Both translation units include qcor.hpp, so this only links if the
+// header defines nothing out of line
+TEST(LinkTester, checkTwoTranslationUnits) {
+  EXPECT_EQ(qcor::allZs(3).toString(), all_zs_from_helper(3));
+  EXPECT_EQ((qcor::Z(0) * qcor::Z(1)).toString(), all_zs_from_helper(2));
+
+  auto op = qcor::X(0);
+  EXPECT_EQ((1.5 + op).toString(), (op + 1.5).toString());
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
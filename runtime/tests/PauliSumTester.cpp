@@ -0,0 +1,162 @@
+#include "qcor_pauli.hpp"
+#include "qcor_pauli_io.hpp"
+#include "PauliOperator.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+using namespace qcor;
+
+TEST(PauliSumTester, checkProduct) {
+  // XY = iZ, YX = -iZ
+  auto xy = PauliSum::X(0) * PauliSum::Y(0);
+  EXPECT_EQ(1, xy.n_terms());
+  EXPECT_EQ('Z', xy.op(0, 0));
+  EXPECT_NEAR(1.0, std::imag(xy.coefficient(0)), 1e-12);
+
+  auto yx = PauliSum::Y(0) * PauliSum::X(0);
+  EXPECT_NEAR(-1.0, std::imag(yx.coefficient(0)), 1e-12);
+
+  // (X0 + Z0)^2 = 2 I, XZ and ZX cancel
+  auto sum = PauliSum::X(0) + PauliSum::Z(0);
+  auto sq = sum * sum;
+  EXPECT_EQ(1, sq.n_terms());
+  EXPECT_EQ(0, sq.weight(0));
+  EXPECT_NEAR(2.0, std::real(sq.coefficient(0)), 1e-12);
+
+  // Qubit indices across word boundaries
+  auto zz = PauliSum::Z(3) * PauliSum::Z(100);
+  EXPECT_EQ(2, zz.weight(0));
+  EXPECT_TRUE(zz.is_diagonal(0));
+  EXPECT_EQ('Z', zz.op(0, 100));
+}
+
+TEST(PauliSumTester, checkCommutes) {
+  auto xx = PauliSum::X(0) * PauliSum::X(1);
+  auto zz = PauliSum::Z(0) * PauliSum::Z(1);
+  EXPECT_TRUE(xx.commutes(zz));
+  EXPECT_FALSE(PauliSum::X(0).commutes(PauliSum::Z(0)));
+
+  // Terms anti-commute pairwise but the sums commute
+  auto a = PauliSum::X(0) + PauliSum::Z(0);
+  EXPECT_TRUE(a.commutes(a));
+}
+
+TEST(PauliSumTester, checkSimplify) {
+  auto h = 2.0 * PauliSum::Z(0) + PauliSum::X(1) - PauliSum::Z(0) -
+           PauliSum::Z(0) + 0.5 * PauliSum::X(1);
+  EXPECT_EQ(1, h.n_terms());
+  EXPECT_EQ('X', h.op(0, 1));
+  EXPECT_NEAR(1.5, std::real(h.coefficient(0)), 1e-12);
+}
+
+TEST(PauliSumTester, checkAddTermByTerm) {
+  PauliSum sum, reference;
+  for (int i = 0; i < 100; i++) {
+    auto zz = PauliSum::Z(i) * PauliSum::Z(i + 1);
+    sum += zz;
+    sum += 0.5 * PauliSum::X(i);
+    reference.append(zz).append(0.5 * PauliSum::X(i));
+  }
+  EXPECT_EQ(200, sum.n_terms());
+
+  // Merged into the existing terms, and dropped when they cancel
+  sum += PauliSum::X(3);
+  sum -= PauliSum::Z(0) * PauliSum::Z(1);
+  sum -= 0.5 * PauliSum::X(99);
+  reference.append(PauliSum::X(3))
+      .append(-(PauliSum::Z(0) * PauliSum::Z(1)))
+      .append(-0.5 * PauliSum::X(99))
+      .simplify();
+  EXPECT_EQ(198, sum.n_terms());
+  EXPECT_EQ(0, (sum - reference).n_terms());
+
+  // Terms appended otherwise are merged by the next +=
+  sum.append(PauliSum::X(3));
+  sum += PauliSum(0.0);
+  EXPECT_EQ(198, sum.n_terms());
+}
+
+TEST(PauliSumTester, checkPauliOperatorConversion) {
+  xacc::quantum::PauliOperator op(
+      "5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + .21829 Z0 - 6.125 Z1");
+  auto sum = PauliSum::from_pauli_operator(op);
+  EXPECT_EQ(5, sum.n_terms());
+
+  auto back = sum.to_pauli_operator();
+  EXPECT_EQ(5, back.nTerms());
+  for (auto &[id, term] : op.getTerms()) {
+    auto other = back.getTerms();
+    EXPECT_TRUE(other.count(id));
+    EXPECT_NEAR(std::real(std::get<0>(term)), std::real(std::get<0>(other[id])),
+                1e-12);
+  }
+}
+
+TEST(PauliSumTester, checkLoadFromFile) {
+  char dir[] = "/tmp/pauli_sum_test_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+  const std::string text_file = std::string(dir) + "/h.txt";
+  const std::string binary_file = std::string(dir) + "/h.bin";
+  const std::string text_file_2 = std::string(dir) + "/h2.txt";
+  {
+    std::ofstream f(text_file);
+    f << "5.907 - 2.1433 X0X1 - 2.1433 Y0Y1\n"
+      << "+ .21829 Z0 - 6.125 Z1 + (0.5, -1e-2) X70 Z3\n";
+  }
+
+  PauliLoadStats stats;
+  auto text = load_pauli_sum(text_file, 3, &stats);
+  EXPECT_EQ(6, text.n_terms());
+  EXPECT_EQ(6, stats.n_terms);
+  EXPECT_FALSE(stats.binary);
+
+  save_pauli_sum(text, binary_file, true);
+  auto binary = load_pauli_sum(binary_file, 2, &stats);
+  EXPECT_TRUE(stats.binary);
+  EXPECT_EQ(0, (binary - text).n_terms());
+
+  save_pauli_sum(text, text_file_2);
+  auto text2 = load_pauli_sum(text_file_2);
+  EXPECT_EQ(0, (text2 - text).n_terms());
+
+  for (auto &file : {text_file, binary_file, text_file_2}) {
+    std::remove(file.c_str());
+  }
+  rmdir(dir);
+}
+
+TEST(PauliSumTester, checkCorruptBinaryHeader) {
+  char dir[] = "/tmp/pauli_sum_test_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+  const std::string file = std::string(dir) + "/h.bin";
+  auto write = [&](std::uint32_t n_words, std::uint64_t n_terms,
+                   std::size_t data_bytes) {
+    std::ofstream f(file, std::ios::binary);
+    const std::uint32_t version = 1;
+    f.write("QCORPSUM", 8);
+    f.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    f.write(reinterpret_cast<const char *>(&n_words), sizeof(n_words));
+    f.write(reinterpret_cast<const char *>(&n_terms), sizeof(n_terms));
+    f << std::string(data_bytes, '\0');
+  };
+
+  // A term record with no mask words
+  write(0, 1, 16);
+  EXPECT_DEATH(load_pauli_sum(file), "");
+  // 2^59 records of 32 bytes wrap to 0 bytes
+  write(1, std::uint64_t(1) << 59, 0);
+  EXPECT_DEATH(load_pauli_sum(file), "");
+
+  std::remove(file.c_str());
+  rmdir(dir);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  return ret;
+}
@@ -0,0 +1,99 @@
+#include "profiler.hpp"
+#include "xacc.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+using namespace quantum;
+
+TEST(ProfilerTester, checkDisabled) {
+  profiling::reset();
+  profiling::set_enabled(false);
+  {
+    profiling::Scope scope("disabled");
+    profiling::count("disabled count");
+  }
+  std::stringstream ss;
+  profiling::write_trace(ss);
+  EXPECT_EQ(ss.str().find("disabled"), std::string::npos);
+}
+
+TEST(ProfilerTester, checkTrace) {
+  profiling::reset();
+  profiling::set_enabled(true);
+  auto work = []() {
+    profiling::Scope outer("outer");
+    for (int i = 0; i < 3; i++) {
+      profiling::Scope inner("inner");
+      profiling::count("iterations");
+    }
+  };
+  work();
+  std::thread thread(work);
+  thread.join();
+  profiling::set_enabled(false);
+
+  std::stringstream trace;
+  profiling::write_trace(trace);
+  const auto json = trace.str();
+  EXPECT_EQ(json.find("{\"displayTimeUnit\": \"ms\", \"traceEvents\": ["), 0);
+  EXPECT_NE(json.find("\"name\": \"outer\", \"cat\": \"qcor\", \"ph\": \"X\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"ph\": \"C\""), std::string::npos);
+  EXPECT_NE(json.find("\"args\": {\"value\": 6}"), std::string::npos);
+  EXPECT_NE(json.find("\"tid\": 1"), std::string::npos);
+
+  std::stringstream summary;
+  profiling::write_summary(summary);
+  std::string line, name;
+  std::size_t calls = 0;
+  while (std::getline(summary, line)) {
+    std::stringstream fields(line);
+    fields >> name;
+    if (name == "inner") {
+      fields >> calls;
+    }
+  }
+  EXPECT_EQ(calls, 6);
+  profiling::reset();
+}
+
+TEST(ProfilerTester, checkConcurrentReports) {
+  profiling::reset();
+  profiling::set_enabled(true);
+  std::atomic<bool> done(false);
+  std::thread recorder([&]() {
+    while (!done) {
+      profiling::Scope scope("recorder");
+    }
+  });
+  for (int i = 0; i < 20; i++) {
+    std::stringstream ss;
+    profiling::write_trace(ss);
+    profiling::write_summary(ss);
+    profiling::reset();
+  }
+  done = true;
+  recorder.join();
+  profiling::set_enabled(false);
+  profiling::reset();
+
+  // The caller's stream formatting is left as it was
+  std::stringstream ss;
+  ss << std::setprecision(2);
+  profiling::write_trace(ss);
+  profiling::write_summary(ss);
+  ss.str("");
+  ss << 0.125;
+  EXPECT_EQ("0.12", ss.str());
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
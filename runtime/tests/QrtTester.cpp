@@ -0,0 +1,63 @@
+#include "qcor.hpp"
+#include "xacc.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+
+// Kernels written out as the QRT translates __qpu__ functions
+namespace {
+void bell(qreg q) {
+  quantum::initialize("qpp", "bell");
+  q.setNameAndStore("q");
+  quantum::h(q[0]);
+  quantum::cnot(q[0], q[1]);
+  if (__execute) {
+    quantum::submit(q.results());
+  }
+}
+
+// Ends with an xacc gate that has no GateOp, so its gate tape is unusable
+void bell_iswap(qreg q) {
+  quantum::initialize("qpp", "bell_iswap");
+  q.setNameAndStore("q");
+  quantum::h(q[0]);
+  quantum::cnot(q[0], q[1]);
+  auto iswap = quantum::provider->createInstruction(
+      "iSwap", std::vector<std::size_t>{0, 1});
+  iswap->setBufferNames({"q", "q"});
+  quantum::program->addInstruction(iswap);
+  if (__execute) {
+    quantum::submit(q.results());
+  }
+}
+} // namespace
+
+TEST(QrtTester, checkPrintKernel) {
+  auto q = qalloc(2);
+  std::stringstream ss;
+  qcor::print_kernel(ss, bell, q);
+  std::string line;
+  std::getline(ss, line);
+  EXPECT_EQ("H q0", line);
+  std::getline(ss, line);
+  EXPECT_EQ("CNOT q0,q1", line);
+}
+
+TEST(QrtTester, checkPrintKernelWithoutTape) {
+  auto q = qalloc(2);
+  qcor::__internal__::kernel_as_composite_instruction(bell_iswap, q);
+  EXPECT_EQ(nullptr, quantum::tryGetTape());
+  quantum::clearProgram();
+
+  std::stringstream ss;
+  qcor::print_kernel(ss, bell_iswap, q);
+  EXPECT_NE(std::string::npos, ss.str().find("iSwap"));
+  EXPECT_TRUE(quantum::getProgram()->getInstructions().empty());
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -0,0 +1,201 @@
+#include "qcor_aot.hpp"
+#include "qcor_tape_io.hpp"
+#include "xacc.hpp"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+
+using namespace qcor;
+using quantum::GateOp;
+using quantum::GateTape;
+
+namespace {
+GateTape make_tape() {
+  GateTape tape;
+  tape.add(GateOp::H, {"q", 0});
+  tape.add(GateOp::Rx, {"q", 1}, {0.5});
+  tape.add(GateOp::CNOT, {"q", 0}, {"anc", 2});
+  tape.add(GateOp::U, {"anc", 1}, {0.1, -0.2, 0.3});
+  tape.add(GateOp::Rx, {"q", 2}, {0.5});
+  tape.add(GateOp::CPhase, {"anc", 0}, {"q", 1}, {-0.0});
+  tape.add(GateOp::Measure, {"q", 0});
+  return tape;
+}
+
+void expect_same(const GateTape &a, const GateTape &b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (std::size_t i = 0; i < a.size(); i++) {
+    auto &ga = a.gates()[i], &gb = b.gates()[i];
+    EXPECT_EQ(ga.op, gb.op);
+    for (int q = 0; q < quantum::gate_n_qubits(ga.op); q++) {
+      EXPECT_EQ(a.registers()[ga.reg[q]], b.registers()[gb.reg[q]]);
+      EXPECT_EQ(ga.bit[q], gb.bit[q]);
+    }
+    for (int p = 0; p < quantum::gate_n_params(ga.op); p++) {
+      EXPECT_NEAR(ga.params[p], gb.params[p], 1e-12);
+    }
+  }
+}
+} // namespace
+
+TEST(TapeIOTester, checkRoundTrip) {
+  const auto tape = make_tape();
+  save_tape(tape, "tape_io_test.qtape");
+
+  TapeReader reader("tape_io_test.qtape");
+  EXPECT_EQ(7, reader.size());
+  EXPECT_EQ(std::vector<std::string>({"q", "anc"}), reader.registers());
+  // The repeated Rx(0.5) shares its parameter entry
+  EXPECT_EQ(reader.records()[1].param, reader.records()[4].param);
+  EXPECT_EQ(5, reader.n_params());
+  EXPECT_EQ(GateOp::CNOT, reader.records()[2].op);
+  expect_same(tape, reader.to_tape());
+
+  // Chunks cover the program in order
+  GateTape joined;
+  std::size_t n_chunks = 0;
+  reader.for_each_chunk(3, [&](const GateTape &chunk) {
+    EXPECT_TRUE(chunk.size() <= 3);
+    for (auto gate : chunk.gates()) {
+      joined.add(gate);
+    }
+    for (auto &name : chunk.registers()) {
+      joined.register_id(name);
+    }
+    n_chunks++;
+  });
+  EXPECT_EQ(3, n_chunks);
+  expect_same(tape, joined);
+  std::remove("tape_io_test.qtape");
+}
+
+TEST(TapeIOTester, checkSymbols) {
+  GateTape tape;
+  const auto q = tape.register_id("q");
+  {
+    TapeWriter writer("tape_io_symbols.qtape");
+    writer.add({GateOp::Ry, {q, 0}, {0, 0}, {0.25, 0, 0}}, tape.registers(),
+               {"theta"});
+    writer.add({GateOp::U, {q, 0}, {1, 0}, {0.1, 0.2, 0.3}},
+               tape.registers(), {"", "phi", "theta"});
+    writer.add({GateOp::CNOT, {q, q}, {0, 1}, {0, 0, 0}}, tape.registers());
+  }
+
+  TapeReader reader("tape_io_symbols.qtape");
+  EXPECT_EQ(std::vector<std::string>({"theta", "phi"}), reader.symbols());
+  EXPECT_EQ(3, reader.n_slots());
+  EXPECT_EQ(tape_symbolic, reader.records()[0].flags);
+  EXPECT_EQ(0, reader.records()[2].flags);
+
+  // Unbound symbols keep the written values
+  auto defaults = reader.to_tape();
+  EXPECT_NEAR(0.25, defaults.gates()[0].params[0], 1e-12);
+  EXPECT_NEAR(0.3, defaults.gates()[1].params[2], 1e-12);
+
+  auto bound = reader.to_tape({{"theta", 1.5}, {"phi", -1.0}});
+  EXPECT_NEAR(1.5, bound.gates()[0].params[0], 1e-12);
+  EXPECT_NEAR(0.1, bound.gates()[1].params[0], 1e-12);
+  EXPECT_NEAR(-1.0, bound.gates()[1].params[1], 1e-12);
+  EXPECT_NEAR(1.5, bound.gates()[1].params[2], 1e-12);
+  std::remove("tape_io_symbols.qtape");
+}
+
+TEST(TapeIOTester, checkInMemory) {
+  const auto tape = make_tape();
+  std::stringstream ss;
+  {
+    TapeWriter writer(ss);
+    writer.add(tape);
+  }
+  // As embedded by the syntax handler, see qcor_aot.hpp
+  const auto ir = ss.str();
+  std::vector<double> aligned(ir.size() / sizeof(double) + 1);
+  std::memcpy(aligned.data(), ir.data(), ir.size());
+  TapeReader reader(aligned.data(), ir.size());
+  expect_same(tape, reader.to_tape());
+
+  EXPECT_EQ(__internal__::aot_kernel_id("bell", ir.data(), ir.size()),
+            __internal__::aot_kernel_id("bell", aligned.data(), ir.size()));
+  EXPECT_NE(__internal__::aot_kernel_id("bell", ir.data(), ir.size()),
+            __internal__::aot_kernel_id("ghz", ir.data(), ir.size()));
+}
+
+TEST(TapeIOTester, checkCorruptHeader) {
+  std::stringstream ss;
+  {
+    TapeWriter writer(ss);
+    writer.add(make_tape());
+  }
+  const auto ir = ss.str();
+  std::vector<double> aligned(ir.size() / sizeof(double) + 1);
+  auto read_with = [&](const std::size_t offset, const std::uint64_t value) {
+    std::memcpy(aligned.data(), ir.data(), ir.size());
+    std::memcpy(reinterpret_cast<char *>(aligned.data()) + offset, &value,
+                sizeof(value));
+    TapeReader reader(aligned.data(), ir.size());
+    return reader.to_tape().size();
+  };
+
+  // 2^61 parameters of 8 bytes wrap to 0 bytes
+  EXPECT_DEATH(read_with(offsetof(TapeFileHeader, n_params),
+                         std::uint64_t(1) << 61),
+               "");
+  EXPECT_DEATH(read_with(offsetof(TapeFileHeader, n_slots),
+                         std::uint64_t(1) << 62),
+               "");
+  // A section starting past the next one
+  EXPECT_DEATH(read_with(offsetof(TapeFileHeader, slots_offset), 8), "");
+  EXPECT_EQ(7, read_with(offsetof(TapeFileHeader, n_gates), 7));
+}
+
+TEST(TapeIOTester, checkOpenQasm) {
+  const auto tape = make_tape();
+  std::stringstream ss;
+  write_openqasm(ss, tape);
+  EXPECT_TRUE(ss.str().find("qreg anc[3];") != std::string::npos);
+  EXPECT_TRUE(ss.str().find("cx q[0],anc[2];") != std::string::npos);
+  EXPECT_TRUE(ss.str().find("measure q[0] -> c_q[0];") != std::string::npos);
+  expect_same(tape, read_openqasm(ss));
+
+  std::stringstream src(R"(OPENQASM 2.0;
+include "qelib1.inc";
+qreg q[2];
+creg c[2];
+// comment
+h q;
+rz(-pi/2) q[1];
+u3(2*(pi/4), 0, 1.5e-1) q[0];
+cx q[0], q[1];
+measure q -> c;
+)");
+  auto read = read_openqasm(src);
+  ASSERT_EQ(7, read.size());
+  EXPECT_EQ(GateOp::H, read.gates()[1].op);
+  EXPECT_EQ(1, read.gates()[1].bit[0]);
+  EXPECT_NEAR(-M_PI / 2, read.gates()[2].params[0], 1e-12);
+  EXPECT_NEAR(M_PI / 2, read.gates()[3].params[0], 1e-12);
+  EXPECT_NEAR(0.15, read.gates()[3].params[2], 1e-12);
+  EXPECT_EQ(GateOp::CNOT, read.gates()[4].op);
+  EXPECT_EQ(GateOp::Measure, read.gates()[6].op);
+}
+
+TEST(TapeIOTester, checkPrint) {
+  std::stringstream ss;
+  print_tape(ss, make_tape());
+  std::string line;
+  std::getline(ss, line);
+  EXPECT_EQ("H q0", line);
+  std::getline(ss, line);
+  EXPECT_EQ("Rx(0.5) q1", line);
+  std::getline(ss, line);
+  EXPECT_EQ("CNOT q0,anc2", line);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
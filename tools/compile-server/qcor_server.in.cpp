@@ -0,0 +1,334 @@
+// qcor-server, a persistent compile server for the qcor driver.
+//
+// A plain qcor compile starts a new clang, which loads the syntax handler
+// and initializes XACC, its compilers and the token collectors again for
+// every source file. The server does this once: at startup it compiles a
+// small kernel, which leaves the handler loaded and XACC initialized. It
+// then forks a child per request. The child starts from that warm state and
+// runs the clang frontend in process on the client's command line. The
+// client is the driver run with -use-server.
+//
+// The protocol on the Unix socket:
+//   request  uint32 payload size, then the payload. The payload is NUL
+//            terminated strings: the working directory, then the clang
+//            arguments. The message carries the client's stdout and stderr
+//            as SCM_RIGHTS, so diagnostics reach the client's terminal.
+//   reply    int32 exit status. -1 means the command line needs more than
+//            a single compile job, so the client runs clang itself.
+//
+// Children run with the environment of the server, not of the client.
+//
+// The socket is qcor-server.sock in $XDG_RUNTIME_DIR, or else server.sock
+// in /tmp/qcor-<uid>, a directory created with mode 0700. The server will
+// not use a socket directory that other users can write to. Both ends
+// check with SO_PEERCRED that the other runs as the same user.
+
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Driver/Compilation.h"
+#include "clang/Driver/Driver.h"
+#include "clang/Driver/Job.h"
+#include "clang/Driver/Tool.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/FrontendTool/Utils.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace clang::driver;
+using namespace clang;
+using namespace llvm;
+
+namespace {
+
+const char *clang_executable = "@CLANG_EXECUTABLE@";
+
+std::string default_socket_path() {
+  if (auto path = std::getenv("QCOR_SERVER_SOCKET")) {
+    return path;
+  }
+  if (auto dir = std::getenv("XDG_RUNTIME_DIR")) {
+    if (*dir) {
+      return std::string(dir) + "/qcor-server.sock";
+    }
+  }
+  return "/tmp/qcor-" + std::to_string(getuid()) + "/server.sock";
+}
+
+// Create the directory of the socket if needed. Fails if the directory
+// is not ours or others can write to it, as they could then replace the
+// socket.
+bool private_socket_directory(const std::string &socket_path) {
+  const auto slash = socket_path.rfind('/');
+  std::string dir = ".";
+  if (slash != std::string::npos) {
+    dir = slash == 0 ? "/" : socket_path.substr(0, slash);
+  }
+  if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+    return false;
+  }
+  struct stat st;
+  return lstat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode) &&
+         st.st_uid == getuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+// True if the peer of a connected socket runs as this user
+bool same_user(const int conn) {
+#if defined(SO_PEERCRED)
+  ucred peer{};
+  socklen_t size = sizeof(peer);
+  return getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &peer, &size) == 0 &&
+         peer.uid == getuid();
+#else
+  uid_t uid;
+  gid_t gid;
+  return getpeereid(conn, &uid, &gid) == 0 && uid == getuid();
+#endif
+}
+
+// Run a compile-only clang command line in this process. Returns the exit
+// status, or -1 if the command line needs more than one compile job.
+int compile(const std::vector<std::string> &args) {
+  std::vector<const char *> argv{clang_executable};
+  for (auto &arg : args) {
+    argv.push_back(arg.c_str());
+  }
+
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticPrinter *DiagClient =
+      new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts);
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagClient);
+
+  Driver TheDriver(clang_executable, llvm::sys::getDefaultTargetTriple(),
+                   Diags);
+  std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
+  if (!C || C->containsError()) {
+    return 1;
+  }
+  const driver::JobList &Jobs = C->getJobs();
+  if (Jobs.size() != 1 || !isa<driver::Command>(*Jobs.begin())) {
+    return -1;
+  }
+  const driver::Command &Cmd = cast<driver::Command>(*Jobs.begin());
+  if (llvm::StringRef(Cmd.getCreator().getName()) != "clang") {
+    return -1;
+  }
+
+  std::unique_ptr<CompilerInvocation> CI(new CompilerInvocation);
+  if (!CompilerInvocation::CreateFromArgs(*CI, Cmd.getArguments(), Diags)) {
+    return 1;
+  }
+  CompilerInstance Clang;
+  Clang.setInvocation(std::move(CI));
+  Clang.createDiagnostics();
+  if (!Clang.hasDiagnostics()) {
+    return 1;
+  }
+  // Loads the syntax handler for -fplugin, a no-op once it is loaded
+  return ExecuteCompilerInvocation(&Clang) ? 0 : 1;
+}
+
+// Compile a kernel so that the syntax handler, XACC and the token
+// collectors are loaded before the first fork. The kernel name is unique,
+// so the translation cache cannot skip the work.
+void warm_up() {
+  char file_name[] = "/tmp/qcor-server-XXXXXX.cpp";
+  const int fd = mkstemps(file_name, 4);
+  if (fd < 0) {
+    return;
+  }
+  close(fd);
+  std::ofstream(file_name)
+      << "#include \"qcor.hpp\"\n"
+      << "__qpu__ void qcor_server_warm_up_" << getpid()
+      << "(qreg q) {\n  H(q[0]);\n}\n";
+  const auto status = compile(
+      {"-std=c++17",
+       "-fplugin=@CMAKE_INSTALL_PREFIX@/clang-plugins/"
+       "libqcor-syntax-handler.so",
+       "-I@CMAKE_INSTALL_PREFIX@/include/xacc",
+       "-I@CMAKE_INSTALL_PREFIX@/include/qcor",
+       "-I@CMAKE_INSTALL_PREFIX@/include/quantum/gate", "-fsyntax-only",
+       file_name});
+  std::remove(file_name);
+  if (status != 0) {
+    std::cerr << "[qcor] Compile server warm up failed, compiles will "
+                 "initialize XACC themselves\n";
+  }
+}
+
+bool read_all(const int fd, char *data, std::size_t size) {
+  while (size > 0) {
+    const auto n = read(fd, data, size);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+// Read a request, see the protocol above. output receives the client's
+// stdout and stderr.
+bool read_request(const int conn, std::string &cwd,
+                  std::vector<std::string> &args, int output[2]) {
+  std::uint32_t size = 0;
+  iovec iov{&size, sizeof(size)};
+  alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))];
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  const auto n = recvmsg(conn, &msg, MSG_WAITALL);
+  auto cmsg = CMSG_FIRSTHDR(&msg);
+  if (n != sizeof(size) || !cmsg || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int))) {
+    return false;
+  }
+  std::memcpy(output, CMSG_DATA(cmsg), 2 * sizeof(int));
+
+  std::string payload(size, '\0');
+  if (!read_all(conn, &payload[0], size)) {
+    return false;
+  }
+  std::size_t begin = 0;
+  for (std::size_t end; (end = payload.find('\0', begin)) != payload.npos;
+       begin = end + 1) {
+    args.push_back(payload.substr(begin, end - begin));
+  }
+  if (args.empty()) {
+    return false;
+  }
+  cwd = args.front();
+  args.erase(args.begin());
+  return true;
+}
+
+// Serve one request, in a child forked for it
+void serve(const int conn) {
+  std::string cwd;
+  std::vector<std::string> args;
+  int output[2];
+  if (!read_request(conn, cwd, args, output)) {
+    return;
+  }
+  dup2(output[0], STDOUT_FILENO);
+  dup2(output[1], STDERR_FILENO);
+  close(output[0]);
+  close(output[1]);
+
+  const std::int32_t status = chdir(cwd.c_str()) == 0 ? compile(args) : 1;
+  llvm::outs().flush();
+  llvm::errs().flush();
+  std::cout.flush();
+  std::cerr.flush();
+  write(conn, &status, sizeof(status));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+    std::cerr << "usage: qcor-server [socket]\n"
+              << "Serves qcor -use-server compiles on the Unix socket, by "
+                 "default $QCOR_SERVER_SOCKET or "
+              << default_socket_path() << "\n";
+    return 1;
+  }
+  const std::string socket_path = argc == 2 ? argv[1] : default_socket_path();
+
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(addr.sun_path)) {
+    std::cerr << "[qcor] Socket path too long: " << socket_path << "\n";
+    return 1;
+  }
+  std::strcpy(addr.sun_path, socket_path.c_str());
+  if (!private_socket_directory(socket_path)) {
+    std::cerr << "[qcor] The directory of " << socket_path
+              << " must belong to this user and not be writable by others\n";
+    return 1;
+  }
+  // Refuse to take over the socket of a running server
+  const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+  const bool running =
+      connect(probe, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+  close(probe);
+  if (running) {
+    std::cerr << "[qcor] A compile server already listens on " << socket_path
+              << "\n";
+    return 1;
+  }
+  unlink(socket_path.c_str());
+  umask(077);
+  const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(listener, SOMAXCONN) != 0) {
+    std::cerr << "[qcor] Could not listen on " << socket_path << ": "
+              << std::strerror(errno) << "\n";
+    return 1;
+  }
+
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+  warm_up();
+
+  // Children are never waited for
+  std::signal(SIGCHLD, SIG_IGN);
+  std::cerr << "[qcor] Compile server listening on " << socket_path << "\n";
+  while (true) {
+    const int conn = accept(listener, nullptr, nullptr);
+    if (conn < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "[qcor] accept failed: " << std::strerror(errno) << "\n";
+      return 1;
+    }
+    if (!same_user(conn)) {
+      close(conn);
+      continue;
+    }
+    // Only this thread survives the fork, which is why the warm up runs on
+    // it rather than on a thread of its own
+    const auto pid = fork();
+    if (pid == 0) {
+      close(listener);
+      serve(conn);
+      // exit rather than _exit, so the at-exit reports of the compile (-v
+      // cache statistics, QCOR_PROFILE) reach the client
+      std::exit(0);
+    }
+    if (pid < 0) {
+      const std::int32_t status = -1;
+      write(conn, &status, sizeof(status));
+    }
+    close(conn);
+  }
+}